@@ -36,7 +36,15 @@
                           ))
               (code '((define even (lambda (x) (= (mod x 2) 0)))
                       (filter even (list 1 2 3 4 5 6 7 8 9))
+                      (filter number? (list 1 'a 2 "b" 3))
                       ))
+              (para (list "`filter` is bound to the builtin `builtin-filter` the first time it is used."
+                          "The same goes for `foldl`, `foldr`, `zip`, `list-to-array` and `array-to-list`."
+                          "These names are ordinary globals and can be redefined by a program."
+                          "When the function is a fundamental, such as `number?` or `+`, the whole list"
+                          "is processed in C, a few hundred elements at a time so that other threads"
+                          "get to run during long operations."
+                          ))
               end
               )
              ))
@@ -53,8 +61,7 @@
               (code '((foldl + 0 (list 1 2 3 4 5 6 7 8 9 10))
                       ))
               
-              (para (list "`foldl` has an advantage over `foldr` in that it is implemented in a"
-                          "tail-recursive and constant-storage way."
+              (para (list "`foldl` runs in constant stack space."
                           ))
               
               (para (list "Funnily enough, `foldl` using function `cons` and initial value `nil`"
@@ -83,13 +90,8 @@
                           "An initial value is provided and here used in the first, rightmost, operation."
                           ))
 
-              (para (list "`foldr` has a disadvantage compared to `foldl` as I don't think it is"
-                          "possible to give `foldr` a constant-space and tail-recursive implementation."
-                          "One can make `foldr` tail-recursive by writing it in continuation passing style (CPS)."
-                          "The CPS version of foldr will run without building upon the return stack, but instead"
-                          "it will construct  and expand upon a continuation object each iteration."
-                          "This continuation object will grow at the same rate as the call-stack otherwise would"
-                          "but it would grow in heap usage."
+              (para (list "`foldr` folds over a reversed copy of the list. It runs in constant stack space"
+                          "but uses as many heap cells as there are elements in the list."
                           ))
                           
               (code '((foldr + 0 (list 1 2 3 4 5 6 7 8 9 10))
@@ -179,6 +181,19 @@
               )
              ))
 
+(define df-zip
+  (ref-entry "zip"
+             (list
+              (para (list "`zip` pairs up the elements of two lists."
+                          "The result is as long as the shorter of the two."
+                          ))
+              (code '((zip (list 1 2 3) (list 'a 'b 'c))
+                      (zip (list 1 2 3) (list 'a))
+                      ))
+              end
+              )
+             ))
+
 (define dynamic-functions
   (section 2 "functions"
            (list 'hline
@@ -193,6 +208,7 @@
                  df-str-cmp-dsc
                  df-str-merge
                  df-third
+                 df-zip
                  )
            )
   )
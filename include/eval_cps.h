@@ -43,6 +43,8 @@ extern "C" {
 #define EVAL_CPS_CONTEXT_FLAG_CONST_SYMBOL_STRINGS  (uint32_t)0x04
 #define EVAL_CPS_CONTEXT_FLAG_INCREMENTAL_READ      (uint32_t)0x08
 #define EVAL_CPS_CONTEXT_FLAG_TRAP_UNROLL_RETURN    (uint32_t)0x10
+#define EVAL_CPS_CONTEXT_FLAG_EVAL_DATA             (uint32_t)0x20
+#define EVAL_CPS_CONTEXT_FLAG_LOAD                  (uint32_t)0x40
 #define EVAL_CPS_CONTEXT_READER_FLAGS_MASK          (EVAL_CPS_CONTEXT_FLAG_CONST | EVAL_CPS_CONTEXT_FLAG_CONST_SYMBOL_STRINGS | EVAL_CPS_CONTEXT_FLAG_INCREMENTAL_READ)
 
 /** The eval_context_t struct represents a lispbm process.
@@ -72,6 +74,7 @@ typedef struct eval_context_s{
   char *error_reason;
   bool  app_cont;
   lbm_stack_t K;
+  lbm_uint trap_sp;      /* Stack position above the innermost trap frame, 0 if unknown */
   lbm_uint timestamp;
   lbm_uint sleep_us;
   uint32_t state;
@@ -281,6 +284,17 @@ void lbm_set_critical_error_callback(void (*fptr)(void));
  * \return
  */
 lbm_cid lbm_create_ctx(lbm_value program, lbm_value env, lbm_uint stack_size, char *name);
+/** Create a context that loads code and enqueue it as runnable.
+ *  The first eval or eval-program in the context evaluates code
+ *  from the reader rather than data, so macro calls in it are memoized.
+ *
+ * \param program The program to evaluate in the context.
+ * \param env An initial environment.
+ * \param stack_size Stack size for the context.
+ * \param name Name of thread or NULL.
+ * \return
+ */
+lbm_cid lbm_create_load_ctx(lbm_value program, lbm_value env, lbm_uint stack_size, char *name);
 /** Block a context from an extension
  */
 void lbm_block_ctx_from_extension(void);
@@ -372,6 +386,13 @@ void lbm_set_printf_callback(int (*prnt)(const char*, ...));
  * an undefined symbol
  */
 void lbm_set_dynamic_load_callback(bool (*fptr)(const char *, const char **));
+/** Expand all calls to global macros in each top-level expression of a
+ *  program before it is evaluated. The expansion is done one expression at
+ *  a time, so macros defined by earlier expressions are expanded in later ones.
+ *  Code that is later moved to flash then contains no macro calls.
+ * \param on True to expand macros on load, false (default) to expand them at runtime.
+ */
+void lbm_set_macro_expand_on_load(bool on);
 /** Get the CID of the currently executing context.
  *  Should be called from an extension where there is
  *  a guarantee that a context is running
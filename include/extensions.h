@@ -43,7 +43,7 @@ typedef struct {
 } lbm_extension_t;
 
 
-extern lbm_extension_t *extension_table;
+extern LBM_INSTANCE_LOCAL lbm_extension_t *extension_table;
 
 #define LBM_EXTENSION(name, argv, argn)                                 \
   __attribute__((aligned(LBM_STORABLE_ADDRESS_ALIGNMENT))) lbm_value name(lbm_value *(argv), lbm_uint (argn))
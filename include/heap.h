@@ -228,7 +228,7 @@ typedef struct {
                                // after most recent GC.
 } lbm_heap_state_t;
 
-extern lbm_heap_state_t lbm_heap_state;
+extern LBM_INSTANCE_LOCAL lbm_heap_state_t lbm_heap_state;
 
   typedef bool (*const_heap_write_fun)(lbm_uint w, lbm_uint ix);
 
@@ -254,6 +254,19 @@ typedef struct {
   uint32_t index;         // Limits arrays to max 2^32-1 elements.
 } lbm_array_header_extended_t;
 
+/**
+ *  The header of a byte array view. A view refers into the data of
+ *  another byte array and keeps that array alive. size and data are
+ *  laid out as in lbm_array_header_t so that a view can be read as any
+ *  other byte array. Views are read only and a view of a string is not
+ *  necessarily zero terminated.
+ */
+typedef struct {
+  lbm_uint size;            /// Number of elements
+  lbm_uint *data;           /// pointer into the data of parent.
+  lbm_value parent;         /// The array that owns the data.
+} lbm_array_header_view_t;
+
 /** Lock GC mutex
  *  Locks a mutex during GC marking when using the pointer reversal algorithm.
  *  Does nothing when using stack based GC mark.
@@ -332,9 +345,11 @@ lbm_value lbm_heap_allocate_list_init_va(unsigned int n, va_list valist);
  */
 lbm_value lbm_heap_allocate_list_init(unsigned int n, ...);
 /** Decode an lbm_value representing a string into a C string
+ *  A byte array view that is not zero terminated does not decode
+ *  into a C string.
  *
  * \param val Value
- * \return allocated list or error symbol
+ * \return pointer to the zero terminated string or NULL
  */
 char *lbm_dec_str(lbm_value val);
 /** Decode a readable array, if the argument is not an array the result is NULL
@@ -626,6 +641,27 @@ int lbm_heap_allocate_array(lbm_value *res, lbm_uint size);
  * \return 1 for success of 0 for failure.
  */
 int lbm_heap_allocate_lisp_array(lbm_value *res, lbm_uint size);
+/** Create a view of a part of a byte array. The view shares data with
+ *  the original array and keeps it alive for as long as the view is alive.
+ *  Views of views refer directly into the original array.
+ * \param res The resulting lbm_value is returned through this argument.
+ * \param parent Byte array (or byte array view) to create a view of.
+ * \param offset Offset in bytes into the data of parent.
+ * \param size Size of the view in bytes.
+ * \return 1 for success of 0 for failure.
+ */
+int lbm_heap_allocate_array_view(lbm_value *res, lbm_value parent, lbm_uint offset, lbm_uint size);
+/** Create a read-only byte array over data that is not managed by
+ *  lbm_memory, for example a memory mapped file. The data must stay valid
+ *  for as long as owner is alive, owner is kept alive by the view.
+ * \param res The resulting lbm_value is returned through this argument.
+ * \param owner Value that owns the data, usually a custom value whose
+ *        destructor releases the data.
+ * \param data Pointer to the data.
+ * \param size Size of the data in bytes.
+ * \return 1 for success of 0 for failure.
+ */
+int lbm_heap_allocate_foreign_array_view(lbm_value *res, lbm_value owner, uint8_t *data, lbm_uint size);
 /** Convert a C array into an lbm array. If the C array is allocated in LBM MEMORY
  *  the lifetime of the array will be managed by GC.
  * \param res lbm_value result pointer for storage of the result array.
@@ -698,7 +734,7 @@ static inline lbm_uint lbm_dec_ptr(lbm_value p) {
   return ((LBM_PTR_VAL_MASK & p) >> LBM_ADDRESS_SHIFT);
 }
 
-extern lbm_cons_t *lbm_heaps[2];
+extern LBM_INSTANCE_LOCAL lbm_cons_t *lbm_heaps[2];
 
 static inline lbm_uint lbm_dec_cons_cell_ptr(lbm_value p) {
   lbm_uint h = (p & LBM_PTR_TO_CONSTANT_BIT) >> LBM_PTR_TO_CONSTANT_SHIFT;
@@ -887,7 +923,17 @@ static inline bool lbm_is_array_r(lbm_value x) {
 static inline bool lbm_is_array_rw(lbm_value x) {
   return ((lbm_type_of(x) == LBM_TYPE_ARRAY) &&
           !(x & LBM_PTR_TO_CONSTANT_BIT) &&
-          lbm_heap_array_valid(x));
+          lbm_heap_array_valid(x) &&
+          lbm_cdr(x) != ENC_SYM_ARRAY_VIEW_TYPE);
+}
+
+/** Check if value is a view into another byte array.
+ * \param x Value to check.
+ * \return true if x is a byte array view and false otherwise.
+ */
+static inline bool lbm_is_array_view(lbm_value x) {
+  return (lbm_type_of(x) == LBM_TYPE_ARRAY &&
+          lbm_cdr(x) == ENC_SYM_ARRAY_VIEW_TYPE);
 }
 
 static inline bool lbm_is_lisp_array_r(lbm_value x) {
@@ -896,7 +942,8 @@ static inline bool lbm_is_lisp_array_r(lbm_value x) {
 }
 
 static inline bool lbm_is_lisp_array_rw(lbm_value x) {
-  return( (lbm_type_of(x) == LBM_TYPE_LISPARRAY) && !(x & LBM_PTR_TO_CONSTANT_BIT));
+  return( (lbm_type_of(x) == LBM_TYPE_LISPARRAY) && !(x & LBM_PTR_TO_CONSTANT_BIT) &&
+          lbm_cdr(x) != ENC_SYM_PERSISTENT_TYPE);
 }
 
 
@@ -177,6 +177,8 @@
 #define SYM_DEFRAG_MEM_TYPE       0x3A
 #define SYM_DEFRAG_ARRAY_TYPE     0x3B
 #define SYM_DEFRAG_LISPARRAY_TYPE 0x3C
+#define SYM_ARRAY_VIEW_TYPE       0x3E
+#define SYM_VECTOR_TYPE           0x3F
 //#define TYPE_CLASSIFIER_ENDS   0x39
 
 #define SYM_NONSENSE              0x3D
@@ -184,6 +186,9 @@
 #define SYM_NO_MATCH       0x40
 #define SYM_MATCH_ANY      0x41
 
+// Lisp arrays that must not be modified in place, see persistent_extensions.c
+#define SYM_PERSISTENT_TYPE 0x42
+
 // Type identifying symbols
 #define SYM_TYPE_LIST       0x50
 #define SYM_TYPE_I          0x51
@@ -255,7 +260,8 @@
 #define SYM_TRAP                0x116
 #define SYM_CALL_CC_UNSAFE      0x117
 #define SYM_CONT_SP             0x118
-#define SPECIAL_FORMS_END       0x118
+#define SYM_CALL_CC_COPY        0x119
+#define SPECIAL_FORMS_END       0x119
 
 #ifndef LBM64
 #define SPECIAL_FORMS_MASK        0xFFFFFF00
@@ -343,6 +349,9 @@
 #define SYM_ARRAY               0x20041
 #define SYM_IS_STRING           0x20042
 #define SYM_IS_CONSTANT         0x20043
+#define SYM_ZIP                 0x20044
+#define SYM_LIST_TO_ARRAY       0x20045
+#define SYM_ARRAY_TO_LIST       0x20046
 
 // Apply funs:
 // Get their arguments in evaluated form on the stack.
@@ -372,7 +381,12 @@
 #define SYM_SORT                  0x30014
 #define SYM_REST_ARGS             0x30015
 #define SYM_ROTATE                0x30016
-#define SYM_POPRET                0x30017
+#define SYM_ARRAY_MAP             0x30017
+#define SYM_ARRAY_FOLD            0x30018
+#define SYM_MACROEXPAND_ALL       0x30019
+#define SYM_FILTER                0x3001A
+#define SYM_FOLDL                 0x3001B
+#define SYM_FOLDR                 0x3001C
 
 #define SYMBOL_KIND(X)          ((X) >> 16)
 #define SYMBOL_KIND_SPECIAL     0
@@ -431,6 +445,9 @@
 #define ENC_SYM_DEFRAG_MEM_TYPE       ENC_SYM(SYM_DEFRAG_MEM_TYPE)
 #define ENC_SYM_DEFRAG_ARRAY_TYPE     ENC_SYM(SYM_DEFRAG_ARRAY_TYPE)
 #define ENC_SYM_DEFRAG_LISPARRAY_TYPE ENC_SYM(SYM_DEFRAG_LISPARRAY_TYPE)
+#define ENC_SYM_ARRAY_VIEW_TYPE       ENC_SYM(SYM_ARRAY_VIEW_TYPE)
+#define ENC_SYM_VECTOR_TYPE           ENC_SYM(SYM_VECTOR_TYPE)
+#define ENC_SYM_PERSISTENT_TYPE       ENC_SYM(SYM_PERSISTENT_TYPE)
 #define ENC_SYM_NONSENSE              ENC_SYM(SYM_NONSENSE)
 
 #define ENC_SYM_NO_MATCH        ENC_SYM(SYM_NO_MATCH)
@@ -518,8 +535,15 @@
 #define ENC_SYM_SORT                  ENC_SYM(SYM_SORT)
 #define ENC_SYM_REST_ARGS             ENC_SYM(SYM_REST_ARGS)
 #define ENC_SYM_ROTATE                ENC_SYM(SYM_ROTATE)
+#define ENC_SYM_ARRAY_MAP             ENC_SYM(SYM_ARRAY_MAP)
+#define ENC_SYM_ARRAY_FOLD            ENC_SYM(SYM_ARRAY_FOLD)
+#define ENC_SYM_MACROEXPAND_ALL       ENC_SYM(SYM_MACROEXPAND_ALL)
+#define ENC_SYM_FILTER                ENC_SYM(SYM_FILTER)
+#define ENC_SYM_FOLDL                 ENC_SYM(SYM_FOLDL)
+#define ENC_SYM_FOLDR                 ENC_SYM(SYM_FOLDR)
 #define ENC_SYM_TRAP                  ENC_SYM(SYM_TRAP)
 #define ENC_SYM_CALL_CC_UNSAFE        ENC_SYM(SYM_CALL_CC_UNSAFE)
+#define ENC_SYM_CALL_CC_COPY          ENC_SYM(SYM_CALL_CC_COPY)
 #define ENC_SYM_CONT_SP               ENC_SYM(SYM_CONT_SP)
 
 #define ENC_SYM_ADD           ENC_SYM(SYM_ADD)
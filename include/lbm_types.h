@@ -36,6 +36,19 @@ extern "C" {
 #define LBM_STORABLE_ADDRESS_ALIGNMENT 8
 #endif
 
+/* Storage class for the runtime state (heap, memory, symbols, global
+ * environment, scheduler queues, extension table and callbacks).
+ * Building with LBM_INSTANCE_PER_THREAD makes that state thread local
+ * so each thread can init and run its own isolated instance through
+ * the ordinary API. All calls for an instance must then be made from
+ * the thread that initialized it.
+ */
+#ifdef LBM_INSTANCE_PER_THREAD
+#define LBM_INSTANCE_LOCAL _Thread_local
+#else
+#define LBM_INSTANCE_LOCAL
+#endif
+
 #ifndef LBM64
 /** A lispBM value.
  *  Can represent a character, 28 bit signed or unsigned integer.
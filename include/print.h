@@ -35,6 +35,17 @@ extern "C" {
  */
 bool lbm_value_is_printable_string(lbm_value v, char **str);
 
+/** Check if an lbm_value (very likely) is a printable string. In addition
+ *  to what lbm_value_is_printable_string accepts, this also accepts string
+ *  views that are not zero terminated.
+ *
+ * \param v Value to check stringyness of.
+ * \param str Pointer to the first character is returned here.
+ * \param len Number of characters in the string is returned here.
+ * \return True if the value likely is a string, otherwise false.
+ */
+bool lbm_value_is_printable_string_len(lbm_value v, char **str, lbm_uint *len);
+
 /** Initialize the print_value subsystem.
  *  print value depends on a stack and that stack is initialized here using a storage array provided by the user.
  * \param print_stack_size The number of uint32_t elements in the array.
@@ -52,6 +63,18 @@ int lbm_print_init(lbm_uint print_stack_size);
  */
 int lbm_print_value(char *buf, unsigned int len, lbm_value t);
 
+/** Print an lbm_value into a buffer provided by the user and report
+ *  the length of the result. Unlike lbm_print_value the buffer is not
+ *  cleared before printing, only the zero terminator is written.
+ *
+ * \param buf Buffer to print into.
+ * \param len The size of the buffer in bytes.
+ * \param t The value to print.
+ * \return The number of printed characters on success, -1 if the buffer
+ *          is too small and -2 for other failures.
+ */
+int lbm_print_value_len(char *buf, unsigned int len, lbm_value t);
+
 #ifdef __cplusplus
 }
 #endif
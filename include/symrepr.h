@@ -144,9 +144,9 @@ bool lbm_symbol_in_flash(char *str);
 bool lbm_symbol_list_entry_in_flash(char *str);
 
 
-extern lbm_value symbol_x;
-extern lbm_value symbol_y;
-extern lbm_value symbol_rest_args;
+extern LBM_INSTANCE_LOCAL lbm_value symbol_x;
+extern LBM_INSTANCE_LOCAL lbm_value symbol_y;
+extern LBM_INSTANCE_LOCAL lbm_value symbol_rest_args;
 
 #ifdef __cplusplus
 }
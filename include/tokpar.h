@@ -72,7 +72,7 @@
 
 // The contents of tokpar_sym_str is reset every time
 // tok_symbol or tok_string is run.
-extern char tokpar_sym_str[TOKENIZER_MAX_SYMBOL_AND_STRING_LENGTH+1];
+extern LBM_INSTANCE_LOCAL char tokpar_sym_str[TOKENIZER_MAX_SYMBOL_AND_STRING_LENGTH+1];
 
 #ifdef __cplusplus
 extern "C" {
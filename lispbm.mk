@@ -29,6 +29,10 @@ LISPBM_SRC = $(LISPBM)/src/env.c \
              $(LISPBM)/src/extensions/display_extensions.c \
              $(LISPBM)/src/extensions/tjpgd.c \
              $(LISPBM)/src/extensions/mutex_extensions.c \
+             $(LISPBM)/src/extensions/ring_extensions.c \
+             $(LISPBM)/src/extensions/persistent_extensions.c \
+             $(LISPBM)/src/extensions/checksum_extensions.c \
+             $(LISPBM)/src/extensions/optimize_extensions.c \
              $(LISPBM)/src/extensions/lbm_dyn_lib.c \
              $(LISPBM)/src/extensions/schrift.c \
              $(LISPBM)/src/extensions/ttf_extensions.c
@@ -61,10 +65,14 @@ LISPBM_H = $(LISPBM)/include/env.h \
            $(LISPBM)/include/tokpar.h \
            $(LISPBM)/include/buffer.h \
            $(LISPBM)/include/extensions/array_extensions.h \
+           $(LISPBM)/include/extensions/checksum_extensions.h \
+           $(LISPBM)/include/extensions/optimize_extensions.h \
            $(LISPBM)/include/extensions/display_extensions.h \
            $(LISPBM)/include/extensions/lbm_dyn_lib.h \
            $(LISPBM)/include/extensions/math_extensions.h \
+           $(LISPBM)/include/extensions/persistent_extensions.h \
            $(LISPBM)/include/extensions/random_extensions.h \
+           $(LISPBM)/include/extensions/ring_extensions.h \
            $(LISPBM)/include/extensions/runtime_extensions.h \
            $(LISPBM)/include/extensions/set_extensions.h \
            $(LISPBM)/include/extensions/string_extensions.h \
@@ -38,44 +38,68 @@ void packet_reset(PACKET_STATE_t *state) {
 	state->bytes_left = 0;
 }
 
-void packet_send_packet(unsigned char *data, unsigned int len, PACKET_STATE_t *state) {
+/**
+ * Build the framing around a payload without copying it.
+ *
+ * @param header
+ * Receives the start byte and length, at least 4 bytes.
+ *
+ * @param footer
+ * Receives the crc and the stop byte, at least 3 bytes.
+ *
+ * @return
+ * Number of header bytes written, 0 if len is not a valid payload length.
+ */
+unsigned int packet_frame(unsigned char *data, unsigned int len,
+		unsigned char *header, unsigned char *footer) {
 	if (len == 0 || len > PACKET_MAX_PL_LEN) {
-		return;
+		return 0;
 	}
 
 	unsigned int b_ind = 0;
 #if PACKET_MAX_PL_LEN <= 65535
 	if (len <= 255) {
-		state->tx_buffer[b_ind++] = 2;
-		state->tx_buffer[b_ind++] = (unsigned char)len;
+		header[b_ind++] = 2;
+		header[b_ind++] = (unsigned char)len;
 	} else {
-		state->tx_buffer[b_ind++] = 3;
-		state->tx_buffer[b_ind++] = (unsigned char)(len >> 8);
-		state->tx_buffer[b_ind++] = len & 0xFF;
+		header[b_ind++] = 3;
+		header[b_ind++] = (unsigned char)(len >> 8);
+		header[b_ind++] = len & 0xFF;
 	}
 #else
         if (len <= 255) {
-		state->tx_buffer[b_ind++] = 2;
-		state->tx_buffer[b_ind++] = (unsigned char)len;
+		header[b_ind++] = 2;
+		header[b_ind++] = (unsigned char)len;
 	} else if (len <= 65535) {
-		state->tx_buffer[b_ind++] = 3;
-		state->tx_buffer[b_ind++] = (unsigned char)(len >> 8);
-		state->tx_buffer[b_ind++] = len & 0xFF;
+		header[b_ind++] = 3;
+		header[b_ind++] = (unsigned char)(len >> 8);
+		header[b_ind++] = len & 0xFF;
 	} else {
-		state->tx_buffer[b_ind++] = 4;
-		state->tx_buffer[b_ind++] = (unsigned char)(len >> 16);
-		state->tx_buffer[b_ind++] = (len >> 8) & 0xFF;
-		state->tx_buffer[b_ind++] = len & 0xFF;
+		header[b_ind++] = 4;
+		header[b_ind++] = (unsigned char)(len >> 16);
+		header[b_ind++] = (len >> 8) & 0xFF;
+		header[b_ind++] = len & 0xFF;
 	}
 #endif
 
+	unsigned short crc = crc16(data, len);
+	footer[0] = (uint8_t)(crc >> 8);
+	footer[1] = (uint8_t)(crc & 0xFF);
+	footer[2] = 3;
+	return b_ind;
+}
+
+void packet_send_packet(unsigned char *data, unsigned int len, PACKET_STATE_t *state) {
+	unsigned char footer[PACKET_FOOTER_LEN];
+	unsigned int b_ind = packet_frame(data, len, state->tx_buffer, footer);
+	if (b_ind == 0) {
+		return;
+	}
+
 	memcpy(state->tx_buffer + b_ind, data, len);
 	b_ind += len;
-
-	unsigned short crc = crc16(data, len);
-	state->tx_buffer[b_ind++] = (uint8_t)(crc >> 8);
-	state->tx_buffer[b_ind++] = (uint8_t)(crc & 0xFF);
-	state->tx_buffer[b_ind++] = 3;
+	memcpy(state->tx_buffer + b_ind, footer, PACKET_FOOTER_LEN);
+	b_ind += PACKET_FOOTER_LEN;
 
 	if (state->send_func) {
 		state->send_func(state->tx_buffer, b_ind);
@@ -141,6 +165,59 @@ void packet_process_byte(uint8_t rx_data, PACKET_STATE_t *state) {
 	}
 }
 
+/**
+ * Process a block of received bytes. Complete packets are decoded in
+ * place and handed to process_func without being copied, only a packet
+ * that is split between two calls goes through rx_buffer.
+ */
+void packet_process_buffer(unsigned char *data, unsigned int len, PACKET_STATE_t *state) {
+	// Finish a packet left over from the previous call.
+	while (len > 0 && state->rx_write_ptr != state->rx_read_ptr) {
+		// The packet length is known, append as much of it as we have in one go.
+		if (state->bytes_left > 1 &&
+				state->rx_write_ptr + (unsigned int)state->bytes_left <= PACKET_BUFFER_LEN) {
+			unsigned int n = (unsigned int)state->bytes_left - 1;
+			if (n > len) {
+				n = len;
+			}
+			memcpy(state->rx_buffer + state->rx_write_ptr, data, n);
+			state->rx_write_ptr += n;
+			state->bytes_left -= (int)n;
+			data += n;
+			len -= n;
+			continue;
+		}
+		packet_process_byte(*data++, state);
+		len--;
+	}
+
+	while (len > 0) {
+		int res = try_decode_packet(data, len, state->process_func, &state->bytes_left);
+
+		// More data is needed
+		if (res == -2) {
+			break;
+		}
+
+		if (res > 0) {
+			data += res;
+			len -= (unsigned int)res;
+		} else {
+			data++;
+			len--;
+		}
+	}
+
+	// Keep the incomplete tail. It is always shorter than a full packet
+	// since try_decode_packet rejects too long packets before asking for
+	// more data.
+	if (len > 0) {
+		memcpy(state->rx_buffer, data, len);
+		state->rx_read_ptr = 0;
+		state->rx_write_ptr = len;
+	}
+}
+
 /**
  * Try if it is possible to decode a packet from a buffer.
  *
@@ -29,6 +29,8 @@
 #endif
 
 #define PACKET_BUFFER_LEN		(PACKET_MAX_PL_LEN + 8)
+#define PACKET_HEADER_MAX_LEN	4
+#define PACKET_FOOTER_LEN		3
 
 // Types
 typedef struct {
@@ -46,6 +48,9 @@ void packet_init(void (*s_func)(unsigned char *data, unsigned int len),
 		void (*p_func)(unsigned char *data, unsigned int len), PACKET_STATE_t *state);
 void packet_reset(PACKET_STATE_t *state);
 void packet_process_byte(uint8_t rx_data, PACKET_STATE_t *state);
+void packet_process_buffer(unsigned char *data, unsigned int len, PACKET_STATE_t *state);
 void packet_send_packet(unsigned char *data, unsigned int len, PACKET_STATE_t *state);
+unsigned int packet_frame(unsigned char *data, unsigned int len,
+		unsigned char *header, unsigned char *footer);
 
 #endif /* PACKET_H_ */
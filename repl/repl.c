@@ -22,6 +22,9 @@
 #include <stdarg.h>
 #include <errno.h>
 #include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/prctl.h>
 #include <sys/time.h>
 #include <sys/mman.h>
 #include <unistd.h>
@@ -32,8 +35,13 @@
 
 //network
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/epoll.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <arpa/inet.h>
 #include <netdb.h>
 
@@ -121,6 +129,17 @@ static bool terminate_after_startup = false;
 static volatile lbm_cid startup_cid = -1;
 static volatile lbm_cid store_result_cid = -1;
 static volatile bool silent_mode = false;
+static bool expand_macros = false;
+
+// Evaluator thread placement, set from the command line and applied by
+// the evaluator thread itself before it enters lbm_run_eval.
+static int eval_cpu = -1;
+static int eval_fifo_prio = 0;
+static long eval_timer_slack_ns = -1;
+// What the evaluator thread actually ended up with.
+static int eval_policy = SCHED_OTHER;
+static int eval_prio = 0;
+static long eval_timer_slack = -1;
 
 static size_t lbm_memory_size = LBM_MEMORY_SIZE_10K;
 static size_t lbm_memory_bitmap_size = LBM_MEMORY_BITMAP_SIZE_10K;
@@ -242,7 +261,62 @@ void erase() {
   fflush(stdout);
 }
 
+static void configure_eval_thread(void) {
+  pthread_t self = pthread_self();
+  int r;
+
+  if (eval_cpu >= 0) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET((size_t)eval_cpu, &set);
+    r = pthread_setaffinity_np(self, sizeof(cpu_set_t), &set);
+    if (r) {
+      printf("WARNING: Unable to pin evaluator to cpu %d: %s\n", eval_cpu, strerror(r));
+    }
+  }
+
+  if (eval_fifo_prio > 0) {
+    struct sched_param sp;
+    sp.sched_priority = eval_fifo_prio;
+    r = pthread_setschedparam(self, SCHED_FIFO, &sp);
+    if (r == EPERM) {
+      printf("WARNING: Not permitted to use SCHED_FIFO, evaluator keeps the default policy\n");
+    } else if (r) {
+      printf("WARNING: Unable to set SCHED_FIFO priority %d: %s\n", eval_fifo_prio, strerror(r));
+    }
+  }
+
+  // Timer slack is per thread, so it must be set from the evaluator.
+  if (eval_timer_slack_ns >= 0) {
+    // PR_SET_TIMERSLACK treats 0 as "reset to default", 1ns is the minimum.
+    unsigned long slack = eval_timer_slack_ns > 0 ? (unsigned long)eval_timer_slack_ns : 1;
+    if (prctl(PR_SET_TIMERSLACK, slack, 0, 0, 0) != 0) {
+      printf("WARNING: Unable to set timer slack: %s\n", strerror(errno));
+    }
+  }
+
+  struct sched_param sp;
+  if (pthread_getschedparam(self, &eval_policy, &sp) == 0) {
+    eval_prio = sp.sched_priority;
+  }
+  eval_timer_slack = prctl(PR_GET_TIMERSLACK, 0, 0, 0, 0);
+}
+
+static void print_eval_thread_info(int (*pr)(const char *, ...)) {
+  if (eval_cpu >= 0) {
+    pr("CPU: %d\n", eval_cpu);
+  } else {
+    pr("CPU: any\n");
+  }
+  pr("Policy: %s, priority %d\n",
+     eval_policy == SCHED_FIFO ? "SCHED_FIFO" :
+     eval_policy == SCHED_RR ? "SCHED_RR" : "SCHED_OTHER",
+     eval_prio);
+  pr("Timer slack: %ld ns\n", eval_timer_slack);
+}
+
 void *eval_thd_wrapper(void *v) {
+  configure_eval_thread();
   if (!silent_mode) {
     printf("Lisp REPL started! (LBM Version: %u.%u.%u)\n", LBM_MAJOR_VERSION, LBM_MINOR_VERSION, LBM_PATCH_VERSION);
 #ifdef WITH_SDL
@@ -321,12 +395,19 @@ int error_print(const char *format, ...) {
   return n;
 }
 
+// Sleep until an absolute CLOCK_MONOTONIC deadline. A relative
+// nanosleep that is interrupted and restarted drifts by however long
+// the signal handling took, the absolute deadline does not.
 void sleep_callback(uint32_t us) {
-  struct timespec s;
-  struct timespec r;
-  s.tv_sec = 0;
-  s.tv_nsec = (long)us * 1000;
-  nanosleep(&s, &r);
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  t.tv_sec += us / 1000000;
+  t.tv_nsec += (long)(us % 1000000) * 1000;
+  if (t.tv_nsec >= 1000000000) {
+    t.tv_sec ++;
+    t.tv_nsec -= 1000000000;
+  }
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL) == EINTR);
 }
 
 static bool prof_running = false;
@@ -455,6 +536,10 @@ lbm_const_heap_t const_heap;
 #define VESCTCP              0x0407
 #define VESCTCP_PORT         0x0408
 #define VESCTCP_PROGRAM_FLASH_SIZE   0x0409
+#define EXPAND_MACROS        0x040A
+#define EVAL_CPU             0x040B
+#define EVAL_FIFO_PRIO       0x040C
+#define EVAL_TIMER_SLACK     0x040D
 
 struct option options[] = {
   {"help", no_argument, NULL, 'h'},
@@ -472,6 +557,10 @@ struct option options[] = {
   {"vesctcp",no_argument, NULL, VESCTCP},
   {"vesctcp_port",required_argument, NULL, VESCTCP_PORT},
   {"vesctcp_program_flash_size", required_argument, NULL, VESCTCP_PROGRAM_FLASH_SIZE},
+  {"expand_macros", no_argument, NULL, EXPAND_MACROS},
+  {"eval_cpu", required_argument, NULL, EVAL_CPU},
+  {"eval_fifo_prio", required_argument, NULL, EVAL_FIFO_PRIO},
+  {"eval_timer_slack", required_argument, NULL, EVAL_TIMER_SLACK},
   {0,0,0,0}};
 
 typedef struct src_list_s {
@@ -629,6 +718,14 @@ void parse_opts(int argc, char **argv) {
       printf("    --terminate                       Terminate the REPL after evaluating the\n" \
              "                                      source files specified with --src/-s\n");
       printf("    --load_image=FILEPATH             load an image-file at startup\n");
+      printf("    --expand_macros                   Expand macro calls in each top-level\n"\
+             "                                      expression before evaluating it.\n");
+      printf("\n");
+      printf("    --eval_cpu=N                      Pin the evaluator thread to cpu N.\n");
+      printf("    --eval_fifo_prio=PRIO             Run the evaluator thread SCHED_FIFO at\n"\
+             "                                      priority PRIO, if permitted.\n");
+      printf("    --eval_timer_slack=NS             Set the evaluator thread timer slack\n"\
+             "                                      in nanoseconds (shown in :info).\n");
       printf("\n");
       printf("    --vesctcp                         Open a TCP server talking the VESC\n"\
              "                                      protocol on port %d\n", DEFAULT_VESCIF_TCP_PORT);
@@ -696,6 +793,25 @@ void parse_opts(int argc, char **argv) {
     case SILENT_MODE:
       silent_mode = true;
       break;
+    case EXPAND_MACROS:
+      expand_macros = true;
+      break;
+    case EVAL_CPU:
+      eval_cpu = atoi((char *)optarg);
+      break;
+    case EVAL_FIFO_PRIO: {
+      int prio = atoi((char *)optarg);
+      int max = sched_get_priority_max(SCHED_FIFO);
+      int min = sched_get_priority_min(SCHED_FIFO);
+      if (prio < min || prio > max) {
+        printf("WARNING: SCHED_FIFO priority must be in %d..%d, ignoring\n", min, max);
+      } else {
+        eval_fifo_prio = prio;
+      }
+    } break;
+    case EVAL_TIMER_SLACK:
+      eval_timer_slack_ns = atol((char *)optarg);
+      break;
     case LOAD_IMAGE:
       image_input_file = (char*)optarg;
       break;
@@ -819,6 +935,7 @@ int init_repl() {
   lbm_set_timestamp_us_callback(timestamp);
   lbm_set_usleep_callback(sleep_callback);
   lbm_set_dynamic_load_callback(dynamic_loader);
+  lbm_set_macro_expand_on_load(expand_macros);
   lbm_set_printf_callback(error_print);
 
 
@@ -1161,10 +1278,13 @@ void shutdown_procedure(void) {
 #define FW_NAME "lispbm"
 #define HW_TYPE_CUSTOM_MODULE 2
 #define FW_TEST_VERSION_NUMBER 0
-#define SEND_MAX_RETRY 10
+#define SEND_TIMEOUT_MS 1000
+#define VESCTCP_RX_BUFFER_SIZE (64 * 1024)
 
 static send_func_t send_func = 0;
-static int connected_socket = 0;
+static int connected_socket = -1;
+// Replies come from the socket loop and prints from the evaluator thread.
+static pthread_mutex_t send_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 
 char *lispif_print_prefix(void) {
@@ -1367,6 +1487,7 @@ bool vescif_restart(bool print, bool load_code, bool load_imports) {
   lbm_set_timestamp_us_callback(timestamp);
   lbm_set_usleep_callback(sleep_callback);
   lbm_set_dynamic_load_callback(dynamic_loader);
+  lbm_set_macro_expand_on_load(expand_macros);
   lbm_set_printf_callback(commands_printf_lisp);
 
   init_exts();
@@ -1736,6 +1857,8 @@ void repl_process_cmd(unsigned char *data, unsigned int len,
         commands_printf_lisp("Size: %u words", const_heap.size);
         commands_printf_lisp("Used words: %d\n", const_heap.next);
         commands_printf_lisp("Free words: %d\n", const_heap.size - const_heap.next);
+        commands_printf_lisp("--(Evaluator thread)--\n");
+        print_eval_thread_info(commands_printf_lisp);
         //flast_stats stats = flash_helper_stats();
         //commands_printf_lisp("Erase Cnt Tot: %d\n", stats.erase_cnt_tot);
         //commands_printf_lisp("Erase Cnt Max Sector: %d\n", stats.erase_cnt_max);
@@ -2096,63 +2219,173 @@ void *udp_broadcast_task(void *arg) {
   return (void*)0;
 }
 
-void send_tcp_bytes(unsigned char *buffer, unsigned int len) {
-  int to_write = (int)len;
-  int error_cnt = 0;
-
-  while (to_write > 0) {
-    ssize_t written = write(connected_socket, buffer + ((int)len - to_write), (size_t)to_write);
+// Write all of iov to the non-blocking client socket, waiting for the
+// socket to drain when the send buffer is full. Gives up if the client
+// stops reading for SEND_TIMEOUT_MS.
+static bool send_tcp_iov(struct iovec *iov, int iovcnt) {
+  while (iovcnt > 0) {
+    ssize_t written = writev(connected_socket, iov, iovcnt);
     if (written < 0) {
-      error_cnt ++;
-      if (error_cnt > SEND_MAX_RETRY) {
-        return;
-      }
-      sleep_callback(10);
+      if (errno == EINTR) continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+      struct pollfd pfd = { .fd = connected_socket, .events = POLLOUT };
+      if (poll(&pfd, 1, SEND_TIMEOUT_MS) <= 0) return false;
+      continue;
+    }
+    while (iovcnt > 0 && (size_t)written >= iov->iov_len) {
+      written -= (ssize_t)iov->iov_len;
+      iov++;
+      iovcnt--;
+    }
+    if (iovcnt > 0) {
+      iov->iov_base = (uint8_t*)iov->iov_base + written;
+      iov->iov_len -= (size_t)written;
     }
-    to_write -= (int)written;
   }
+  return true;
 }
 
-PACKET_STATE_t packet;
-
+// Frame and send a packet with a single writev, the payload is sent
+// straight from the callers buffer.
 void send_packet_local(unsigned char *data, unsigned int len) {
-  packet_send_packet(data, len, &packet);
+  unsigned char header[PACKET_HEADER_MAX_LEN];
+  unsigned char footer[PACKET_FOOTER_LEN];
+  unsigned int header_len = packet_frame(data, len, header, footer);
+  if (header_len == 0) return;
+
+  struct iovec iov[3];
+  iov[0].iov_base = header;
+  iov[0].iov_len = header_len;
+  iov[1].iov_base = data;
+  iov[1].iov_len = len;
+  iov[2].iov_base = footer;
+  iov[2].iov_len = PACKET_FOOTER_LEN;
+
+  pthread_mutex_lock(&send_mutex);
+  if (connected_socket >= 0) {
+    send_tcp_iov(iov, 3);
+  }
+  pthread_mutex_unlock(&send_mutex);
 }
 
+PACKET_STATE_t packet;
+
 void process_packet_local(unsigned char *data, unsigned int len) {
   repl_process_cmd(data,len, send_packet_local);
 }
 
-void *vesctcp_client_handler(void *arg) {
-  connected_socket = (int)arg;
-  uint8_t buffer[1024];
-  packet_init(send_tcp_bytes, process_packet_local,&packet);
-  send_func = send_packet_local;
-  ssize_t len;
+static char vesctcp_client_ip[256];
 
+static void vesctcp_client_connect(int epfd, int sock) {
   struct sockaddr_in addr;
   socklen_t addr_size = sizeof(struct sockaddr_in);
-  getpeername(connected_socket, (struct sockaddr *)&addr, &addr_size);
-  char ip[256];
-  memset(ip,0,256);
-  strncpy(ip, inet_ntoa(addr.sin_addr), 255);
+  getpeername(sock, (struct sockaddr *)&addr, &addr_size);
+  memset(vesctcp_client_ip,0,256);
+  strncpy(vesctcp_client_ip, inet_ntoa(addr.sin_addr), 255);
+
+  int flag = 1;
+  setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+  fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+
+  struct epoll_event ev;
+  ev.events = EPOLLIN | EPOLLRDHUP;
+  ev.data.fd = sock;
+  if (epoll_ctl(epfd, EPOLL_CTL_ADD, sock, &ev) < 0) {
+    printf("Unable to watch client socket\n");
+    close(sock);
+    return;
+  }
+
+  pthread_mutex_lock(&send_mutex);
+  connected_socket = sock;
+  pthread_mutex_unlock(&send_mutex);
+  packet_init(NULL, process_packet_local, &packet);
+  send_func = send_packet_local;
+  vesctcp_server_in_use = true;
 
-  printf("Client %s connected\n",ip);
+  printf("Client %s connected\n", vesctcp_client_ip);
 
   vescif_restart(false,false,false);
+}
 
-  do {
-    len = read(connected_socket, buffer, 1024);
-    for (int i = 0; i < len; i ++) {
-      packet_process_byte(buffer[i], &packet);
-    }
-  } while (len > 0);
-
-  close(connected_socket);
+static void vesctcp_client_disconnect(int epfd) {
   send_func = NULL;
-  printf("Client %s disconnected\n",ip);
+  epoll_ctl(epfd, EPOLL_CTL_DEL, connected_socket, NULL);
+  pthread_mutex_lock(&send_mutex);
+  close(connected_socket);
+  connected_socket = -1;
+  pthread_mutex_unlock(&send_mutex);
+  printf("Client %s disconnected\n", vesctcp_client_ip);
   vesctcp_server_in_use = false;
-  return (void*)0;
+}
+
+static void vesctcp_refuse(int sock, struct sockaddr_in *addr) {
+  char ip[256];
+  memset(ip,0,256);
+  strncpy(ip, inet_ntoa(addr->sin_addr), 255);
+  printf("Refusing connection from %s\n", ip);
+  ssize_t r = write(sock, vesctcp_in_use, strlen(vesctcp_in_use));
+  if (r < 0) {
+    printf("Unable to write to refused client\n");
+  }
+  close(sock);
+}
+
+// One thread serves both the listening socket and the client. Each
+// wakeup drains the client socket into a large buffer and decodes all
+// complete packets in it in place.
+static void vesctcp_serve(int server_socket) {
+  static uint8_t rx_buffer[VESCTCP_RX_BUFFER_SIZE];
+
+  int epfd = epoll_create1(0);
+  if (epfd < 0) {
+    printf("Unable to create epoll instance\n");
+    return;
+  }
+  struct epoll_event ev;
+  ev.events = EPOLLIN;
+  ev.data.fd = server_socket;
+  epoll_ctl(epfd, EPOLL_CTL_ADD, server_socket, &ev);
+
+  struct epoll_event events[2];
+  for (;;) {
+    int n = epoll_wait(epfd, events, 2, -1);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    for (int i = 0; i < n; i ++) {
+      if (events[i].data.fd == server_socket) {
+        struct sockaddr_in client_sockaddr_in;
+        socklen_t len = sizeof(client_sockaddr_in);
+        int client_socket = accept(server_socket, (struct sockaddr *)&client_sockaddr_in, &len);
+        if (client_socket < 0) continue;
+        if (vesctcp_server_in_use) {
+          vesctcp_refuse(client_socket, &client_sockaddr_in);
+        } else {
+          vesctcp_client_connect(epfd, client_socket);
+        }
+      } else if (events[i].data.fd == connected_socket) {
+        bool closed = false;
+        for (;;) {
+          ssize_t len = read(connected_socket, rx_buffer, VESCTCP_RX_BUFFER_SIZE);
+          if (len > 0) {
+            packet_process_buffer(rx_buffer, (unsigned int)len, &packet);
+            if (len < VESCTCP_RX_BUFFER_SIZE) break;
+          } else if (len < 0 && errno == EINTR) {
+            continue;
+          } else {
+            closed = (len == 0 || (errno != EAGAIN && errno != EWOULDBLOCK));
+            break;
+          }
+        }
+        if (closed || (events[i].events & (EPOLLHUP | EPOLLERR))) {
+          vesctcp_client_disconnect(epfd);
+        }
+      }
+    }
+  }
+  close(epfd);
 }
 
 
@@ -2182,7 +2415,6 @@ int main(int argc, char **argv) {
 
   if (vesctcp) {
     pthread_t broadcast_thread;
-    pthread_t client_thread;
     pthread_create(&broadcast_thread, NULL, udp_broadcast_task, NULL);
 
     // initialize program flash
@@ -2202,28 +2434,7 @@ int main(int argc, char **argv) {
 
     listen(server_socket, 5);
 
-    for (;;) {
-      struct sockaddr_in client_sockaddr_in;
-      socklen_t len = sizeof(client_sockaddr_in);
-
-      int client_socket = accept(server_socket, (struct sockaddr *)&client_sockaddr_in, &len);
-
-      if (client_socket >= 0 && !vesctcp_server_in_use ) {
-        vesctcp_server_in_use = true;
-        // TODO: is this cast really ok?
-        pthread_create(&client_thread, NULL, vesctcp_client_handler, (void*)client_socket);
-
-      } else if (client_socket >= 0) {
-        char ip[256];
-        memset(ip,0,256);
-        strncpy(ip, inet_ntoa(client_sockaddr_in.sin_addr), 255);
-        printf("Refusing connection from %s\n", ip);
-        ssize_t r = write(client_socket, vesctcp_in_use, strlen(vesctcp_in_use));
-        if (r < 0) {
-          printf("Unable to write to refused client\n");
-        }
-      }
-    }
+    vesctcp_serve(server_socket);
   } else {
 
     char output[1024];
@@ -2267,6 +2478,8 @@ int main(int argc, char **argv) {
         printf("Used words: %"PRI_UINT"\n", const_heap.next);
         printf("Free words: %"PRI_UINT"\n", const_heap.size - const_heap.next);
         printf("image location: %p \n", (void*)image_storage);
+        printf("--(Evaluator thread)----------------------------------------\n");
+        print_eval_thread_info(printf);
         free(str);
       } else if (strncmp(str, ":prof start", 11) == 0) {
         lbm_prof_init(prof_data,
@@ -16,10 +16,17 @@
   along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#define _POSIX_C_SOURCE 200809L // getdelim, fileno
+
 #include "repl_exts.h"
 
 #include <unistd.h>
 #include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <dirent.h>
 #include <sys/time.h>
 #include <sys/wait.h>
@@ -30,6 +37,10 @@
 #include "extensions/set_extensions.h"
 #include "extensions/display_extensions.h"
 #include "extensions/mutex_extensions.h"
+#include "extensions/ring_extensions.h"
+#include "extensions/persistent_extensions.h"
+#include "extensions/checksum_extensions.h"
+#include "extensions/optimize_extensions.h"
 #include "extensions/lbm_dyn_lib.h"
 #include "extensions/ttf_extensions.h"
 
@@ -192,7 +203,8 @@ static bool file_handle_destructor(lbm_uint value) {
 
 // A filehandle is only a filehandle unless it has been explicitly closed.
 static bool is_file_handle(lbm_value arg) {
-  if ((lbm_uint)lbm_get_custom_descriptor(arg) == (lbm_uint)lbm_file_handle_desc) {
+  if (lbm_is_custom(arg) &&
+      (lbm_uint)lbm_get_custom_descriptor(arg) == (lbm_uint)lbm_file_handle_desc) {
     lbm_file_handle_t *h = (lbm_file_handle_t*)lbm_get_custom_value(arg);
     if (h->fp) return true;
   }
@@ -280,6 +292,120 @@ static lbm_value ext_load_file(lbm_value *args, lbm_uint argn) {
   return res;
 }
 
+// (fread fh arr [offset] [n]) reads up to n bytes into the byte array
+// arr starting at offset. Returns the number of bytes read, 0 at end
+// of file.
+static lbm_value ext_fread(lbm_value *args, lbm_uint argn) {
+  if (argn < 2 || argn > 4 ||
+      !is_file_handle(args[0]) ||
+      !lbm_is_array_rw(args[1])) {
+    return ENC_SYM_TERROR;
+  }
+  for (lbm_uint i = 2; i < argn; i ++) {
+    if (!lbm_is_number(args[i])) return ENC_SYM_TERROR;
+  }
+  lbm_file_handle_t *h = (lbm_file_handle_t*)lbm_get_custom_value(args[0]);
+  lbm_array_header_t *array = (lbm_array_header_t *)lbm_car(args[1]);
+  lbm_uint offset = argn > 2 ? lbm_dec_as_uint(args[2]) : 0;
+  if (offset > array->size) return ENC_SYM_EERROR;
+  lbm_uint n = argn > 3 ? lbm_dec_as_uint(args[3]) : array->size - offset;
+  if (n > array->size - offset) n = array->size - offset;
+  size_t r = fread((uint8_t*)array->data + offset, 1, n, h->fp);
+  return lbm_enc_u((lbm_uint)r);
+}
+
+// (fread-line fh [delim]) reads up to the next delim character, newline
+// by default, and returns it as a string without the delimiter. Returns
+// nil at end of file.
+static lbm_value ext_fread_line(lbm_value *args, lbm_uint argn) {
+  if (argn < 1 || argn > 2 ||
+      !is_file_handle(args[0]) ||
+      (argn == 2 && !lbm_is_number(args[1]))) {
+    return ENC_SYM_TERROR;
+  }
+  lbm_file_handle_t *h = (lbm_file_handle_t*)lbm_get_custom_value(args[0]);
+  int delim = argn == 2 ? (int)lbm_dec_as_char(args[1]) : '\n';
+
+  long pos = ftell(h->fp);
+  char *line = NULL;
+  size_t cap = 0;
+  ssize_t len = getdelim(&line, &cap, delim, h->fp);
+  if (len < 0) {
+    free(line);
+    return ENC_SYM_NIL;
+  }
+  if (line[len - 1] == (char)delim) len --;
+
+  lbm_value res;
+  if (lbm_create_array(&res, (lbm_uint)len + 1)) {
+    lbm_array_header_t *array = (lbm_array_header_t *)lbm_car(res);
+    memcpy(array->data, line, (size_t)len);
+    ((char*)array->data)[len] = 0;
+  } else {
+    // Give the line back so that it is read again when the
+    // evaluator retries after GC.
+    if (pos < 0 || fseek(h->fp, pos, SEEK_SET) < 0) res = ENC_SYM_EERROR;
+    else res = ENC_SYM_MERROR;
+  }
+  free(line);
+  return res;
+}
+
+static const char *lbm_mmap_desc = "Mapped-File";
+
+typedef struct {
+  void *addr;
+  size_t size;
+} lbm_mmap_t;
+
+static bool mmap_destructor(lbm_uint value) {
+  lbm_mmap_t *m = (lbm_mmap_t *)value;
+  munmap(m->addr, m->size);
+  lbm_free(m);
+  return true;
+}
+
+// (fmmap filename) maps a file read-only and returns it as a byte array
+// without copying. The mapping is released when the array is garbage.
+// Returns nil if the file cannot be mapped.
+static lbm_value ext_fmmap(lbm_value *args, lbm_uint argn) {
+  if (argn != 1 || !lbm_is_array_r(args[0])) {
+    return ENC_SYM_TERROR;
+  }
+  char *filename = lbm_dec_str(args[0]);
+  if (!filename) return ENC_SYM_TERROR;
+
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) return ENC_SYM_NIL;
+  struct stat st;
+  if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+    close(fd);
+    return ENC_SYM_NIL;
+  }
+  size_t size = (size_t)st.st_size;
+  void *addr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (addr == MAP_FAILED) return ENC_SYM_NIL;
+
+  lbm_mmap_t *m = lbm_malloc(sizeof(lbm_mmap_t));
+  if (!m) {
+    munmap(addr, size);
+    return ENC_SYM_MERROR;
+  }
+  m->addr = addr;
+  m->size = size;
+  lbm_value owner;
+  if (!lbm_custom_type_create((lbm_uint)m, mmap_destructor, lbm_mmap_desc, &owner)) {
+    munmap(addr, size);
+    lbm_free(m);
+    return ENC_SYM_MERROR;
+  }
+  // On failure the owner is garbage and unmaps the file when collected.
+  lbm_value res;
+  lbm_heap_allocate_foreign_array_view(&res, owner, (uint8_t*)addr, (lbm_uint)size);
+  return res;
+}
+
 static lbm_value ext_fwrite(lbm_value *args, lbm_uint argn) {
 
   lbm_value res = ENC_SYM_TERROR;
@@ -343,6 +469,7 @@ static lbm_value ext_fwrite_value(lbm_value *args, lbm_uint argn) {
         } else {
           printf("ALERT: Unable to flatten result value\n");
         }
+        free(fv.buf);
       } else {
         printf("ALERT: Out of memory to allocate result buffer\n");
       }
@@ -353,6 +480,286 @@ static lbm_value ext_fwrite_value(lbm_value *args, lbm_uint argn) {
   return res;
 }
 
+// ------------------------------------------------------------
+// Value logs
+//
+// A log file is a sequence of records, each a 4 byte little endian
+// length followed by that many bytes of flat value. A log writer
+// flattens values straight into its buffer and writes the buffer when
+// it is full or flushed. With sync set the file is also fsynced on
+// every flush.
+
+#define LOG_DEFAULT_BUF_SIZE 65536
+#define LOG_HEADER_SIZE      4
+
+static const char *lbm_log_writer_desc = "Log-Writer";
+static const char *lbm_log_reader_desc = "Log-Reader";
+
+static lbm_uint sym_eof;
+
+typedef struct {
+  int fd;
+  bool sync;
+  uint8_t *buf;
+  size_t size;
+  size_t pos;
+} lbm_log_writer_t;
+
+typedef struct {
+  FILE *fp;
+  uint8_t *buf;
+  size_t size;
+} lbm_log_reader_t;
+
+// Returns the number of bytes written, less than n on error.
+static size_t log_write_all(int fd, const uint8_t *data, size_t n) {
+  size_t done = 0;
+  while (done < n) {
+    ssize_t r = write(fd, data + done, n - done);
+    if (r < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    done += (size_t)r;
+  }
+  return done;
+}
+
+// On a failed write the records that were not written stay in the
+// buffer, so a later flush can retry them.
+static bool log_flush(lbm_log_writer_t *lw) {
+  size_t done = log_write_all(lw->fd, lw->buf, lw->pos);
+  if (done < lw->pos) {
+    memmove(lw->buf, lw->buf + done, lw->pos - done);
+    lw->pos -= done;
+    return false;
+  }
+  lw->pos = 0;
+  return !lw->sync || fsync(lw->fd) == 0;
+}
+
+static void log_put_header(uint8_t *p, uint32_t n) {
+  p[0] = (uint8_t)n;
+  p[1] = (uint8_t)(n >> 8);
+  p[2] = (uint8_t)(n >> 16);
+  p[3] = (uint8_t)(n >> 24);
+}
+
+static bool log_writer_destructor(lbm_uint value) {
+  lbm_log_writer_t *lw = (lbm_log_writer_t *)value;
+  if (lw->fd >= 0) {
+    log_flush(lw);
+    close(lw->fd);
+  }
+  free(lw->buf);
+  lbm_free(lw);
+  return true;
+}
+
+static bool log_reader_destructor(lbm_uint value) {
+  lbm_log_reader_t *lr = (lbm_log_reader_t *)value;
+  if (lr->fp) fclose(lr->fp);
+  free(lr->buf);
+  lbm_free(lr);
+  return true;
+}
+
+static lbm_log_writer_t *get_log_writer(lbm_value v) {
+  if (lbm_is_custom(v) &&
+      (lbm_uint)lbm_get_custom_descriptor(v) == (lbm_uint)lbm_log_writer_desc) {
+    lbm_log_writer_t *lw = (lbm_log_writer_t*)lbm_get_custom_value(v);
+    if (lw->fd >= 0) return lw;
+  }
+  return NULL;
+}
+
+static lbm_log_reader_t *get_log_reader(lbm_value v) {
+  if (lbm_is_custom(v) &&
+      (lbm_uint)lbm_get_custom_descriptor(v) == (lbm_uint)lbm_log_reader_desc) {
+    lbm_log_reader_t *lr = (lbm_log_reader_t*)lbm_get_custom_value(v);
+    if (lr->fp) return lr;
+  }
+  return NULL;
+}
+
+// (log-open filename [buf-size] [sync]) opens filename for appending
+// and returns a log writer, or nil if the file cannot be opened.
+static lbm_value ext_log_open(lbm_value *args, lbm_uint argn) {
+  if (argn < 1 || argn > 3 ||
+      !lbm_is_array_r(args[0]) ||
+      (argn >= 2 && !lbm_is_number(args[1]))) {
+    return ENC_SYM_TERROR;
+  }
+  char *filename = lbm_dec_str(args[0]);
+  if (!filename) return ENC_SYM_TERROR;
+  size_t size = argn >= 2 ? (size_t)lbm_dec_as_u32(args[1]) : LOG_DEFAULT_BUF_SIZE;
+  if (size < LOG_HEADER_SIZE) size = LOG_HEADER_SIZE;
+
+  lbm_log_writer_t *lw = lbm_malloc(sizeof(lbm_log_writer_t));
+  if (!lw) return ENC_SYM_MERROR;
+  lw->buf = malloc(size);
+  if (!lw->buf) {
+    lbm_free(lw);
+    return ENC_SYM_MERROR;
+  }
+  lw->fd = open(filename, O_WRONLY | O_APPEND | O_CREAT, 0644);
+  if (lw->fd < 0) {
+    free(lw->buf);
+    lbm_free(lw);
+    return ENC_SYM_NIL;
+  }
+  lw->sync = argn == 3 && !lbm_is_symbol_nil(args[2]);
+  lw->size = size;
+  lw->pos = 0;
+
+  lbm_value res;
+  if (!lbm_custom_type_create((lbm_uint)lw, log_writer_destructor, lbm_log_writer_desc, &res)) {
+    close(lw->fd);
+    free(lw->buf);
+    lbm_free(lw);
+    return ENC_SYM_MERROR;
+  }
+  return res;
+}
+
+// (log-write lw v) appends v to the log.
+static lbm_value ext_log_write(lbm_value *args, lbm_uint argn) {
+  lbm_log_writer_t *lw;
+  if (argn != 2 || !(lw = get_log_writer(args[0]))) {
+    return ENC_SYM_TERROR;
+  }
+  lbm_set_max_flatten_depth(10000);
+  int32_t fv_size = flatten_value_size(args[1], 0);
+  if (fv_size <= 0) return ENC_SYM_EERROR;
+  size_t rec_size = LOG_HEADER_SIZE + (size_t)fv_size;
+
+  if (rec_size > lw->size - lw->pos) {
+    if (!log_flush(lw)) return ENC_SYM_EERROR;
+  }
+
+  lbm_flat_value_t fv;
+  bool direct = rec_size > lw->size;
+  if (direct) {
+    // Larger than the whole buffer, write it on its own.
+    fv.buf = malloc(rec_size);
+    if (!fv.buf) return ENC_SYM_MERROR;
+  } else {
+    fv.buf = lw->buf + lw->pos;
+  }
+  fv.buf_size = (lbm_uint)rec_size;
+  fv.buf_pos = LOG_HEADER_SIZE;
+  log_put_header(fv.buf, (uint32_t)fv_size);
+
+  lbm_value res = ENC_SYM_TRUE;
+  if (flatten_value_c(&fv, args[1]) != FLATTEN_VALUE_OK) {
+    res = ENC_SYM_EERROR;
+  } else if (direct) {
+    if (log_write_all(lw->fd, fv.buf, rec_size) < rec_size ||
+        (lw->sync && fsync(lw->fd) != 0)) {
+      res = ENC_SYM_EERROR;
+    }
+  } else {
+    lw->pos += rec_size;
+  }
+  if (direct) free(fv.buf);
+  return res;
+}
+
+// (log-flush lw) writes out buffered records.
+static lbm_value ext_log_flush(lbm_value *args, lbm_uint argn) {
+  lbm_log_writer_t *lw;
+  if (argn != 1 || !(lw = get_log_writer(args[0]))) {
+    return ENC_SYM_TERROR;
+  }
+  return log_flush(lw) ? ENC_SYM_TRUE : ENC_SYM_EERROR;
+}
+
+// (log-close lw) flushes and closes the log. Also done by GC. If the
+// flush fails the log is left open with the records still buffered.
+static lbm_value ext_log_close(lbm_value *args, lbm_uint argn) {
+  lbm_log_writer_t *lw;
+  if (argn != 1 || !(lw = get_log_writer(args[0]))) {
+    return ENC_SYM_TERROR;
+  }
+  if (!log_flush(lw)) return ENC_SYM_EERROR;
+  close(lw->fd);
+  lw->fd = -1;
+  return ENC_SYM_TRUE;
+}
+
+// (log-reader filename) returns a reader for a log file, or nil if the
+// file cannot be opened.
+static lbm_value ext_log_reader(lbm_value *args, lbm_uint argn) {
+  if (argn != 1 || !lbm_is_array_r(args[0])) {
+    return ENC_SYM_TERROR;
+  }
+  char *filename = lbm_dec_str(args[0]);
+  if (!filename) return ENC_SYM_TERROR;
+
+  lbm_log_reader_t *lr = lbm_malloc(sizeof(lbm_log_reader_t));
+  if (!lr) return ENC_SYM_MERROR;
+  lr->fp = fopen(filename, "rb");
+  if (!lr->fp) {
+    lbm_free(lr);
+    return ENC_SYM_NIL;
+  }
+  lr->buf = NULL;
+  lr->size = 0;
+
+  lbm_value res;
+  if (!lbm_custom_type_create((lbm_uint)lr, log_reader_destructor, lbm_log_reader_desc, &res)) {
+    fclose(lr->fp);
+    lbm_free(lr);
+    return ENC_SYM_MERROR;
+  }
+  return res;
+}
+
+// (log-next lr) returns the next value in the log, or the symbol eof
+// after the last complete record.
+// Move back to the start of a record that could not be read in full
+// so that it is read again once the rest has been written.
+static lbm_value log_reader_rewind(lbm_log_reader_t *lr, long pos, lbm_value res) {
+  if (pos < 0 || fseek(lr->fp, pos, SEEK_SET) < 0) return ENC_SYM_EERROR;
+  return res;
+}
+
+static lbm_value ext_log_next(lbm_value *args, lbm_uint argn) {
+  lbm_log_reader_t *lr;
+  if (argn != 1 || !(lr = get_log_reader(args[0]))) {
+    return ENC_SYM_TERROR;
+  }
+  long pos = ftell(lr->fp);
+  uint8_t h[LOG_HEADER_SIZE];
+  if (fread(h, 1, LOG_HEADER_SIZE, lr->fp) != LOG_HEADER_SIZE) {
+    return log_reader_rewind(lr, pos, lbm_enc_sym(sym_eof));
+  }
+  size_t n = (size_t)h[0] | ((size_t)h[1] << 8) | ((size_t)h[2] << 16) | ((size_t)h[3] << 24);
+  if (n > lr->size) {
+    uint8_t *b = realloc(lr->buf, n);
+    if (!b) return log_reader_rewind(lr, pos, ENC_SYM_EERROR);
+    lr->buf = b;
+    lr->size = n;
+  }
+  if (fread(lr->buf, 1, n, lr->fp) != n) {
+    // A record that is still being written or was cut short, for
+    // example by a crash while logging.
+    return log_reader_rewind(lr, pos, lbm_enc_sym(sym_eof));
+  }
+
+  lbm_flat_value_t fv;
+  fv.buf = lr->buf;
+  fv.buf_size = (lbm_uint)n;
+  fv.buf_pos = 0;
+  lbm_value res;
+  if (!lbm_unflatten_value(&fv, &res) &&
+      res == ENC_SYM_MERROR) {
+    // Read the record again when the evaluator retries.
+    res = log_reader_rewind(lr, pos, res);
+  }
+  return res;
+}
+
 static lbm_value ext_fwrite_image(lbm_value *args, lbm_uint argn) {
 
   lbm_value res = ENC_SYM_TERROR;
@@ -749,18 +1156,33 @@ int init_exts(void) {
   lbm_set_extensions_init();
   lbm_display_extensions_init();
   lbm_mutex_extensions_init();
+  lbm_ring_extensions_init();
+  lbm_persistent_extensions_init();
+  lbm_checksum_extensions_init();
+  lbm_optimize_extensions_init();
   lbm_dyn_lib_init();
   lbm_ttf_extensions_init();
 
+  lbm_add_symbol_const("eof", &sym_eof);
+
   lbm_add_extension("unsafe-call-system", ext_unsafe_call_system);
   lbm_add_extension("exec", ext_exec);
   lbm_add_extension("fclose", ext_fclose);
   lbm_add_extension("fopen", ext_fopen);
   lbm_add_extension("load-file", ext_load_file);
+  lbm_add_extension("fread", ext_fread);
+  lbm_add_extension("fread-line", ext_fread_line);
+  lbm_add_extension("fmmap", ext_fmmap);
   lbm_add_extension("fwrite", ext_fwrite);
   lbm_add_extension("fwrite-str", ext_fwrite_str);
   lbm_add_extension("fwrite-value", ext_fwrite_value);
   lbm_add_extension("fwrite-image", ext_fwrite_image);
+  lbm_add_extension("log-open", ext_log_open);
+  lbm_add_extension("log-write", ext_log_write);
+  lbm_add_extension("log-flush", ext_log_flush);
+  lbm_add_extension("log-close", ext_log_close);
+  lbm_add_extension("log-reader", ext_log_reader);
+  lbm_add_extension("log-next", ext_log_next);
   lbm_add_extension("print", ext_print);
   lbm_add_extension("systime", ext_systime);
   lbm_add_extension("secs-since", ext_secs_since);
@@ -24,7 +24,7 @@
 #include "env.h"
 #include "lbm_memory.h"
 
-static lbm_value env_global[GLOBAL_ENV_ROOTS];
+static LBM_INSTANCE_LOCAL lbm_value env_global[GLOBAL_ENV_ROOTS];
 
 int lbm_init_env(void) {
   for (int i = 0; i < GLOBAL_ENV_ROOTS; i ++) {
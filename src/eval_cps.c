@@ -38,8 +38,8 @@
 #include <setjmp.h>
 #include <stdarg.h>
 
-static jmp_buf error_jmp_buf;
-static jmp_buf critical_error_jmp_buf;
+static LBM_INSTANCE_LOCAL jmp_buf error_jmp_buf;
+static LBM_INSTANCE_LOCAL jmp_buf critical_error_jmp_buf;
 
 #define S_TO_US(X) (lbm_uint)((X) * 1000000)
 
@@ -60,45 +60,56 @@ static jmp_buf critical_error_jmp_buf;
 #define APPLICATION_START          CONTINUATION(10)
 #define EVAL_R                     CONTINUATION(11)
 #define RESUME                     CONTINUATION(12)
-#define CLOSURE_ARGS               CONTINUATION(13)
-#define EXIT_ATOMIC                CONTINUATION(14)
-#define READ_NEXT_TOKEN            CONTINUATION(15)
-#define READ_APPEND_CONTINUE       CONTINUATION(16)
-#define READ_EVAL_CONTINUE         CONTINUATION(17)
-#define READ_EXPECT_CLOSEPAR       CONTINUATION(18)
-#define READ_DOT_TERMINATE         CONTINUATION(19)
-#define READ_DONE                  CONTINUATION(20)
-#define READ_START_BYTEARRAY       CONTINUATION(21)
-#define READ_APPEND_BYTEARRAY      CONTINUATION(22)
-#define MAP                        CONTINUATION(23)
-#define MATCH_GUARD                CONTINUATION(24)
-#define TERMINATE                  CONTINUATION(25)
-#define PROGN_VAR                  CONTINUATION(26)
-#define SETQ                       CONTINUATION(27)
-#define MOVE_TO_FLASH              CONTINUATION(28)
-#define MOVE_VAL_TO_FLASH_DISPATCH CONTINUATION(29)
-#define MOVE_LIST_TO_FLASH         CONTINUATION(30)
-#define CLOSE_LIST_IN_FLASH        CONTINUATION(31)
-#define QQ_EXPAND_START            CONTINUATION(32)
-#define QQ_EXPAND                  CONTINUATION(33)
-#define QQ_APPEND                  CONTINUATION(34)
-#define QQ_EXPAND_LIST             CONTINUATION(35)
-#define QQ_LIST                    CONTINUATION(36)
-#define KILL                       CONTINUATION(37)
-#define LOOP                       CONTINUATION(38)
-#define LOOP_CONDITION             CONTINUATION(39)
-#define MERGE_REST                 CONTINUATION(40)
-#define MERGE_LAYER                CONTINUATION(41)
-#define CLOSURE_ARGS_REST          CONTINUATION(42)
-#define MOVE_ARRAY_ELTS_TO_FLASH   CONTINUATION(43)
-#define POP_READER_FLAGS           CONTINUATION(44)
-#define EXCEPTION_HANDLER          CONTINUATION(45)
-#define RECV_TO                    CONTINUATION(46)
-#define WRAP_RESULT                CONTINUATION(47)
-#define RECV_TO_RETRY              CONTINUATION(48)
-#define READ_START_ARRAY           CONTINUATION(49)
-#define READ_APPEND_ARRAY          CONTINUATION(50)
-#define NUM_CONTINUATIONS          51
+#define EXIT_ATOMIC                CONTINUATION(13)
+#define READ_NEXT_TOKEN            CONTINUATION(14)
+#define READ_APPEND_CONTINUE       CONTINUATION(15)
+#define READ_EVAL_CONTINUE         CONTINUATION(16)
+#define READ_EXPECT_CLOSEPAR       CONTINUATION(17)
+#define READ_DOT_TERMINATE         CONTINUATION(18)
+#define READ_DONE                  CONTINUATION(19)
+#define READ_START_BYTEARRAY       CONTINUATION(20)
+#define READ_APPEND_BYTEARRAY      CONTINUATION(21)
+#define MAP                        CONTINUATION(22)
+#define MATCH_GUARD                CONTINUATION(23)
+#define TERMINATE                  CONTINUATION(24)
+#define PROGN_VAR                  CONTINUATION(25)
+#define SETQ                       CONTINUATION(26)
+#define MOVE_TO_FLASH              CONTINUATION(27)
+#define MOVE_VAL_TO_FLASH_DISPATCH CONTINUATION(28)
+#define MOVE_LIST_TO_FLASH         CONTINUATION(29)
+#define CLOSE_LIST_IN_FLASH        CONTINUATION(30)
+#define QQ_EXPAND_START            CONTINUATION(31)
+#define QQ_EXPAND                  CONTINUATION(32)
+#define QQ_APPEND                  CONTINUATION(33)
+#define QQ_EXPAND_LIST             CONTINUATION(34)
+#define QQ_LIST                    CONTINUATION(35)
+#define KILL                       CONTINUATION(36)
+#define LOOP                       CONTINUATION(37)
+#define LOOP_CONDITION             CONTINUATION(38)
+#define MERGE_REST                 CONTINUATION(39)
+#define MERGE_LAYER                CONTINUATION(40)
+#define MOVE_ARRAY_ELTS_TO_FLASH   CONTINUATION(41)
+#define POP_READER_FLAGS           CONTINUATION(42)
+#define EXCEPTION_HANDLER          CONTINUATION(43)
+#define RECV_TO                    CONTINUATION(44)
+#define WRAP_RESULT                CONTINUATION(45)
+#define RECV_TO_RETRY              CONTINUATION(46)
+#define READ_START_ARRAY           CONTINUATION(47)
+#define READ_APPEND_ARRAY          CONTINUATION(48)
+#define ARRAY_MAP                  CONTINUATION(49)
+#define ARRAY_FOLD                 CONTINUATION(50)
+#define MACRO_EXPANDED             CONTINUATION(51)
+#define MACROEXPAND_LIST           CONTINUATION(52)
+#define MACROEXPAND_RESULT         CONTINUATION(53)
+#define MACROEXPAND_RETRY          CONTINUATION(54)
+#define FILTER                     CONTINUATION(55)
+#define FOLD                       CONTINUATION(56)
+#define FILTER_FUNDAMENTAL         CONTINUATION(57)
+#define FOLD_FUNDAMENTAL           CONTINUATION(58)
+#define ARRAY_MAP_FUNDAMENTAL      CONTINUATION(59)
+#define ARRAY_FOLD_FUNDAMENTAL     CONTINUATION(60)
+#define EVAL_DATA_DONE             CONTINUATION(61)
+#define NUM_CONTINUATIONS          62
 
 #define FM_NEED_GC       -1
 #define FM_NO_MATCH      -2
@@ -125,8 +136,8 @@ typedef enum {
 
 // ////////////////////////////////////////////////////////////
 // Local variables used in sort and merge
-lbm_value symbol_x = ENC_SYM_NIL;
-lbm_value symbol_y = ENC_SYM_NIL;
+LBM_INSTANCE_LOCAL lbm_value symbol_x = ENC_SYM_NIL;
+LBM_INSTANCE_LOCAL lbm_value symbol_y = ENC_SYM_NIL;
 
 
 
@@ -145,7 +156,7 @@ lbm_value symbol_y = ENC_SYM_NIL;
 #else
 #define INFER_CANARY_BITS 0xAAAAAAAAu
 #endif
-lbm_uint INFER_CANARY[1];
+LBM_INSTANCE_LOCAL lbm_uint INFER_CANARY[1];
 
 bool check_infer_canary(void) {
   return INFER_CANARY[0] == INFER_CANARY_BITS;
@@ -171,8 +182,8 @@ const char* lbm_error_str_variable_not_bound = "Variable not bound.";
 const char* lbm_error_str_read_no_mem = "Out of memory while reading.";
 const char* lbm_error_str_qq_expand = "Quasiquotation expansion error.";
 
-static lbm_value lbm_error_suspect;
-static bool lbm_error_has_suspect = false;
+static LBM_INSTANCE_LOCAL lbm_value lbm_error_suspect;
+static LBM_INSTANCE_LOCAL bool lbm_error_has_suspect = false;
 #ifdef LBM_ALWAYS_GC
 
 // TODO: Optimize, In a large number of cases
@@ -231,7 +242,7 @@ typedef struct {
 } eval_context_queue_t;
 
 #ifdef CLEAN_UP_CLOSURES
-static lbm_value clean_cl_env_symbol = ENC_SYM_NIL;
+static LBM_INSTANCE_LOCAL lbm_value clean_cl_env_symbol = ENC_SYM_NIL;
 #endif
 
 static int gc(void);
@@ -244,12 +255,13 @@ static void error_at_ctx(lbm_value err_val, lbm_value at);
 #endif
 static void enqueue_ctx(eval_context_queue_t *q, eval_context_t *ctx);
 static void mailbox_add_mail(eval_context_t *ctx, lbm_value mail);
+static void macroexpand_all(eval_context_t *ctx, lbm_value e);
 
 // The currently executing context.
-eval_context_t *ctx_running = NULL;
-volatile bool  lbm_system_sleeping = false;
+LBM_INSTANCE_LOCAL eval_context_t *ctx_running = NULL;
+LBM_INSTANCE_LOCAL volatile bool  lbm_system_sleeping = false;
 
-static volatile bool gc_requested = false;
+static LBM_INSTANCE_LOCAL volatile bool gc_requested = false;
 void lbm_request_gc(void) {
   gc_requested = true;
 }
@@ -273,24 +285,24 @@ void lbm_request_gc(void) {
 #define EVAL_STEPS_QUOTA   10
 
 #ifdef LBM_USE_TIME_QUOTA
-static volatile uint32_t eval_time_refill = EVAL_TIME_QUOTA;
-static uint32_t eval_time_quota = EVAL_TIME_QUOTA;
-static uint32_t eval_current_quota = 0;
+static LBM_INSTANCE_LOCAL volatile uint32_t eval_time_refill = EVAL_TIME_QUOTA;
+static LBM_INSTANCE_LOCAL uint32_t eval_time_quota = EVAL_TIME_QUOTA;
+static LBM_INSTANCE_LOCAL uint32_t eval_current_quota = 0;
 void lbm_set_eval_time_quota(uint32_t quota) {
   eval_time_refill = quota;
 }
 #else
-static volatile uint32_t eval_steps_refill = EVAL_STEPS_QUOTA;
-static uint32_t eval_steps_quota = EVAL_STEPS_QUOTA;
+static LBM_INSTANCE_LOCAL volatile uint32_t eval_steps_refill = EVAL_STEPS_QUOTA;
+static LBM_INSTANCE_LOCAL uint32_t eval_steps_quota = EVAL_STEPS_QUOTA;
 void lbm_set_eval_step_quota(uint32_t quota) {
   eval_steps_refill = quota;
 }
 #endif
 
-static uint32_t          eval_cps_run_state = EVAL_CPS_STATE_DEAD;
-static volatile uint32_t eval_cps_next_state = EVAL_CPS_STATE_NONE;
-static volatile uint32_t eval_cps_next_state_arg = 0;
-static volatile bool     eval_cps_state_changed = false;
+static LBM_INSTANCE_LOCAL uint32_t          eval_cps_run_state = EVAL_CPS_STATE_DEAD;
+static LBM_INSTANCE_LOCAL volatile uint32_t eval_cps_next_state = EVAL_CPS_STATE_NONE;
+static LBM_INSTANCE_LOCAL volatile uint32_t eval_cps_next_state_arg = 0;
+static LBM_INSTANCE_LOCAL volatile bool     eval_cps_state_changed = false;
 
 static void usleep_nonsense(uint32_t us) {
   (void) us;
@@ -324,13 +336,13 @@ static void user_callback_nonsense(void *arg) {
   return;
 }
 
-static void (*critical_error_callback)(void) = critical_nonsense;
-static void (*usleep_callback)(uint32_t) = usleep_nonsense;
-static uint32_t (*timestamp_us_callback)(void) = timestamp_nonsense;
-static void (*ctx_done_callback)(eval_context_t *) = ctx_done_nonsense;
-static int (*printf_callback)(const char *, ...) = printf_nonsense;
-static bool (*dynamic_load_callback)(const char *, const char **) = dynamic_load_nonsense;
-static void (*user_callback)(void *) = user_callback_nonsense;
+static LBM_INSTANCE_LOCAL void (*critical_error_callback)(void) = critical_nonsense;
+static LBM_INSTANCE_LOCAL void (*usleep_callback)(uint32_t) = usleep_nonsense;
+static LBM_INSTANCE_LOCAL uint32_t (*timestamp_us_callback)(void) = timestamp_nonsense;
+static LBM_INSTANCE_LOCAL void (*ctx_done_callback)(eval_context_t *) = ctx_done_nonsense;
+static LBM_INSTANCE_LOCAL int (*printf_callback)(const char *, ...) = printf_nonsense;
+static LBM_INSTANCE_LOCAL bool (*dynamic_load_callback)(const char *, const char **) = dynamic_load_nonsense;
+static LBM_INSTANCE_LOCAL void (*user_callback)(void *) = user_callback_nonsense;
 
 void lbm_set_user_callback(void (*fptr)(void *)) {
   if (fptr == NULL) user_callback = user_callback_nonsense;
@@ -367,14 +379,20 @@ void lbm_set_dynamic_load_callback(bool (*fptr)(const char *, const char **)) {
   else  dynamic_load_callback = fptr;
 }
 
-static volatile lbm_event_t *lbm_events = NULL;
-static unsigned int lbm_events_head = 0;
-static unsigned int lbm_events_tail = 0;
-static unsigned int lbm_events_max  = 0;
-static bool         lbm_events_full = false;
-static mutex_t      lbm_events_mutex;
-static bool         lbm_events_mutex_initialized = false;
-static volatile lbm_cid  lbm_event_handler_pid = -1;
+static LBM_INSTANCE_LOCAL bool macro_expand_on_load = false;
+
+void lbm_set_macro_expand_on_load(bool on) {
+  macro_expand_on_load = on;
+}
+
+static LBM_INSTANCE_LOCAL volatile lbm_event_t *lbm_events = NULL;
+static LBM_INSTANCE_LOCAL unsigned int lbm_events_head = 0;
+static LBM_INSTANCE_LOCAL unsigned int lbm_events_tail = 0;
+static LBM_INSTANCE_LOCAL unsigned int lbm_events_max  = 0;
+static LBM_INSTANCE_LOCAL bool         lbm_events_full = false;
+static LBM_INSTANCE_LOCAL mutex_t      lbm_events_mutex;
+static LBM_INSTANCE_LOCAL bool         lbm_events_mutex_initialized = false;
+static LBM_INSTANCE_LOCAL volatile lbm_cid  lbm_event_handler_pid = -1;
 
 lbm_cid lbm_get_event_handler_pid(void) {
   return lbm_event_handler_pid;
@@ -459,27 +477,27 @@ bool lbm_event_queue_is_empty(void) {
   return empty;
 }
 
-static bool              eval_running = false;
-static volatile bool     blocking_extension = false;
-static mutex_t           blocking_extension_mutex;
-static bool              blocking_extension_mutex_initialized = false;
-static lbm_uint          blocking_extension_timeout_us = 0;
-static bool              blocking_extension_timeout = false;
+static LBM_INSTANCE_LOCAL bool              eval_running = false;
+static LBM_INSTANCE_LOCAL volatile bool     blocking_extension = false;
+static LBM_INSTANCE_LOCAL mutex_t           blocking_extension_mutex;
+static LBM_INSTANCE_LOCAL bool              blocking_extension_mutex_initialized = false;
+static LBM_INSTANCE_LOCAL lbm_uint          blocking_extension_timeout_us = 0;
+static LBM_INSTANCE_LOCAL bool              blocking_extension_timeout = false;
 
-static bool              is_atomic = false;
+static LBM_INSTANCE_LOCAL bool              is_atomic = false;
 
 /* Process queues */
-static eval_context_queue_t blocked  = {NULL, NULL};
-static eval_context_queue_t queue    = {NULL, NULL};
+static LBM_INSTANCE_LOCAL eval_context_queue_t blocked  = {NULL, NULL};
+static LBM_INSTANCE_LOCAL eval_context_queue_t queue    = {NULL, NULL};
 
 /* one mutex for all queue operations */
-mutex_t qmutex;
-bool    qmutex_initialized = false;
+LBM_INSTANCE_LOCAL mutex_t qmutex;
+LBM_INSTANCE_LOCAL bool    qmutex_initialized = false;
 
 
 // MODES
-static volatile bool lbm_verbose = false;
-static volatile bool lbm_hide_trapped_error = false;
+static LBM_INSTANCE_LOCAL volatile bool lbm_verbose = false;
+static LBM_INSTANCE_LOCAL volatile bool lbm_hide_trapped_error = false;
 
 void lbm_toggle_verbose(void) {
   lbm_verbose = !lbm_verbose;
@@ -653,42 +671,6 @@ static lbm_value get_cadr(lbm_value a) {
   return(ENC_SYM_TERROR);
 }
 
-// Allocate a binding and attach it to a list (if so desired)
-static lbm_value allocate_binding(lbm_value key, lbm_value val, lbm_value the_cdr) {
-#ifdef LBM_ALWAYS_GC
-  lbm_gc_mark_phase(key);
-  lbm_gc_mark_phase(val);
-  lbm_gc_mark_phase(the_cdr);
-  gc();
-  if (lbm_heap_num_free() < 2) {
-    ERROR_CTX(ENC_SYM_MERROR);
-  }
-#else
-  if (lbm_heap_num_free() < 2) {
-    lbm_gc_mark_phase(key);
-    lbm_gc_mark_phase(val);
-    lbm_gc_mark_phase(the_cdr);
-    gc();
-    if (lbm_heap_num_free() < 2) {
-      ERROR_CTX(ENC_SYM_MERROR);
-    }
-  }
-#endif
-  // If num_free is calculated correctly, freelist is definitely a cons-cell.
-  lbm_cons_t* heap = lbm_heap_state.heap;
-  lbm_value binding_cell = lbm_heap_state.freelist;
-  lbm_uint binding_cell_ix = lbm_dec_ptr(binding_cell);
-  lbm_value list_cell = heap[binding_cell_ix].cdr;
-  lbm_uint list_cell_ix = lbm_dec_ptr(list_cell);
-  lbm_heap_state.freelist = heap[list_cell_ix].cdr;
-  lbm_heap_state.num_alloc += 2;
-  heap[binding_cell_ix].car = key;
-  heap[binding_cell_ix].cdr = val;
-  heap[list_cell_ix].car = binding_cell;
-  heap[list_cell_ix].cdr = the_cdr;
-  return list_cell;
-}
-
 #define CLO_PARAMS 0
 #define CLO_BODY   1
 #define CLO_ENV    2
@@ -1114,10 +1096,10 @@ static void error_ctx_base(lbm_value err_val, bool has_at, lbm_value at, unsigne
     lbm_critical_error();
   }
 
-  bool print_trapped = !lbm_hide_trapped_error && (ctx_running->flags & EVAL_CPS_CONTEXT_FLAG_TRAP_UNROLL_RETURN);
+  bool trapped = ctx_running->flags & EVAL_CPS_CONTEXT_FLAG_TRAP_UNROLL_RETURN;
 
-  if (!(lbm_hide_trapped_error &&
-        (ctx_running->flags & EVAL_CPS_CONTEXT_FLAG_TRAP_UNROLL_RETURN))) {
+  // Nothing is formatted for an error that is trapped and hidden.
+  if (!(lbm_hide_trapped_error && trapped)) {
     print_error_message(err_val,
                         has_at,
                         at,
@@ -1127,12 +1109,14 @@ static void error_ctx_base(lbm_value err_val, bool has_at, lbm_value at, unsigne
                         ctx_running->row1,
                         ctx_running->id,
                         ctx_running->name,
-                        print_trapped
+                        trapped
                         );
-  }
 #ifdef LBM_USE_ERROR_LINENO
-  printf_callback("eval_cps.c line number: %d\n", line_no);
+    printf_callback("eval_cps.c line number: %d\n", line_no);
 #endif
+  } else {
+    lbm_error_has_suspect = false;
+  }
   if (ctx_running->flags & EVAL_CPS_CONTEXT_FLAG_TRAP) {
     if (lbm_heap_num_free() < 3) {
       gc();
@@ -1147,21 +1131,31 @@ static void error_ctx_base(lbm_value err_val, bool has_at, lbm_value at, unsigne
       }
     }
     // context dies.
-  } else if ((ctx_running->flags & EVAL_CPS_CONTEXT_FLAG_TRAP_UNROLL_RETURN) &&
-      (err_val != ENC_SYM_FATAL_ERROR)) {
-    lbm_uint v;
-    while (ctx_running->K.sp > 0) {
-      lbm_pop(&ctx_running->K, &v);
-      if (v == EXCEPTION_HANDLER) { // context continues executing.
-        lbm_value *sptr = get_stack_ptr(ctx_running, 2);
-        lbm_set_car(sptr[0], ENC_SYM_EXIT_ERROR);
-        stack_reserve(ctx_running, 1)[0] = EXCEPTION_HANDLER;
-        ctx_running->app_cont = true;
-        ctx_running->r = err_val;
-        longjmp(error_jmp_buf, 1);
+  } else if (trapped && (err_val != ENC_SYM_FATAL_ERROR)) {
+    // Trap frames are linked through the stack and ctx->trap_sp
+    // points at the innermost one. Should the link not check out the
+    // stack is searched instead.
+    lbm_uint tsp = ctx_running->trap_sp;
+    if (tsp > 0 && tsp <= ctx_running->K.sp &&
+        ctx_running->K.data[tsp-1] == EXCEPTION_HANDLER) {
+      ctx_running->K.sp = tsp - 1;
+    } else {
+      lbm_uint v = 0;
+      while (ctx_running->K.sp > 0 && v != EXCEPTION_HANDLER) {
+        lbm_pop(&ctx_running->K, &v);
       }
+      if (v != EXCEPTION_HANDLER) {
+        err_val = ENC_SYM_FATAL_ERROR;
+      }
+    }
+    if (err_val != ENC_SYM_FATAL_ERROR) { // context continues executing.
+      lbm_value *sptr = get_stack_ptr(ctx_running, 3);
+      lbm_set_car(sptr[0], ENC_SYM_EXIT_ERROR);
+      stack_reserve(ctx_running, 1)[0] = EXCEPTION_HANDLER;
+      ctx_running->app_cont = true;
+      ctx_running->r = err_val;
+      longjmp(error_jmp_buf, 1);
     }
-    err_val = ENC_SYM_FATAL_ERROR;
   }
   ctx_running->r = err_val;
   finish_ctx();
@@ -1405,6 +1399,7 @@ static lbm_cid lbm_create_ctx_parent(lbm_value program, lbm_value env, lbm_uint
   ctx->flags = context_flags;
   ctx->num_mail = 0;
   ctx->app_cont = false;
+  ctx->trap_sp = 0;
   ctx->timestamp = 0;
   ctx->sleep_us = 0;
   ctx->state = LBM_THREAD_STATE_READY;
@@ -1439,6 +1434,15 @@ lbm_cid lbm_create_ctx(lbm_value program, lbm_value env, lbm_uint stack_size, ch
                                name);
 }
 
+lbm_cid lbm_create_load_ctx(lbm_value program, lbm_value env, lbm_uint stack_size, char *name) {
+  return lbm_create_ctx_parent(program,
+                               env,
+                               stack_size,
+                               -1,
+                               EVAL_CPS_CONTEXT_FLAG_LOAD,
+                               name);
+}
+
 bool lbm_mailbox_change_size(eval_context_t *ctx, lbm_uint new_size) {
 
   lbm_value *mailbox = NULL;
@@ -1494,6 +1498,12 @@ static void advance_ctx(eval_context_t *ctx) {
     ctx->curr_exp = cell->car;
     ctx->program = cell->cdr;
     ctx->curr_env = ENC_SYM_NIL;
+    if (macro_expand_on_load) {
+      lbm_value *sptr = stack_reserve(ctx, 2);
+      sptr[0] = ENC_SYM_NIL;
+      sptr[1] = EVAL_R;
+      macroexpand_all(ctx, ctx->curr_exp);
+    }
   } else {
     if (ctx_running == ctx) {  // This should always be the case because of odd historical reasons.
       ok_ctx();
@@ -1668,6 +1678,25 @@ static bool match(lbm_value p, lbm_value e, lbm_value *env) {
   return r;
 }
 
+// Check if p matches e without binding anything. Used to reject
+// clauses before match allocates bindings for them. Compares type,
+// symbols and list shape and walks list spines in a loop.
+static bool match_test(lbm_value p, lbm_value e) {
+  while (true) {
+    if (get_match_binder_variable(p)) return true;
+    if (lbm_is_symbol(p)) {
+      return (p == ENC_SYM_DONTCARE || p == e);
+    }
+    if (!lbm_is_cons(p)) return struct_eq(p, e);
+    if (!lbm_is_cons(e)) return false;
+    lbm_cons_t *p_cell = lbm_ref_cell(p);
+    lbm_cons_t *e_cell = lbm_ref_cell(e);
+    if (!match_test(p_cell->car, e_cell->car)) return false;
+    p = p_cell->cdr;
+    e = e_cell->cdr;
+  }
+}
+
 // Find match is not very picky about syntax.
 // A completely malformed recv form is most likely to
 // just return no_match.
@@ -1687,7 +1716,8 @@ static int find_match(lbm_value plist, lbm_value *earr, lbm_uint num, lbm_value
         ERROR_AT_CTX(ENC_SYM_EERROR,me);
         return FM_NO_MATCH; // PHONY for SA
       }
-      if (match(p[0], curr_e, env)) {
+      if (match_test(p[0], curr_e) &&
+          match(p[0], curr_e, env)) {
         *e = p[1];
          return n;
       }
@@ -1854,8 +1884,78 @@ static void eval_atomic(eval_context_t *ctx) {
   eval_progn(ctx);
 }
 
+static void eval_call_cc_unsafe(eval_context_t *ctx);
+static void eval_call_cc_copy(eval_context_t *ctx);
+
+#define CALLCC_ESCAPE_MAX_DEPTH 32
+
+// Syntactic check that the continuation k can only be invoked during
+// the extent of the call-cc. k may only occur as the operator of an
+// application and not at all inside a nested lambda. Macro calls are
+// rejected as their expansion is not known yet. The check is
+// conservative, code that it rejects is run with a full stack copy.
+static bool callcc_escape_only(lbm_value e, lbm_value k, bool in_lambda, int depth) {
+  if (!lbm_is_cons(e)) return e != k;
+  if (depth > CALLCC_ESCAPE_MAX_DEPTH) return false;
+  lbm_value h = get_car(e);
+  if (h == k) {
+    if (in_lambda) return false;
+  } else if (h == ENC_SYM_LAMBDA || h == ENC_SYM_CLOSURE) {
+    in_lambda = true;
+  } else if (lbm_is_symbol(h) && lbm_dec_sym(h) >= RUNTIME_SYMBOLS_START) {
+    lbm_value v;
+    if (lbm_global_env_lookup(&v, h)) {
+      if (lbm_is_cons(v) && get_car(v) == ENC_SYM_MACRO) return false;
+    } else {
+      const char *code_str = NULL;
+      if (dynamic_load_callback(lbm_get_name_by_symbol(lbm_dec_sym(h)), &code_str)) return false;
+    }
+  } else if (!callcc_escape_only(h, k, in_lambda, depth + 1)) {
+    return false;
+  }
+  e = get_cdr(e);
+  while (lbm_is_cons(e)) {
+    if (!callcc_escape_only(get_car(e), k, in_lambda, depth + 1)) return false;
+    e = get_cdr(e);
+  }
+  return e != k;
+}
+
 // (call-cc (lambda (k) .... ))
+//
+// When k is only used for an early exit, (call-cc (lambda (k) body))
+// is rewritten into call-cc-unsafe, which captures the continuation
+// as a stack pointer instead of copying the stack. Otherwise it is
+// rewritten into call-cc-copy so that the check is not repeated.
 static void eval_callcc(eval_context_t *ctx) {
+  lbm_value f = get_cadr(ctx->curr_exp);
+  if (lbm_is_cons(f) && get_car(f) == ENC_SYM_LAMBDA) {
+    lbm_value params = get_cadr(f);
+    lbm_value body = get_cdr(get_cdr(f));
+    bool escape_only = lbm_is_cons(params) && lbm_is_symbol_nil(get_cdr(params)) &&
+                       lbm_is_symbol(get_car(params)) &&
+                       lbm_dec_sym(get_car(params)) >= RUNTIME_SYMBOLS_START;
+    while (escape_only && lbm_is_cons(body)) {
+      escape_only = callcc_escape_only(get_car(body), get_car(params), false, 0);
+      body = get_cdr(body);
+    }
+    if (escape_only) {
+      if (lbm_is_cons_rw(ctx->curr_exp)) {
+        lbm_set_car(ctx->curr_exp, ENC_SYM_CALL_CC_UNSAFE);
+      }
+      eval_call_cc_unsafe(ctx);
+      return;
+    }
+  }
+  if (lbm_is_cons_rw(ctx->curr_exp)) {
+    lbm_set_car(ctx->curr_exp, ENC_SYM_CALL_CC_COPY);
+  }
+  eval_call_cc_copy(ctx);
+}
+
+// (call-cc-copy f)
+// call-cc that always captures the continuation as a copy of the stack.
+static void eval_call_cc_copy(eval_context_t *ctx) {
   lbm_value cont_array;
   lbm_uint *sptr0 = stack_reserve(ctx, 1);
   sptr0[0] = is_atomic ? ENC_SYM_TRUE : ENC_SYM_NIL;
@@ -1874,10 +1974,11 @@ static void eval_callcc(eval_context_t *ctx) {
 
     lbm_value acont = cons_with_gc(ENC_SYM_CONT, cont_array, ENC_SYM_NIL);
     lbm_value arg_list = cons_with_gc(acont, ENC_SYM_NIL, ENC_SYM_NIL);
+    lbm_value app = cons_with_gc(ENC_SYM_NIL, arg_list, ENC_SYM_NIL);
     // Go directly into application evaluation without passing go
     lbm_uint *sptr = stack_reserve(ctx, 2);
     sptr0[0] = ctx->curr_env;
-    sptr[0] = arg_list;
+    sptr[0] = app;
     sptr[1] = APPLICATION_START;
     ctx->curr_exp = get_cadr(ctx->curr_exp);
   } else {
@@ -1901,10 +2002,11 @@ static void eval_call_cc_unsafe(eval_context_t *ctx) {
                                              lbm_enc_i((int32_t)sp),
                                              is_atomic ? ENC_SYM_TRUE : ENC_SYM_NIL, ENC_SYM_NIL));
   lbm_value arg_list = cons_with_gc(acont, ENC_SYM_NIL, ENC_SYM_NIL);
+  lbm_value app = cons_with_gc(ENC_SYM_NIL, arg_list, ENC_SYM_NIL);
   // Go directly into application evaluation without passing go
   lbm_uint *sptr = stack_reserve(ctx, 3);
   sptr[0] = ctx->curr_env;
-  sptr[1] = arg_list;
+  sptr[1] = app;
   sptr[2] = APPLICATION_START;
   ctx->curr_exp = get_cadr(ctx->curr_exp);
 }
@@ -2048,6 +2150,9 @@ static void eval_cond(eval_context_t *ctx) {
 }
 
 static void eval_app_cont(eval_context_t *ctx) {
+  if (lbm_is_cons(get_cdr(ctx->curr_exp))) {
+    ctx->flags &= ~EVAL_CPS_CONTEXT_FLAG_EVAL_DATA;
+  }
   lbm_stack_drop(&ctx->K, 1);
   ctx->app_cont = true;
 }
@@ -2214,10 +2319,12 @@ static void eval_trap(eval_context_t *ctx) {
   lbm_value retval;
   WITH_GC(retval, lbm_heap_allocate_list(2));
   lbm_set_car(retval, ENC_SYM_EXIT_OK); // Assume things will go well.
-  lbm_uint *sptr = stack_reserve(ctx,3);
+  lbm_uint *sptr = stack_reserve(ctx,4);
   sptr[0] = retval;
   sptr[1] = ctx->flags;
-  sptr[2] = EXCEPTION_HANDLER;
+  sptr[2] = lbm_enc_u(ctx->trap_sp);
+  sptr[3] = EXCEPTION_HANDLER;
+  ctx->trap_sp = ctx->K.sp;
   ctx->flags |= EVAL_CPS_CONTEXT_FLAG_TRAP_UNROLL_RETURN;
   ctx->curr_exp = expr;
 }
@@ -2673,7 +2780,11 @@ static void apply_wait(lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
 }
 
 /* (eval expr)
-   (eval env expr) */
+   (eval env expr)
+   The expression is data that the program may look at again, so macro
+   calls in it are not memoized. The flag is cleared by EVAL_DATA_DONE
+   when the outermost eval returns. The eval started by the loader
+   evaluates code and leaves the flag alone. */
 static void apply_eval(lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
   if ( nargs == 1) {
     ctx->curr_exp = args[0];
@@ -2685,6 +2796,12 @@ static void apply_eval(lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
     ERROR_AT_CTX(ENC_SYM_EERROR, ENC_SYM_EVAL);
   }
   lbm_stack_drop(&ctx->K, nargs+1);
+  if (ctx->flags & EVAL_CPS_CONTEXT_FLAG_LOAD) {
+    ctx->flags &= ~EVAL_CPS_CONTEXT_FLAG_LOAD;
+  } else if (!(ctx->flags & EVAL_CPS_CONTEXT_FLAG_EVAL_DATA)) {
+    stack_reserve(ctx, 1)[0] = EVAL_DATA_DONE;
+    ctx->flags |= EVAL_CPS_CONTEXT_FLAG_EVAL_DATA;
+  }
 }
 
 static void apply_eval_program(lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
@@ -2706,13 +2823,24 @@ static void apply_eval_program(lbm_value *args, lbm_uint nargs, eval_context_t *
     // There is always a continuation (DONE).
     // If ctx->program is nil, the stack should contain DONE.
     // after adding an intermediate done for prg, stack becomes DONE, DONE.
-    app_cont = cons_with_gc(ENC_SYM_APP_CONT, ENC_SYM_NIL, prg_copy);
+    // As for eval, macro calls in the program are not memoized
+    // unless it was started by the loader.
+    // (app-cont t) clears the flag again after the program.
+    bool data = !(ctx->flags & (EVAL_CPS_CONTEXT_FLAG_EVAL_DATA |
+                                EVAL_CPS_CONTEXT_FLAG_LOAD));
+    lbm_value clear_flag = ENC_SYM_NIL;
+    if (data) {
+      clear_flag = cons_with_gc(ENC_SYM_TRUE, ENC_SYM_NIL, prg_copy);
+    }
+    app_cont = cons_with_gc(ENC_SYM_APP_CONT, clear_flag, prg_copy);
     app_cont_prg = cons_with_gc(app_cont, ENC_SYM_NIL, prg_copy);
     new_prg = lbm_list_append(app_cont_prg, ctx->program);
     new_prg = lbm_list_append(prg_copy, new_prg);
     // new_prg is guaranteed to be a cons cell or nil
     // even if the eval-program application is syntactically broken.
     stack_reserve(ctx, 1)[0] = DONE;
+    ctx->flags &= ~EVAL_CPS_CONTEXT_FLAG_LOAD;
+    if (data) ctx->flags |= EVAL_CPS_CONTEXT_FLAG_EVAL_DATA;
     ctx->program = get_cdr(new_prg);
     ctx->curr_exp = get_car(new_prg);
   } else {
@@ -2838,6 +2966,323 @@ static void apply_map(lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
   }
 }
 
+// Call a fundamental from C with GC and a retry on out of memory.
+// Values in args must be reachable from the stack.
+static lbm_value array_call_fundamental(lbm_value f, lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
+  lbm_uint ix = SYMBOL_IX(lbm_dec_sym(f));
+  lbm_value r = fundamental_table[ix](args, nargs, ctx);
+  if (lbm_is_symbol_merror(r)) {
+    gc();
+    r = fundamental_table[ix](args, nargs, ctx);
+  }
+  if (lbm_is_error(r)) {
+    ERROR_AT_CTX(r, f);
+  }
+  return r;
+}
+
+static bool is_fundamental(lbm_value f) {
+  return lbm_is_symbol(f) && SYMBOL_KIND(lbm_dec_sym(f)) == SYMBOL_KIND_FUNDAMENTAL;
+}
+
+// Number of elements the fundamental loops of array-map, array-fold,
+// filter, foldl and foldr process before they give other contexts a
+// turn.
+#define FUNDAMENTAL_LOOP_CHUNK 256
+
+// sptr[0]: Result array.
+// sptr[1]: Fundamental to map.
+// sptr[2]: Input array.
+// sptr[3]: Index of the next element.
+static void array_map_fundamental(eval_context_t *ctx) {
+  lbm_value *sptr = get_stack_ptr(ctx, 4);
+  lbm_value f = sptr[1];
+  lbm_array_header_t *res = assume_array(sptr[0]);
+  lbm_array_header_t *arr = assume_array(sptr[2]);
+  // Another context may resize the input between chunks.
+  lbm_uint n = res->size / sizeof(lbm_value);
+  if (arr->size / sizeof(lbm_value) < n) n = arr->size / sizeof(lbm_value);
+  lbm_uint i = lbm_dec_u(sptr[3]);
+  lbm_uint end = i + FUNDAMENTAL_LOOP_CHUNK < n ? i + FUNDAMENTAL_LOOP_CHUNK : n;
+  for (; i < end; i ++) {
+    lbm_value x = ((lbm_value*)arr->data)[i];
+    ((lbm_value*)res->data)[i] = array_call_fundamental(f, &x, 1, ctx);
+  }
+  ctx->app_cont = true;
+  if (i < n) {
+    sptr[3] = lbm_enc_u(i);
+    stack_reserve(ctx, 1)[0] = ARRAY_MAP_FUNDAMENTAL;
+    lbm_surrender_quota();
+    return;
+  }
+  ctx->r = sptr[0];
+  lbm_stack_drop(&ctx->K, 4);
+}
+
+// sptr[0]: Unused.
+// sptr[1]: Fundamental to fold with.
+// sptr[2]: Accumulator.
+// sptr[3]: Input array.
+// sptr[4]: Index of the next element.
+static void array_fold_fundamental(eval_context_t *ctx) {
+  lbm_value *sptr = get_stack_ptr(ctx, 5);
+  lbm_value f = sptr[1];
+  lbm_array_header_t *arr = assume_array(sptr[3]);
+  lbm_uint n = arr->size / sizeof(lbm_value);
+  lbm_uint i = lbm_dec_u(sptr[4]);
+  lbm_uint end = i + FUNDAMENTAL_LOOP_CHUNK < n ? i + FUNDAMENTAL_LOOP_CHUNK : n;
+  for (; i < end; i ++) {
+    lbm_value fargs[2] = {sptr[2], ((lbm_value*)arr->data)[i]};
+    sptr[2] = array_call_fundamental(f, fargs, 2, ctx);
+  }
+  ctx->app_cont = true;
+  if (i < n) {
+    sptr[4] = lbm_enc_u(i);
+    stack_reserve(ctx, 1)[0] = ARRAY_FOLD_FUNDAMENTAL;
+    lbm_surrender_quota();
+    return;
+  }
+  ctx->r = sptr[2];
+  lbm_stack_drop(&ctx->K, 5);
+}
+
+static lbm_value array_allocate_with_gc(lbm_uint n) {
+  lbm_value res;
+  if (!lbm_heap_allocate_lisp_array(&res, n)) {
+    gc();
+    if (!lbm_heap_allocate_lisp_array(&res, n)) {
+      ERROR_CTX(ENC_SYM_MERROR);
+    }
+  }
+  return res;
+}
+
+// (array-map f array)
+//
+// A fundamental, such as + or *, is applied to all elements in a loop
+// without involving the evaluator. Other functions are applied through
+// an application (f (quote x)) that is evaluated once per element with
+// x replaced, in the same way as in map.
+static void apply_array_map(lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
+  lbm_array_header_t *arr = NULL;
+  if (nargs != 2 || !(arr = lbm_dec_lisp_array_r(args[1]))) {
+    lbm_set_error_reason((char*)lbm_error_str_incorrect_arg);
+    ERROR_AT_CTX(ENC_SYM_TERROR, ENC_SYM_ARRAY_MAP);
+  }
+  lbm_uint n = arr->size / sizeof(lbm_value);
+  lbm_value *sptr = get_stack_ptr(ctx, 3);
+  lbm_value res = array_allocate_with_gc(n);
+  sptr[0] = res; // reuse stack space, keeps res safe from GC.
+  lbm_value f = args[0];
+  lbm_value *src = (lbm_value*)arr->data;
+
+  if (n == 0 || is_fundamental(f)) {
+    stack_reserve(ctx, 1)[0] = lbm_enc_u(0);
+    array_map_fundamental(ctx);
+    return;
+  }
+
+  lbm_value appli_1;
+  lbm_value appli;
+  WITH_GC(appli_1, lbm_heap_allocate_list(2));
+  WITH_GC_RMBR_1(appli, lbm_heap_allocate_list(2), appli_1);
+  lbm_set_car_and_cdr(get_cdr(appli_1), src[0], ENC_SYM_NIL);
+  lbm_set_car(appli_1, ENC_SYM_QUOTE);
+  lbm_set_car_and_cdr(get_cdr(appli), appli_1, ENC_SYM_NIL);
+  lbm_set_car(appli, f);
+
+  lbm_value *rptr = stack_reserve(ctx, 4);
+  rptr[0] = ctx->curr_env;
+  rptr[1] = lbm_enc_u(0);
+  rptr[2] = appli;
+  rptr[3] = ARRAY_MAP;
+  ctx->curr_exp = appli;
+}
+
+// (array-fold f init array)
+//
+// Computes (f (... (f (f init a0) a1) ...) aN). Fundamentals are
+// applied in a loop as in array-map, other functions through an
+// application (f (quote acc) (quote x)).
+static void apply_array_fold(lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
+  lbm_array_header_t *arr = NULL;
+  if (nargs != 3 || !(arr = lbm_dec_lisp_array_r(args[2]))) {
+    lbm_set_error_reason((char*)lbm_error_str_incorrect_arg);
+    ERROR_AT_CTX(ENC_SYM_TERROR, ENC_SYM_ARRAY_FOLD);
+  }
+  lbm_uint n = arr->size / sizeof(lbm_value);
+  lbm_value *sptr = get_stack_ptr(ctx, 4);
+  lbm_value f = args[0];
+  lbm_value *src = (lbm_value*)arr->data;
+
+  if (n == 0 || is_fundamental(f)) {
+    stack_reserve(ctx, 1)[0] = lbm_enc_u(0);
+    array_fold_fundamental(ctx);
+    return;
+  }
+
+  lbm_value appli;
+  lbm_value quote_acc;
+  lbm_value quote_x;
+  WITH_GC(appli, lbm_heap_allocate_list(3));
+  WITH_GC_RMBR_1(quote_acc, lbm_heap_allocate_list_init(2, ENC_SYM_QUOTE, sptr[2]), appli);
+  lbm_set_car(get_cdr(appli), quote_acc);
+  WITH_GC_RMBR_1(quote_x, lbm_heap_allocate_list_init(2, ENC_SYM_QUOTE, src[0]), appli);
+  lbm_set_car(get_cdr(get_cdr(appli)), quote_x);
+  lbm_set_car(appli, f);
+
+  lbm_value *rptr = stack_reserve(ctx, 4);
+  rptr[0] = ctx->curr_env;
+  rptr[1] = lbm_enc_u(0);
+  rptr[2] = appli;
+  rptr[3] = ARRAY_FOLD;
+  ctx->curr_exp = appli;
+}
+
+// sptr[0]: First cell of the result.
+// sptr[1]: Fundamental to test with.
+// sptr[2]: Remaining elements.
+// sptr[3]: Last cell of the result.
+static void filter_fundamental(eval_context_t *ctx) {
+  lbm_value *sptr = get_stack_ptr(ctx, 4);
+  lbm_value f = sptr[1];
+  lbm_value ls = sptr[2];
+  for (lbm_uint i = 0; i < FUNDAMENTAL_LOOP_CHUNK && lbm_is_cons(ls); i ++) {
+    lbm_value x = get_car(ls);
+    if (!lbm_is_symbol_nil(array_call_fundamental(f, &x, 1, ctx))) {
+      lbm_value cell = cons_with_gc(x, ENC_SYM_NIL, ENC_SYM_NIL);
+      if (lbm_is_symbol_nil(sptr[0])) sptr[0] = cell;
+      else lbm_set_cdr(sptr[3], cell);
+      sptr[3] = cell;
+    }
+    ls = get_cdr(ls);
+  }
+  ctx->app_cont = true;
+  if (lbm_is_cons(ls)) {
+    sptr[2] = ls;
+    stack_reserve(ctx, 1)[0] = FILTER_FUNDAMENTAL;
+    lbm_surrender_quota();
+    return;
+  }
+  ctx->r = sptr[0];
+  lbm_stack_drop(&ctx->K, 4);
+}
+
+// sptr[0]: t for foldr, nil for foldl.
+// sptr[1]: Fundamental to fold with.
+// sptr[2]: Accumulator.
+// sptr[3]: Remaining elements, reversed for foldr.
+static void fold_fundamental(eval_context_t *ctx) {
+  lbm_value *sptr = get_stack_ptr(ctx, 4);
+  bool right = !lbm_is_symbol_nil(sptr[0]);
+  lbm_value f = sptr[1];
+  lbm_value ls = sptr[3];
+  for (lbm_uint i = 0; i < FUNDAMENTAL_LOOP_CHUNK && lbm_is_cons(ls); i ++) {
+    lbm_value fargs[2];
+    fargs[right ? 1 : 0] = sptr[2];
+    fargs[right ? 0 : 1] = get_car(ls);
+    sptr[2] = array_call_fundamental(f, fargs, 2, ctx);
+    ls = get_cdr(ls);
+  }
+  ctx->app_cont = true;
+  if (lbm_is_cons(ls)) {
+    sptr[3] = ls;
+    stack_reserve(ctx, 1)[0] = FOLD_FUNDAMENTAL;
+    lbm_surrender_quota();
+    return;
+  }
+  ctx->r = sptr[2];
+  lbm_stack_drop(&ctx->K, 4);
+}
+
+// (filter f list)
+//
+// Keeps the elements for which f is non-nil. Fundamentals, such as
+// number?, are applied in a loop, other functions through an
+// application (f (quote x)) as in map.
+static void apply_filter(lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
+  if (nargs != 2 || !lbm_is_list(args[1])) {
+    lbm_set_error_reason((char*)lbm_error_str_incorrect_arg);
+    ERROR_AT_CTX(ENC_SYM_TERROR, ENC_SYM_FILTER);
+  }
+  lbm_value *sptr = get_stack_ptr(ctx, 3);
+  lbm_value f = args[0];
+  lbm_value ls = args[1];
+
+  if (lbm_is_symbol_nil(ls) || is_fundamental(f)) {
+    sptr[0] = ENC_SYM_NIL; // first cell of the result, reuse stack space
+    stack_reserve(ctx, 1)[0] = ENC_SYM_NIL; // last cell of the result
+    filter_fundamental(ctx);
+    return;
+  }
+
+  lbm_value appli;
+  WITH_GC(appli, lbm_heap_allocate_list_init(2, f,ENC_SYM_NIL));
+  lbm_value quote_x;
+  WITH_GC_RMBR_1(quote_x, lbm_heap_allocate_list_init(2, ENC_SYM_QUOTE, get_car(ls)), appli);
+  lbm_set_car(get_cdr(appli), quote_x);
+
+  sptr[0] = ENC_SYM_NIL; // f is kept alive by appli from here on.
+  sptr[1] = ENC_SYM_NIL;
+  lbm_value *rptr = stack_reserve(ctx, 3);
+  rptr[0] = ctx->curr_env;
+  rptr[1] = appli;
+  rptr[2] = FILTER;
+  ctx->curr_exp = appli;
+}
+
+// (foldl f init list) computes (f (... (f (f init x0) x1) ...) xN) and
+// (foldr f init list) computes (f x0 (f x1 (... (f xN init) ...))).
+// foldr runs over a reversed copy of the list so that both are
+// iterative.
+static void apply_fold(lbm_value *args, lbm_uint nargs, eval_context_t *ctx, bool right) {
+  if (nargs != 3 || !lbm_is_list(args[2])) {
+    lbm_set_error_reason((char*)lbm_error_str_incorrect_arg);
+    ERROR_AT_CTX(ENC_SYM_TERROR, right ? ENC_SYM_FOLDR : ENC_SYM_FOLDL);
+  }
+  lbm_value *sptr = get_stack_ptr(ctx, 4);
+  lbm_value f = args[0];
+  if (right) {
+    lbm_value rev;
+    WITH_GC(rev, lbm_list_reverse(sptr[3]));
+    sptr[3] = rev;
+  }
+  lbm_value ls = sptr[3];
+
+  if (lbm_is_symbol_nil(ls) || is_fundamental(f)) {
+    sptr[0] = right ? ENC_SYM_TRUE : ENC_SYM_NIL; // reuse stack space
+    fold_fundamental(ctx);
+    return;
+  }
+
+  lbm_value appli;
+  lbm_value quote_acc;
+  lbm_value quote_x;
+  WITH_GC(appli, lbm_heap_allocate_list(3));
+  WITH_GC_RMBR_1(quote_acc, lbm_heap_allocate_list_init(2, ENC_SYM_QUOTE, sptr[2]), appli);
+  lbm_set_car(right ? get_cdr(get_cdr(appli)) : get_cdr(appli), quote_acc);
+  WITH_GC_RMBR_1(quote_x, lbm_heap_allocate_list_init(2, ENC_SYM_QUOTE, get_car(ls)), appli);
+  lbm_set_car(right ? get_cdr(appli) : get_cdr(get_cdr(appli)), quote_x);
+  lbm_set_car(appli, f);
+
+  sptr[0] = quote_acc; // reuse stack space
+  sptr[1] = quote_x;
+  lbm_value *rptr = stack_reserve(ctx, 4);
+  rptr[0] = ctx->curr_env;
+  rptr[1] = get_cdr(ls);
+  rptr[2] = appli;
+  rptr[3] = FOLD;
+  ctx->curr_exp = appli;
+}
+
+static void apply_foldl(lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
+  apply_fold(args, nargs, ctx, false);
+}
+
+static void apply_foldr(lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
+  apply_fold(args, nargs, ctx, true);
+}
+
 static void apply_reverse(lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
   if (nargs == 1 && lbm_is_list(args[0])) {
     lbm_value curr = args[0];
@@ -3171,6 +3616,153 @@ static void apply_rotate(lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
   ERROR_CTX(ENC_SYM_EERROR);
 }
 
+/* Bind the parameters of a macro to the unevaluated arguments. */
+static lbm_value macro_expand_env(lbm_value params, lbm_value args, lbm_value env) {
+  lbm_value curr_param = params;
+  lbm_value curr_arg = args;
+  lbm_value expand_env = env;
+  while (lbm_is_cons(curr_param) &&
+         lbm_is_cons(curr_arg)) {
+    lbm_cons_t *param_cell = lbm_ref_cell(curr_param); // already checked that cons.
+    lbm_cons_t *arg_cell = lbm_ref_cell(curr_arg);
+    lbm_value car_curr_param = param_cell->car;
+    lbm_value cdr_curr_param = param_cell->cdr;
+    lbm_value car_curr_arg = arg_cell->car;
+    lbm_value cdr_curr_arg = arg_cell->cdr;
+
+    lbm_value entry = cons_with_gc(car_curr_param, car_curr_arg, expand_env);
+    lbm_value aug_env = cons_with_gc(entry, expand_env,ENC_SYM_NIL);
+    expand_env = aug_env;
+
+    curr_param = cdr_curr_param;
+    curr_arg   = cdr_curr_arg;
+  }
+  return expand_env;
+}
+
+/* How macroexpand_all treats an element of a list. A list that is
+ * walked element by element has one of the kinds MX_CLAUSES to
+ * MX_RECV_TO. Names in binding positions and patterns are kept. */
+#define MX_KEEP      0 // left as it is
+#define MX_EXPR      1 // an expression
+#define MX_CLAUSES   2 // (clause ...), the bindings of let and loop
+#define MX_CLAUSE    3 // (pattern body ...) or (name expr)
+#define MX_FORM      4 // (f arg ...)
+#define MX_LAMBDA    5 // (lambda params body)
+#define MX_DEFINE    6 // (define name expr)
+#define MX_LET       7 // (let bindings body)
+#define MX_MATCH     8 // (match expr clause ...)
+#define MX_RECV      9 // (recv clause ...)
+#define MX_RECV_TO  10 // (recv-to timeout clause ...)
+
+static lbm_uint mx_form_kind(lbm_value h) {
+  switch (lbm_is_symbol(h) ? lbm_dec_sym(h) : 0) {
+  case SYM_LAMBDA: /* fall through */
+  case SYM_MACRO:  /* fall through */
+  case SYM_CLOSURE:
+    return MX_LAMBDA;
+  case SYM_DEFINE: /* fall through */
+  case SYM_SETQ:   /* fall through */
+  case SYM_PROGN_VAR:
+    return MX_DEFINE;
+  case SYM_LET: /* fall through */
+  case SYM_LOOP:
+    return MX_LET;
+  case SYM_MATCH:
+    return MX_MATCH;
+  case SYM_RECEIVE:
+    return MX_RECV;
+  case SYM_RECEIVE_TIMEOUT:
+    return MX_RECV_TO;
+  default:
+    return MX_FORM;
+  }
+}
+
+// How to treat element idx of a list of the given kind.
+static lbm_uint mx_element(lbm_uint kind, lbm_uint idx) {
+  switch (kind) {
+  case MX_CLAUSES: return MX_CLAUSE;
+  case MX_CLAUSE:  return idx == 0 ? MX_KEEP : MX_EXPR;
+  case MX_LAMBDA:  /* fall through */
+  case MX_DEFINE:  return idx == 1 ? MX_KEEP : MX_EXPR;
+  case MX_LET:     return idx == 1 ? MX_CLAUSES : MX_EXPR;
+  case MX_MATCH:   /* fall through */
+  case MX_RECV_TO: return idx >= 2 ? MX_CLAUSE : MX_EXPR;
+  case MX_RECV:    return idx >= 1 ? MX_CLAUSE : MX_EXPR;
+  default:         return MX_EXPR;
+  }
+}
+
+/* Expand e, treated as given by how (one of MX_KEEP to MX_CLAUSE).
+ * The result is a copy of e that is left in ctx->r. A macro that is
+ * not yet defined but can be dynamically loaded is loaded first.
+ * Macro bodies are evaluated as usual, so this function may set up
+ * an evaluation and return before the expansion is complete.
+ */
+static void macroexpand(eval_context_t *ctx, lbm_value e, lbm_uint how) {
+  while (lbm_is_cons(e) && how != MX_KEEP) {
+    ctx->r = e; // e is kept alive through r while expanding.
+    lbm_uint kind = how;
+    if (how == MX_EXPR) {
+      lbm_value h = get_car(e);
+      if (h == ENC_SYM_QUOTE) break;
+      if (lbm_is_symbol(h) && lbm_dec_sym(h) >= RUNTIME_SYMBOLS_START) {
+        lbm_value m;
+        if (lbm_global_env_lookup(&m, h)) {
+          if (lbm_is_cons(m) && get_car(m) == ENC_SYM_MACRO) {
+            lbm_value expand_env = macro_expand_env(get_cadr(m), get_cdr(e), ENC_SYM_NIL);
+            stack_reserve(ctx, 1)[0] = MACROEXPAND_RESULT;
+            ctx->curr_exp = get_cadr(get_cdr(m));
+            ctx->curr_env = expand_env;
+            return;
+          }
+        } else {
+          const char *code_str = NULL;
+          if (dynamic_load_callback(lbm_get_name_by_symbol(lbm_dec_sym(h)), &code_str)) {
+            lbm_value *sptr = stack_reserve(ctx, 2);
+            sptr[0] = e;
+            sptr[1] = MACROEXPAND_RETRY;
+            ctx->curr_exp = h;
+            ctx->curr_env = ENC_SYM_NIL;
+            return;
+          }
+        }
+      }
+      kind = mx_form_kind(h);
+    }
+    lbm_value *sptr = stack_reserve(ctx, 6);
+    sptr[0] = ENC_SYM_NIL;       // first cell of the copy
+    sptr[1] = ENC_SYM_NIL;       // last cell of the copy
+    sptr[2] = e;                 // cell currently being expanded
+    sptr[3] = lbm_enc_u(kind);
+    sptr[4] = lbm_enc_u(0);      // index of that cell
+    sptr[5] = MACROEXPAND_LIST;
+    how = mx_element(kind, 0);
+    e = get_car(e);
+  }
+  ctx->r = e;
+  ctx->app_cont = true;
+}
+
+/* Expand all calls to global macros in e ahead of evaluation.
+ * Quoted data, parameter lists, the names bound by let, loop, var,
+ * define and setq and the patterns of match and recv are not expanded.
+ */
+static void macroexpand_all(eval_context_t *ctx, lbm_value e) {
+  macroexpand(ctx, e, MX_EXPR);
+}
+
+static void apply_macroexpand_all(lbm_value *args, lbm_uint nargs, eval_context_t *ctx) {
+  if (nargs != 1) {
+    lbm_set_error_reason((char*)lbm_error_str_num_args);
+    ERROR_AT_CTX(ENC_SYM_EERROR, ENC_SYM_MACROEXPAND_ALL);
+  }
+  lbm_value e = args[0];
+  lbm_stack_drop(&ctx->K, nargs+1);
+  macroexpand_all(ctx, e);
+}
+
 /***************************************************/
 /* Application lookup table                        */
 
@@ -3200,18 +3792,105 @@ static const apply_fun fun_table[] =
    apply_sort,
    apply_rest_args,
    apply_rotate,
+   apply_array_map,
+   apply_array_fold,
+   apply_macroexpand_all,
+   apply_filter,
+   apply_foldl,
+   apply_foldr,
   };
 
 /***************************************************/
 /* Application of function that takes arguments    */
 /* passed over the stack.                          */
 
+// Bind the evaluated arguments in fun_args[1..nargs] to the
+// parameters of the closure in fun_args[0] and evaluate its body.
+// Arguments in excess of the parameters are bound as a list to
+// rest-args. All cells needed are checked for up front so that the
+// bindings are made in one loop without GC.
+static void apply_closure(eval_context_t *ctx, lbm_value *fun_args, lbm_uint nargs) {
+  lbm_value cl[3];
+  extract_n(get_cdr(fun_args[0]), cl, 3);
+
+  lbm_uint nparams = 0;
+  lbm_value curr = cl[CLO_PARAMS];
+  while (lbm_is_cons(curr)) {
+    nparams ++;
+    curr = lbm_ref_cell(curr)->cdr;
+  }
+  if (nargs < nparams) {
+    lbm_set_error_reason((char*)lbm_error_str_num_args);
+    ERROR_AT_CTX(ENC_SYM_EERROR, fun_args[0]);
+  }
+  lbm_uint nrest = nargs - nparams;
+  lbm_uint need = 2 * nparams + (nrest ? 2 + nrest : 0);
+#ifdef LBM_ALWAYS_GC
+  gc();
+#endif
+  if (lbm_heap_num_free() < need) {
+    gc();
+    if (lbm_heap_num_free() < need) {
+      ERROR_CTX(ENC_SYM_MERROR);
+    }
+  }
+
+  // If num_free is calculated correctly, the freelist holds need cells.
+  lbm_cons_t *heap = lbm_heap_state.heap;
+  lbm_value fl = lbm_heap_state.freelist;
+  lbm_value env = cl[CLO_ENV];
+  lbm_value param = cl[CLO_PARAMS];
+  for (lbm_uint i = 1; i <= nparams; i ++) {
+    lbm_cons_t *param_cell = lbm_ref_cell(param);
+    lbm_uint binding_ix = lbm_dec_ptr(fl);
+    lbm_value list_cell = heap[binding_ix].cdr;
+    lbm_uint list_ix = lbm_dec_ptr(list_cell);
+    fl = heap[list_ix].cdr;
+    heap[binding_ix].car = param_cell->car;
+    heap[binding_ix].cdr = fun_args[i];
+    heap[list_ix].car = lbm_enc_cons_ptr(binding_ix);
+    heap[list_ix].cdr = env;
+    env = list_cell;
+    param = param_cell->cdr;
+  }
+  if (nrest) {
+    // env = ((rest-args . (a_n+1 ... a_nargs)) . env)
+    lbm_uint binding_ix = lbm_dec_ptr(fl);
+    lbm_value list_cell = heap[binding_ix].cdr;
+    lbm_uint list_ix = lbm_dec_ptr(list_cell);
+    lbm_value rest = heap[list_ix].cdr;
+    lbm_uint last_ix = 0;
+    for (lbm_uint i = nparams + 1; i <= nargs; i ++) {
+      last_ix = lbm_dec_ptr(i == nparams + 1 ? rest : heap[last_ix].cdr);
+      heap[last_ix].car = fun_args[i];
+    }
+    fl = heap[last_ix].cdr;
+    heap[last_ix].cdr = ENC_SYM_NIL;
+    heap[binding_ix].car = ENC_SYM_REST_ARGS;
+    heap[binding_ix].cdr = rest;
+    heap[list_ix].car = lbm_enc_cons_ptr(binding_ix);
+    heap[list_ix].cdr = env;
+    env = list_cell;
+  }
+  lbm_heap_state.freelist = fl;
+  lbm_heap_state.num_alloc += need;
+
+  lbm_stack_drop(&ctx->K, nargs + 1);
+  ctx->curr_exp = cl[CLO_BODY];
+  ctx->curr_env = env;
+}
+
 static void application(eval_context_t *ctx, lbm_value *fun_args, lbm_uint arg_count) {
-  /* If arriving here, we know that the fun is a symbol.
-   *  and can be a built in operation or an extension.
+  /* If arriving here, we know that the fun is a symbol
+   * (a built in operation or an extension) or a closure.
    */
   lbm_value fun = fun_args[0];
 
+  if (lbm_is_cons(fun)) {
+    apply_closure(ctx, fun_args, arg_count);
+    return;
+  }
+
   lbm_uint fun_val = lbm_dec_sym(fun);
   lbm_uint fun_kind = SYMBOL_KIND(fun_val);
 
@@ -3262,87 +3941,27 @@ static void application(eval_context_t *ctx, lbm_value *fun_args, lbm_uint arg_c
   }
 }
 
-static void cont_closure_application_args(eval_context_t *ctx) {
-  lbm_uint* sptr = get_stack_ptr(ctx, 5);
-
-  lbm_value arg_env = (lbm_value)sptr[0];
-  lbm_value exp     = (lbm_value)sptr[1];
-  lbm_value clo_env = (lbm_value)sptr[2];
-  lbm_value params  = (lbm_value)sptr[3];
-  lbm_value args    = (lbm_value)sptr[4];
-
-  lbm_value car_params, cdr_params;
-  get_car_and_cdr(params, &car_params, &cdr_params);
-
-  bool a_nil = lbm_is_symbol_nil(args);
-  bool p_nil = lbm_is_symbol_nil(cdr_params);
-
-  lbm_value binder = allocate_binding(car_params, ctx->r, clo_env);
-
-  if (!a_nil && !p_nil) {
-    lbm_value car_args, cdr_args;
-    get_car_and_cdr(args, &car_args, &cdr_args);
-    sptr[2] = binder;
-    sptr[3] = cdr_params;
-    sptr[4] = cdr_args;
-    stack_reserve(ctx,1)[0] = CLOSURE_ARGS;
-    ctx->curr_exp = car_args;
-    ctx->curr_env = arg_env;
-  } else if (a_nil && p_nil) {
-    // Arguments and parameters match up in number
-    lbm_stack_drop(&ctx->K, 5);
-    ctx->curr_env = binder;
-    ctx->curr_exp = exp;
-  } else if (p_nil) {
-    lbm_value rest_binder = allocate_binding(ENC_SYM_REST_ARGS, ENC_SYM_NIL, binder);
-    sptr[2] = rest_binder;
-    sptr[3] = get_cdr(args);
-    sptr[4] = get_car(rest_binder); // last element of rest_args so far
-    stack_reserve(ctx,1)[0] = CLOSURE_ARGS_REST;
-    ctx->curr_exp = get_car(args);
-    ctx->curr_env = arg_env;
-  }  else {
-    lbm_set_error_reason((char*)lbm_error_str_num_args);
-    ERROR_CTX(ENC_SYM_EERROR);
-  }
-}
-
-static void cont_closure_args_rest(eval_context_t *ctx) {
-  lbm_uint* sptr = get_stack_ptr(ctx, 5);
-  lbm_value arg_env = (lbm_value)sptr[0];
-  lbm_value exp     = (lbm_value)sptr[1];
-  lbm_value clo_env = (lbm_value)sptr[2];
-  lbm_value args    = (lbm_value)sptr[3];
-  lbm_value last    = (lbm_value)sptr[4];
-  lbm_cons_t* heap = lbm_heap_state.heap;
-#ifdef LBM_ALWAYS_GC
-  gc();
-#endif
-  lbm_value binding = lbm_heap_state.freelist;
-  if (binding == ENC_SYM_NIL) {
-    gc();
-    binding = lbm_heap_state.freelist;
-    if (binding == ENC_SYM_NIL) ERROR_CTX(ENC_SYM_MERROR);
-  }
-  lbm_uint binding_ix = lbm_dec_ptr(binding);
-  lbm_heap_state.freelist = heap[binding_ix].cdr;
-  lbm_heap_state.num_alloc += 1;
-  heap[binding_ix].car = ctx->r;
-  heap[binding_ix].cdr = ENC_SYM_NIL;
-
-  lbm_set_cdr(last, binding);
-  sptr[4] = binding;
-
-  if (args == ENC_SYM_NIL) {
-    lbm_stack_drop(&ctx->K, 5);
-    ctx->curr_env = clo_env;
-    ctx->curr_exp = exp;
-  } else {
-    stack_reserve(ctx,1)[0] = CLOSURE_ARGS_REST;
-    sptr[3] = get_cdr(args);  
-    ctx->curr_exp = get_car(args);
-    ctx->curr_env = arg_env;
+// Evaluate e directly if it is a constant, a quote or a bound
+// variable. Returns false if e needs the evaluator.
+static inline bool eval_trivial(lbm_value e, lbm_value env, lbm_value *res) {
+  if (lbm_is_symbol(e)) {
+    if (lbm_dec_sym(e) < RUNTIME_SYMBOLS_START) {
+      *res = e;
+      return true;
+    }
+    return (lbm_env_lookup_b(res, e, env) ||
+            lbm_global_env_lookup(res, e));
+  }
+  if (lbm_is_cons(e)) {
+    lbm_cons_t *cell = lbm_ref_cell(e);
+    if (cell->car == ENC_SYM_QUOTE) {
+      *res = get_car(cell->cdr);
+      return true;
+    }
+    return false;
   }
+  *res = e;
+  return true;
 }
 
 static void cont_application_args(eval_context_t *ctx) {
@@ -3354,6 +3973,20 @@ static void cont_application_args(eval_context_t *ctx) {
 
   ctx->curr_env = env;
   sptr[0] = ctx->r; // Function 1st then Arguments
+
+  // Push arguments that need no evaluation without a round through
+  // the evaluator.
+  lbm_value v;
+  while (lbm_is_cons(rest) &&
+         eval_trivial(lbm_ref_cell(rest)->car, env, &v)) {
+    stack_reserve(ctx, 1);
+    sptr ++;
+    sptr[0] = v;
+    count += (1 << LBM_VAL_SHIFT);
+    rest = lbm_ref_cell(rest)->cdr;
+    ctx->r = v; // As if v had been through the evaluator.
+  }
+
   if (lbm_is_cons(rest)) {
     lbm_cons_t *cell = lbm_ref_cell(rest);
     sptr[1] = env;
@@ -3472,6 +4105,9 @@ static void cont_if(eval_context_t *ctx) {
   }
 }
 
+// Clauses are tried in a loop with match_test and only the clause that
+// matches has its bindings allocated. The evaluator is only reentered
+// to run a guard or the body.
 static void cont_match(eval_context_t *ctx) {
   lbm_value e = ctx->r;
 
@@ -3480,14 +4116,13 @@ static void cont_match(eval_context_t *ctx) {
   lbm_value orig_env = (lbm_value)sptr[1]; // restore enclosing environment.
   lbm_value new_env = orig_env;
 
-  if (lbm_is_symbol_nil(patterns)) {
-    // no more patterns
-    lbm_stack_drop(&ctx->K, 2);
-    ctx->r = ENC_SYM_NO_MATCH;
-    ctx->app_cont = true;
-  } else if (lbm_is_cons(patterns)) {
+  while (lbm_is_cons(patterns)) {
     lbm_value match_case = get_car(patterns);
     lbm_value pattern = get_car(match_case);
+    if (!match_test(pattern, e)) {
+      patterns = get_cdr(patterns);
+      continue;
+    }
     lbm_value n1      = get_cadr(match_case);
     lbm_value n2      = get_cdr(get_cdr(match_case));
     lbm_value body;
@@ -3498,32 +4133,31 @@ static void cont_match(eval_context_t *ctx) {
       body = get_car(n2);
       check_guard = true;
     }
-    bool is_match = match(pattern, e, &new_env);
-    if (is_match) {
-      if (check_guard) {
-        lbm_value *rptr = stack_reserve(ctx,5);
-        sptr[0] = get_cdr(patterns);
-        sptr[1] = ctx->curr_env;
-        rptr[0] = MATCH;
-        rptr[1] = new_env;
-        rptr[2] = body;
-        rptr[3] = e;
-        rptr[4] = MATCH_GUARD;
-        ctx->curr_env = new_env;
-        ctx->curr_exp = n1; // The guard
-      } else {
-        lbm_stack_drop(&ctx->K, 2);
-        ctx->curr_env = new_env;
-        ctx->curr_exp = body;
-      }
-    } else {
-      // set up for checking of next pattern
+    // patterns is reachable from sptr[0] while match allocates.
+    match(pattern, e, &new_env);
+    if (check_guard) {
+      lbm_value *rptr = stack_reserve(ctx,5);
       sptr[0] = get_cdr(patterns);
-      sptr[1] = orig_env;
-      stack_reserve(ctx,1)[0] = MATCH;
-      // leave r unaltered
-      ctx->app_cont = true;
+      sptr[1] = ctx->curr_env;
+      rptr[0] = MATCH;
+      rptr[1] = new_env;
+      rptr[2] = body;
+      rptr[3] = e;
+      rptr[4] = MATCH_GUARD;
+      ctx->curr_env = new_env;
+      ctx->curr_exp = n1; // The guard
+    } else {
+      lbm_stack_drop(&ctx->K, 2);
+      ctx->curr_env = new_env;
+      ctx->curr_exp = body;
     }
+    return;
+  }
+  if (lbm_is_symbol_nil(patterns)) {
+    // no more patterns
+    lbm_stack_drop(&ctx->K, 2);
+    ctx->r = ENC_SYM_NO_MATCH;
+    ctx->app_cont = true;
   } else {
     ERROR_AT_CTX(ENC_SYM_TERROR, ENC_SYM_MATCH);
   }
@@ -3571,6 +4205,142 @@ static void cont_map(eval_context_t *ctx) {
   }
 }
 
+// cont_array_map:
+//
+// sptr[0]: Result array.
+// sptr[1]: Function.
+// sptr[2]: Input array.
+// sptr[3]: Environment to restore for the eval of each application.
+// sptr[4]: Index of the element that was just mapped.
+// sptr[5]: Application (f (quote x)).
+//
+// ctx->r  = eval result of previous application.
+static void cont_array_map(eval_context_t *ctx) {
+  lbm_value *sptr = get_stack_ptr(ctx, 6);
+  lbm_uint i = lbm_dec_u(sptr[4]);
+  lbm_array_header_t *res = assume_array(sptr[0]);
+  lbm_array_header_t *arr = assume_array(sptr[2]);
+  ((lbm_value*)res->data)[i] = ctx->r;
+  i ++;
+  ctx->curr_env = sptr[3];
+  // f may have resized the input with vec-push or vec-pop, the result
+  // keeps the length the input had when the map started.
+  if (i < res->size / sizeof(lbm_value) &&
+      i < arr->size / sizeof(lbm_value)) {
+    sptr[4] = lbm_enc_u(i);
+    lbm_set_car(get_cdr(get_cadr(sptr[5])), ((lbm_value*)arr->data)[i]);
+    stack_reserve(ctx,1)[0] = ARRAY_MAP;
+    ctx->curr_exp = sptr[5];
+  } else {
+    ctx->r = sptr[0];
+    lbm_stack_drop(&ctx->K, 6);
+    ctx->app_cont = true;
+  }
+}
+
+// cont_array_fold:
+//
+// sptr[0]: Unused.
+// sptr[1]: Function.
+// sptr[2]: Initial value.
+// sptr[3]: Input array.
+// sptr[4]: Environment to restore for the eval of each application.
+// sptr[5]: Index of the element that was just folded.
+// sptr[6]: Application (f (quote acc) (quote x)).
+//
+// ctx->r  = accumulator from previous application.
+static void cont_array_fold(eval_context_t *ctx) {
+  lbm_value *sptr = get_stack_ptr(ctx, 7);
+  lbm_uint i = lbm_dec_u(sptr[5]) + 1;
+  lbm_array_header_t *arr = assume_array(sptr[3]);
+  ctx->curr_env = sptr[4];
+  if (i < arr->size / sizeof(lbm_value)) {
+    lbm_value args = get_cdr(sptr[6]);
+    sptr[5] = lbm_enc_u(i);
+    lbm_set_car(get_cdr(get_car(args)), ctx->r);
+    lbm_set_car(get_cdr(get_cadr(args)), ((lbm_value*)arr->data)[i]);
+    stack_reserve(ctx,1)[0] = ARRAY_FOLD;
+    ctx->curr_exp = sptr[6];
+  } else {
+    lbm_stack_drop(&ctx->K, 7);
+    ctx->app_cont = true;
+  }
+}
+
+// cont_filter:
+//
+// sptr[0]: First cell of the result.
+// sptr[1]: Last cell of the result.
+// sptr[2]: List cell holding the element that was just tested.
+// sptr[3]: Environment to restore for the eval of each application.
+// sptr[4]: Application (f (quote x)).
+//
+// ctx->r  = result of testing the element.
+static void cont_filter(eval_context_t *ctx) {
+  lbm_value *sptr = get_stack_ptr(ctx, 5);
+  if (!lbm_is_symbol_nil(ctx->r)) {
+    lbm_value cell = cons_with_gc(get_car(sptr[2]), ENC_SYM_NIL, ENC_SYM_NIL);
+    if (lbm_is_symbol_nil(sptr[0])) sptr[0] = cell;
+    else lbm_set_cdr(sptr[1], cell);
+    sptr[1] = cell;
+  }
+  lbm_value rest = get_cdr(sptr[2]);
+  ctx->curr_env = sptr[3];
+  if (lbm_is_cons(rest)) {
+    sptr[2] = rest;
+    lbm_set_car(get_cdr(get_cadr(sptr[4])), get_car(rest));
+    stack_reserve(ctx,1)[0] = FILTER;
+    ctx->curr_exp = sptr[4];
+  } else {
+    ctx->r = sptr[0];
+    lbm_stack_drop(&ctx->K, 5);
+    ctx->app_cont = true;
+  }
+}
+
+// cont_fold:
+//
+// sptr[0]: (quote acc) in the application.
+// sptr[1]: (quote x) in the application.
+// sptr[2]: Initial value.
+// sptr[3]: Input list, reversed for foldr.
+// sptr[4]: Environment to restore for the eval of each application.
+// sptr[5]: Remaining elements.
+// sptr[6]: Application (f (quote acc) (quote x)) or (f (quote x) (quote acc)).
+//
+// ctx->r  = accumulator from previous application.
+static void cont_fold(eval_context_t *ctx) {
+  lbm_value *sptr = get_stack_ptr(ctx, 7);
+  lbm_value rest = sptr[5];
+  ctx->curr_env = sptr[4];
+  if (lbm_is_cons(rest)) {
+    sptr[5] = get_cdr(rest);
+    lbm_set_car(get_cdr(sptr[0]), ctx->r);
+    lbm_set_car(get_cdr(sptr[1]), get_car(rest));
+    stack_reserve(ctx,1)[0] = FOLD;
+    ctx->curr_exp = sptr[6];
+  } else {
+    lbm_stack_drop(&ctx->K, 7);
+    ctx->app_cont = true;
+  }
+}
+
+static void cont_filter_fundamental(eval_context_t *ctx) {
+  filter_fundamental(ctx);
+}
+
+static void cont_fold_fundamental(eval_context_t *ctx) {
+  fold_fundamental(ctx);
+}
+
+static void cont_array_map_fundamental(eval_context_t *ctx) {
+  array_map_fundamental(ctx);
+}
+
+static void cont_array_fold_fundamental(eval_context_t *ctx) {
+  array_fold_fundamental(ctx);
+}
+
 static void cont_match_guard(eval_context_t *ctx) {
   if (lbm_is_symbol_nil(ctx->r)) {
     lbm_value e;
@@ -4512,7 +5282,14 @@ static void cont_read_eval_continue(eval_context_t *ctx) {
     rptr[5] = POP_READER_FLAGS;
 
     ctx->curr_env = env;
-    ctx->curr_exp = ctx->r;
+    if (macro_expand_on_load) {
+      lbm_value *eptr = stack_reserve(ctx, 2);
+      eptr[0] = env;
+      eptr[1] = EVAL_R;
+      macroexpand_all(ctx, ctx->r);
+    } else {
+      ctx->curr_exp = ctx->r;
+    }
   } else {
     ERROR_CTX(ENC_SYM_FATAL_ERROR);
   }
@@ -4619,51 +5396,34 @@ static void cont_wrap_result(eval_context_t *ctx) {
 static void cont_application_start(eval_context_t *ctx) {
 
   /* sptr[0] = env
-   * sptr[1] = args
+   * sptr[1] = application (fun . args)
    * ctx->r  = function
    */
 
   if (lbm_is_symbol(ctx->r)) {
+    lbm_uint *sptr = get_stack_ptr(ctx, 2);
+    sptr[1] = get_cdr(sptr[1]);
     stack_reserve(ctx,1)[0] = lbm_enc_u(0);
     cont_application_args(ctx);
   } else if (lbm_is_cons(ctx->r)) {
     lbm_uint *sptr = get_stack_ptr(ctx, 2);
-    lbm_value args = (lbm_value)sptr[1];
+    lbm_value args = get_cdr(sptr[1]);
     switch (get_car(ctx->r)) {
     case ENC_SYM_CLOSURE: {
-      lbm_value cl[3];
-      extract_n(get_cdr(ctx->r), cl, 3);
-      lbm_value arg_env = (lbm_value)sptr[0];
-      lbm_value arg0, arg_rest;
-      get_car_and_cdr(args, &arg0, &arg_rest);
-      sptr[1] = cl[CLO_BODY];
-      bool a_nil = lbm_is_symbol_nil(args);
-      bool p_nil = lbm_is_symbol_nil(cl[CLO_PARAMS]);
-      lbm_value *reserved = stack_reserve(ctx, 4);
-
-      if (!a_nil && !p_nil) {
-        reserved[0] = cl[CLO_ENV];
-        reserved[1] = cl[CLO_PARAMS];
-        reserved[2] = arg_rest;
-        reserved[3] = CLOSURE_ARGS;
-        ctx->curr_exp = arg0;
-        ctx->curr_env = arg_env;
-      } else if (a_nil && p_nil) {
+      if (lbm_is_symbol_nil(args) &&
+          lbm_is_symbol_nil(get_cadr(ctx->r))) {
         // No params, No args
-        lbm_stack_drop(&ctx->K, 6);
+        lbm_value cl[3];
+        extract_n(get_cdr(ctx->r), cl, 3);
+        lbm_stack_drop(&ctx->K, 2);
         ctx->curr_exp = cl[CLO_BODY];
         ctx->curr_env = cl[CLO_ENV];
-      } else if (p_nil) {
-        reserved[1] = get_cdr(args);      // protect cdr(args) from allocate_binding
-        ctx->curr_exp = get_car(args);    // protect car(args) from allocate binding
-        ctx->curr_env = arg_env;
-        lbm_value rest_binder = allocate_binding(ENC_SYM_REST_ARGS, ENC_SYM_NIL, cl[CLO_ENV]);
-        reserved[0] = rest_binder;
-        reserved[2] = get_car(rest_binder);
-        reserved[3] = CLOSURE_ARGS_REST;
       } else {
-        lbm_set_error_reason((char*)lbm_error_str_num_args);
-        ERROR_AT_CTX(ENC_SYM_EERROR, ctx->r);
+        // Arguments are evaluated onto the stack and bound all at
+        // once by apply_closure.
+        sptr[1] = args;
+        stack_reserve(ctx,1)[0] = lbm_enc_u(0);
+        cont_application_args(ctx);
       }
     } break;
     case ENC_SYM_CONT:{
@@ -4698,6 +5458,23 @@ static void cont_application_start(eval_context_t *ctx) {
       lbm_value atomic;
       lbm_pop(&ctx->K, &atomic);
       is_atomic = atomic ? 1 : 0;
+      // Relink to the innermost trap frame of the restored stack.
+      ctx->trap_sp = 0;
+      ctx->flags &= ~EVAL_CPS_CONTEXT_FLAG_TRAP_UNROLL_RETURN;
+      for (lbm_uint i = ctx->K.sp; i > 0; i --) {
+        if (ctx->K.data[i-1] == EXCEPTION_HANDLER) {
+          ctx->trap_sp = i;
+          ctx->flags |= EVAL_CPS_CONTEXT_FLAG_TRAP_UNROLL_RETURN;
+          break;
+        }
+      }
+      // The restored stack may be inside an eval of data.
+      for (lbm_uint i = 0; i < ctx->K.sp; i ++) {
+        if (ctx->K.data[i] == EVAL_DATA_DONE) {
+          ctx->flags |= EVAL_CPS_CONTEXT_FLAG_EVAL_DATA;
+          break;
+        }
+      }
 
       ctx->curr_exp = arg;
     } break;
@@ -4728,6 +5505,12 @@ static void cont_application_start(eval_context_t *ctx) {
       }
       if (sp > 0 && sp <= ctx->K.sp && IS_CONTINUATION(ctx->K.data[sp-1])) {
               is_atomic = atomic ? 1 : 0; // works fine with nil/true
+              // Unlink trap frames that are dropped by the jump and
+              // restore the flags saved by the outermost of them.
+              while (ctx->trap_sp > sp) {
+                ctx->flags = (uint32_t)ctx->K.data[ctx->trap_sp - 3];
+                ctx->trap_sp = lbm_dec_u(ctx->K.data[ctx->trap_sp - 2]);
+              }
               ctx->K.sp = sp;
               ctx->curr_exp = arg;
               return;
@@ -4743,31 +5526,13 @@ static void cont_application_start(eval_context_t *ctx) {
        * as arguments.
        */
       lbm_value env = (lbm_value)sptr[0];
-
-      lbm_value curr_param = get_cadr(ctx->r);
-      lbm_value curr_arg = args;
-      lbm_value expand_env = env;
-      while (lbm_is_cons(curr_param) &&
-             lbm_is_cons(curr_arg)) {
-        lbm_cons_t *param_cell = lbm_ref_cell(curr_param); // already checked that cons.
-        lbm_cons_t *arg_cell = lbm_ref_cell(curr_arg);
-        lbm_value car_curr_param = param_cell->car;
-        lbm_value cdr_curr_param = param_cell->cdr;
-        lbm_value car_curr_arg = arg_cell->car;
-        lbm_value cdr_curr_arg = arg_cell->cdr;
-
-        lbm_value entry = cons_with_gc(car_curr_param, car_curr_arg, expand_env);
-        lbm_value aug_env = cons_with_gc(entry, expand_env,ENC_SYM_NIL);
-        expand_env = aug_env;
-
-        curr_param = cdr_curr_param;
-        curr_arg   = cdr_curr_arg;
-      }
+      lbm_value expand_env = macro_expand_env(get_cadr(ctx->r), args, env);
       /* Two rounds of evaluation is performed.
        * First to instantiate the arguments into the macro body.
        * Second to evaluate the resulting program.
+       * sptr[1] keeps the application for cont_macro_expanded.
        */
-      sptr[1] = EVAL_R;
+      stack_reserve(ctx, 1)[0] = MACRO_EXPANDED;
       lbm_value exp = get_cadr(get_cdr(ctx->r));
       ctx->curr_exp = exp;
       ctx->curr_env = expand_env;
@@ -4780,6 +5545,11 @@ static void cont_application_start(eval_context_t *ctx) {
   }
 }
 
+static void cont_eval_data_done(eval_context_t *ctx) {
+  ctx->flags &= ~EVAL_CPS_CONTEXT_FLAG_EVAL_DATA;
+  ctx->app_cont = true;
+}
+
 static void cont_eval_r(eval_context_t* ctx) {
   lbm_value env;
   lbm_pop(&ctx->K, &env);
@@ -4787,6 +5557,74 @@ static void cont_eval_r(eval_context_t* ctx) {
   ctx->curr_env = env;
 }
 
+// Macro expansion is memoized per call site. The application
+// (macro . args) is overwritten by its expansion so that later
+// evaluations of the same code do not expand the macro again.
+// An expansion that is not a list is stored as (progn expansion).
+// Code in constant memory cannot be updated and is expanded each time
+// it is evaluated. Data passed to eval or eval-program is left as it
+// is. As with expansion at load, the expansion is kept, so redefining
+// a macro or changing globals it depends on does not affect code that
+// has already been evaluated.
+static void cont_macro_expanded(eval_context_t *ctx) {
+  lbm_value app;
+  lbm_value env;
+  lbm_pop_2(&ctx->K, &app, &env);
+  lbm_value exp = ctx->r;
+  if (lbm_is_cons_rw(app) &&
+      !(ctx->flags & EVAL_CPS_CONTEXT_FLAG_EVAL_DATA)) {
+    if (lbm_is_cons(exp)) {
+      lbm_cons_t *cell = lbm_ref_cell(exp);
+      lbm_set_car_and_cdr(app, cell->car, cell->cdr);
+    } else {
+      lbm_value rest = lbm_cons(exp, ENC_SYM_NIL);
+      if (lbm_is_cons(rest)) {
+        lbm_set_car_and_cdr(app, ENC_SYM_PROGN, rest);
+      }
+    }
+  }
+  ctx->curr_exp = exp;
+  ctx->curr_env = env;
+}
+
+static void cont_macroexpand_list(eval_context_t *ctx) {
+  lbm_value *sptr = get_stack_ptr(ctx, 5);
+  lbm_value cell = cons_with_gc(ctx->r, ENC_SYM_NIL, ENC_SYM_NIL);
+  if (lbm_is_symbol_nil(sptr[0])) {
+    sptr[0] = cell;
+  } else {
+    lbm_set_cdr(sptr[1], cell);
+  }
+  sptr[1] = cell;
+  lbm_value rest = get_cdr(sptr[2]);
+  if (lbm_is_cons(rest)) {
+    lbm_uint idx = lbm_dec_u(sptr[4]) + 1;
+    sptr[2] = rest;
+    sptr[4] = lbm_enc_u(idx);
+    stack_reserve(ctx, 1)[0] = MACROEXPAND_LIST;
+    macroexpand(ctx, get_car(rest), mx_element(lbm_dec_u(sptr[3]), idx));
+  } else {
+    if (!lbm_is_symbol_nil(rest)) {
+      lbm_set_cdr(cell, rest);
+    }
+    ctx->r = sptr[0];
+    lbm_stack_drop(&ctx->K, 5);
+    ctx->app_cont = true;
+  }
+}
+
+// The expansion may itself contain macro calls.
+static void cont_macroexpand_result(eval_context_t *ctx) {
+  macroexpand_all(ctx, ctx->r);
+}
+
+// The head of the expression has been dynamically loaded.
+static void cont_macroexpand_retry(eval_context_t *ctx) {
+  lbm_value e;
+  lbm_pop(&ctx->K, &e);
+  macroexpand_all(ctx, e);
+}
+
 static void cont_progn_var(eval_context_t* ctx) {
 
   lbm_value key;
@@ -4915,7 +5753,10 @@ static void cont_move_val_to_flash_dispatch(eval_context_t *ctx) {
         ERROR_CTX(ENC_SYM_FATAL_ERROR);
 #endif
       } break;
+      case ENC_SYM_VECTOR_TYPE: /* fall through */
+      case ENC_SYM_PERSISTENT_TYPE: /* fall through */
       case ENC_SYM_LISPARRAY_TYPE: {
+        // A vector is stored in flash as a lisp array without spare capacity.
         lbm_array_header_t *arr = (lbm_array_header_t*)ref->car;
         lbm_uint size = arr->size / sizeof(lbm_uint);
         lbm_uint flash_addr = 0;
@@ -4938,7 +5779,9 @@ static void cont_move_val_to_flash_dispatch(eval_context_t *ctx) {
         ctx->app_cont = true;
         return;
       }
+      case ENC_SYM_ARRAY_VIEW_TYPE: /* fall through */
       case ENC_SYM_ARRAY_TYPE: {
+        // A view is stored in flash as a copy of the data it refers to.
         lbm_array_header_t *arr = (lbm_array_header_t*)ref->car;
         // arbitrary address: flash_arr.
         lbm_uint flash_arr = 0;
@@ -5259,9 +6102,10 @@ static void cont_pop_reader_flags(eval_context_t *ctx) {
 }
 
 static void cont_exception_handler(eval_context_t *ctx) {
-  lbm_value *sptr = pop_stack_ptr(ctx, 2);
+  lbm_value *sptr = pop_stack_ptr(ctx, 3);
   lbm_value retval = sptr[0];
   lbm_value flags = sptr[1];
+  ctx->trap_sp = lbm_dec_u(sptr[2]);
   lbm_set_car(get_cdr(retval), ctx->r);
   ctx->flags = (uint32_t)flags;
   ctx->r = retval;
@@ -5354,7 +6198,6 @@ static const cont_fun continuations[NUM_CONTINUATIONS] =
     cont_application_start,
     cont_eval_r,
     cont_resume,
-    cont_closure_application_args,
     cont_exit_atomic,
     cont_read_next_token,
     cont_read_append_continue,
@@ -5383,7 +6226,6 @@ static const cont_fun continuations[NUM_CONTINUATIONS] =
     cont_loop_condition,
     cont_merge_rest,
     cont_merge_layer,
-    cont_closure_args_rest,
     cont_move_array_elts_to_flash,
     cont_pop_reader_flags,
     cont_exception_handler,
@@ -5391,7 +6233,20 @@ static const cont_fun continuations[NUM_CONTINUATIONS] =
     cont_wrap_result,
     cont_recv_to_retry,
     cont_read_start_array,
-    cont_read_append_array
+    cont_read_append_array,
+    cont_array_map,
+    cont_array_fold,
+    cont_macro_expanded,
+    cont_macroexpand_list,
+    cont_macroexpand_result,
+    cont_macroexpand_retry,
+    cont_filter,
+    cont_fold,
+    cont_filter_fundamental,
+    cont_fold_fundamental,
+    cont_array_map_fundamental,
+    cont_array_fold_fundamental,
+    cont_eval_data_done
   };
 
 /*********************************************************/
@@ -5425,6 +6280,7 @@ static const evaluator_fun evaluators[] =
    eval_trap,
    eval_call_cc_unsafe,
    eval_selfevaluating, // cont_sp
+   eval_call_cc_copy,
   };
 
 
@@ -5470,7 +6326,7 @@ static void evaluation_step(void){
      */
     lbm_value *reserved = stack_reserve(ctx, 3);
     reserved[0] = ctx->curr_env; // INFER: stack_reserve aborts context if error.
-    reserved[1] = cell->cdr;
+    reserved[1] = ctx->curr_exp;
     reserved[2] = APPLICATION_START;
     ctx->curr_exp = h; // evaluate the function
     return;
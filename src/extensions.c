@@ -26,10 +26,10 @@
 #include "extensions.h"
 #include "lbm_utils.h"
 
-static lbm_uint ext_max    = 0;
-static lbm_uint next_extension_ix = 0;
+static LBM_INSTANCE_LOCAL lbm_uint ext_max    = 0;
+static LBM_INSTANCE_LOCAL lbm_uint next_extension_ix = 0;
 
-lbm_extension_t *extension_table = NULL;
+LBM_INSTANCE_LOCAL lbm_extension_t *extension_table = NULL;
 
 void lbm_extensions_set_next(lbm_uint i) {
   next_extension_ix = i;
@@ -21,11 +21,21 @@
 #include "extensions.h"
 #include "symrepr.h"
 #include "lbm_memory.h"
+#include "lbm_custom_type.h"
 
 #include <math.h>
 
-static lbm_uint little_endian = 0;
-static lbm_uint big_endian = 0;
+static LBM_INSTANCE_LOCAL lbm_uint little_endian = 0;
+static LBM_INSTANCE_LOCAL lbm_uint big_endian = 0;
+
+static LBM_INSTANCE_LOCAL lbm_uint sym_i8  = 0;
+static LBM_INSTANCE_LOCAL lbm_uint sym_u8  = 0;
+static LBM_INSTANCE_LOCAL lbm_uint sym_i16 = 0;
+static LBM_INSTANCE_LOCAL lbm_uint sym_u16 = 0;
+static LBM_INSTANCE_LOCAL lbm_uint sym_u24 = 0;
+static LBM_INSTANCE_LOCAL lbm_uint sym_i32 = 0;
+static LBM_INSTANCE_LOCAL lbm_uint sym_u32 = 0;
+static LBM_INSTANCE_LOCAL lbm_uint sym_f32 = 0;
 
 static lbm_value array_extension_unsafe_free_array(lbm_value *args, lbm_uint argn);
 static lbm_value array_extension_buffer_append_i8(lbm_value *args, lbm_uint argn);
@@ -51,12 +61,38 @@ static lbm_value array_extension_buffer_length(lbm_value *args, lbm_uint argn);
 static lbm_value array_extensions_bufclear(lbm_value *args, lbm_uint argn);
 static lbm_value array_extensions_bufcpy(lbm_value *args, lbm_uint argn);
 static lbm_value array_extensions_bufset_bit(lbm_value *args, lbm_uint argn);
+static lbm_value array_extensions_bufget_many(lbm_value *args, lbm_uint argn);
+static lbm_value array_extensions_bufset_many(lbm_value *args, lbm_uint argn);
+
+static lbm_value array_extensions_codec_compile(lbm_value *args, lbm_uint argn);
+static lbm_value array_extensions_codec_size(lbm_value *args, lbm_uint argn);
+static lbm_value array_extensions_codec_decode(lbm_value *args, lbm_uint argn);
+static lbm_value array_extensions_codec_unpack(lbm_value *args, lbm_uint argn);
+static lbm_value array_extensions_codec_encode(lbm_value *args, lbm_uint argn);
+
+static lbm_value array_extensions_vec_push(lbm_value *args, lbm_uint argn);
+static lbm_value array_extensions_vec_pop(lbm_value *args, lbm_uint argn);
+static lbm_value array_extensions_vec_insert(lbm_value *args, lbm_uint argn);
+static lbm_value array_extensions_vec_capacity(lbm_value *args, lbm_uint argn);
+
+static lbm_value array_extensions_array_slice(lbm_value *args, lbm_uint argn);
+static lbm_value array_extensions_array_fill(lbm_value *args, lbm_uint argn);
+static lbm_value array_extensions_array_copy(lbm_value *args, lbm_uint argn);
 
 void lbm_array_extensions_init(void) {
 
   lbm_add_symbol_const("little-endian", &little_endian);
   lbm_add_symbol_const("big-endian", &big_endian);
 
+  lbm_add_symbol_const("i8", &sym_i8);
+  lbm_add_symbol_const("u8", &sym_u8);
+  lbm_add_symbol_const("i16", &sym_i16);
+  lbm_add_symbol_const("u16", &sym_u16);
+  lbm_add_symbol_const("u24", &sym_u24);
+  lbm_add_symbol_const("i32", &sym_i32);
+  lbm_add_symbol_const("u32", &sym_u32);
+  lbm_add_symbol_const("f32", &sym_f32);
+
   lbm_add_extension("free", array_extension_unsafe_free_array);
   lbm_add_extension("bufset-i8", array_extension_buffer_append_i8);
   lbm_add_extension("bufset-i16", array_extension_buffer_append_i16);
@@ -80,6 +116,23 @@ void lbm_array_extensions_init(void) {
   lbm_add_extension("bufclear", array_extensions_bufclear);
   lbm_add_extension("bufcpy", array_extensions_bufcpy);
   lbm_add_extension("bufset-bit", array_extensions_bufset_bit);
+  lbm_add_extension("bufget-many", array_extensions_bufget_many);
+  lbm_add_extension("bufset-many", array_extensions_bufset_many);
+
+  lbm_add_extension("codec-compile", array_extensions_codec_compile);
+  lbm_add_extension("codec-size", array_extensions_codec_size);
+  lbm_add_extension("codec-decode", array_extensions_codec_decode);
+  lbm_add_extension("codec-unpack", array_extensions_codec_unpack);
+  lbm_add_extension("codec-encode", array_extensions_codec_encode);
+
+  lbm_add_extension("vec-push", array_extensions_vec_push);
+  lbm_add_extension("vec-pop", array_extensions_vec_pop);
+  lbm_add_extension("vec-insert", array_extensions_vec_insert);
+  lbm_add_extension("vec-capacity", array_extensions_vec_capacity);
+
+  lbm_add_extension("array-slice", array_extensions_array_slice);
+  lbm_add_extension("array-fill!", array_extensions_array_fill);
+  lbm_add_extension("array-copy!", array_extensions_array_copy);
 }
 
 lbm_value array_extension_unsafe_free_array(lbm_value *args, lbm_uint argn) {
@@ -682,3 +735,617 @@ static lbm_value array_extensions_bufset_bit(lbm_value *args, lbm_uint argn) {
   }
   return res;
 }
+
+// Bulk access
+//
+// A layout is a list or lisp array of field descriptions. A field is
+// either a type symbol, placed directly after the previous field, or a
+// pair (type . offset) with an offset relative to the start index.
+// The type symbols are i8, u8, i16, u16, u24, i32, u32 and f32.
+
+typedef struct {
+  lbm_value curr;
+  lbm_value *data;
+  lbm_uint ix;
+  lbm_uint n;
+} seq_iter_t;
+
+static bool seq_iter_init(seq_iter_t *it, lbm_value seq) {
+  it->ix = 0;
+  it->data = NULL;
+  it->curr = seq;
+  if (lbm_is_list(seq)) {
+    it->n = lbm_list_length(seq);
+    return true;
+  }
+  lbm_array_header_t *arr = lbm_dec_lisp_array_r(seq);
+  if (arr) {
+    it->data = (lbm_value*)arr->data;
+    it->n = arr->size / sizeof(lbm_value);
+    return true;
+  }
+  return false;
+}
+
+static lbm_value seq_iter_next(seq_iter_t *it) {
+  lbm_value v;
+  if (it->data) {
+    v = it->data[it->ix];
+  } else {
+    v = lbm_car(it->curr);
+    it->curr = lbm_cdr(it->curr);
+  }
+  it->ix ++;
+  return v;
+}
+
+static lbm_uint field_size(lbm_uint type) {
+  if (type == sym_i8 || type == sym_u8) return 1;
+  if (type == sym_i16 || type == sym_u16) return 2;
+  if (type == sym_u24) return 3;
+  if (type == sym_i32 || type == sym_u32 || type == sym_f32) return 4;
+  return 0;
+}
+
+// Decode a field description and advance the cursor past the field.
+// Returns false if the field is malformed or does not fit in the buffer.
+static bool decode_field(lbm_value field, lbm_uint start, lbm_uint d_size, lbm_uint *cursor,
+                         lbm_uint *type, lbm_uint *index, lbm_uint *nbytes) {
+  lbm_value t = field;
+  lbm_uint ix = *cursor;
+  if (lbm_is_cons(field)) {
+    t = lbm_car(field);
+    if (!lbm_is_number(lbm_cdr(field))) return false;
+    ix = start + lbm_dec_as_u32(lbm_cdr(field));
+  }
+  if (!lbm_is_symbol(t)) return false;
+  *type = lbm_dec_sym(t);
+  *nbytes = field_size(*type);
+  if (*nbytes == 0 || ix + *nbytes > d_size) return false;
+  *index = ix;
+  *cursor = ix + *nbytes;
+  return true;
+}
+
+static lbm_value decode_field_value(lbm_uint type, lbm_uint value) {
+  if (type == sym_i8)  return lbm_enc_i((int8_t)value);
+  if (type == sym_u8)  return lbm_enc_i((uint8_t)value);
+  if (type == sym_i16) return lbm_enc_i((int16_t)value);
+  if (type == sym_u16) return lbm_enc_i((uint16_t)value);
+  if (type == sym_u24) return lbm_enc_i((int32_t)value);
+  if (type == sym_i32) return lbm_enc_i((int32_t)value);
+  if (type == sym_u32) return lbm_enc_u32((uint32_t)value);
+  return lbm_enc_float(u_to_float((uint32_t)value));
+}
+
+static lbm_uint encode_field_value(lbm_uint type, lbm_value v) {
+  if (type == sym_f32) return float_to_u(lbm_dec_as_float(v));
+  if (type == sym_i8 || type == sym_i16 || type == sym_i32) return (lbm_uint)lbm_dec_as_i32(v);
+  return (lbm_uint)lbm_dec_as_u32(v);
+}
+
+/* (bufget-many buffer index layout [endianness]) */
+/* Returns a list or lisp array, matching the layout, of the field values. */
+static lbm_value array_extensions_bufget_many(lbm_value *args, lbm_uint argn) {
+  if (argn != 3 && argn != 4) return ENC_SYM_EERROR;
+
+  bool be = !(argn == 4 &&
+              lbm_is_symbol(args[3]) &&
+              lbm_dec_sym(args[3]) == little_endian);
+  lbm_array_header_t *array = lbm_dec_array_r(args[0]);
+  seq_iter_t it;
+  if (!array || !lbm_is_number(args[1]) || !seq_iter_init(&it, args[2])) {
+    return ENC_SYM_TERROR;
+  }
+
+  lbm_value res;
+  lbm_value *res_data = NULL;
+  lbm_value res_curr;
+  if (it.data) {
+    if (!lbm_heap_allocate_lisp_array(&res, it.n)) return res;
+    if (it.n > 0) res_data = (lbm_value*)lbm_dec_lisp_array_rw(res)->data;
+  } else {
+    res = lbm_heap_allocate_list(it.n);
+    if (lbm_is_symbol_merror(res)) return res;
+  }
+  res_curr = res;
+
+  uint8_t *data = (uint8_t*)array->data;
+  lbm_uint start = lbm_dec_as_u32(args[1]);
+  lbm_uint cursor = start;
+  for (lbm_uint i = 0; i < it.n; i ++) {
+    lbm_uint type, index, nbytes, value;
+    if (!decode_field(seq_iter_next(&it), start, array->size, &cursor, &type, &index, &nbytes) ||
+        !buffer_get_uint(&value, data, array->size, be, index, nbytes)) {
+      return ENC_SYM_EERROR;
+    }
+    lbm_value v = decode_field_value(type, value);
+    if (lbm_is_symbol_merror(v)) return v;
+    if (res_data) {
+      res_data[i] = v;
+    } else {
+      lbm_set_car(res_curr, v);
+      res_curr = lbm_cdr(res_curr);
+    }
+  }
+  return res;
+}
+
+/* (bufset-many buffer index layout values [endianness]) */
+/* All fields are checked before the buffer is modified. */
+static lbm_value array_extensions_bufset_many(lbm_value *args, lbm_uint argn) {
+  if (argn != 4 && argn != 5) return ENC_SYM_EERROR;
+
+  bool be = !(argn == 5 &&
+              lbm_is_symbol(args[4]) &&
+              lbm_dec_sym(args[4]) == little_endian);
+  lbm_array_header_t *array = lbm_dec_array_rw(args[0]);
+  seq_iter_t it;
+  seq_iter_t vals;
+  if (!array || !lbm_is_number(args[1]) ||
+      !seq_iter_init(&it, args[2]) ||
+      !seq_iter_init(&vals, args[3])) {
+    return ENC_SYM_TERROR;
+  }
+  if (it.n != vals.n) return ENC_SYM_EERROR;
+
+  uint8_t *data = (uint8_t*)array->data;
+  lbm_uint start = lbm_dec_as_u32(args[1]);
+  for (int pass = 0; pass < 2; pass ++) {
+    lbm_uint cursor = start;
+    seq_iter_init(&it, args[2]);
+    seq_iter_init(&vals, args[3]);
+    for (lbm_uint i = 0; i < it.n; i ++) {
+      lbm_uint type, index, nbytes;
+      lbm_value v = seq_iter_next(&vals);
+      if (pass == 0) {
+        if (!decode_field(seq_iter_next(&it), start, array->size, &cursor, &type, &index, &nbytes)) {
+          return ENC_SYM_EERROR;
+        }
+        if (!lbm_is_number(v)) return ENC_SYM_TERROR;
+      } else {
+        decode_field(seq_iter_next(&it), start, array->size, &cursor, &type, &index, &nbytes);
+        buffer_append_bytes(data, array->size, be, index, nbytes, encode_field_value(type, v));
+      }
+    }
+  }
+  return ENC_SYM_TRUE;
+}
+
+// Codecs
+//
+// A codec is compiled from a schema, a list of field specifications
+// (name type [scale]), into a table of fields with precomputed offsets.
+// The type is one of the bulk access type symbols. A field with a scale
+// holds a number stored as an integer multiplied by the scale, in the
+// same way as buffer_append_float16 and buffer_append_float32 do.
+// Fields are packed back to back in schema order.
+
+typedef struct {
+  lbm_uint name;
+  lbm_uint type;
+  lbm_uint offset;
+  lbm_uint nbytes;
+  float scale; // 0 for unscaled fields.
+} codec_field_t;
+
+typedef struct {
+  lbm_uint num_fields;
+  lbm_uint size;
+  bool be;
+  codec_field_t fields[];
+} codec_t;
+
+static const char *codec_desc = "Codec";
+
+static bool codec_destructor(lbm_uint value) {
+  lbm_free((void*)value);
+  return true;
+}
+
+static codec_t *dec_codec(lbm_value v) {
+  if (lbm_is_custom(v) &&
+      lbm_get_custom_descriptor(v) == codec_desc) {
+    return (codec_t*)lbm_get_custom_value(v);
+  }
+  return NULL;
+}
+
+static lbm_value codec_decode_field(codec_field_t *f, uint8_t *data, lbm_uint d_size, bool be, lbm_uint offset) {
+  lbm_uint value = 0;
+  buffer_get_uint(&value, data, d_size, be, offset + f->offset, f->nbytes);
+  if (f->scale == 0.0f) {
+    return decode_field_value(f->type, value);
+  }
+  float x;
+  if (f->type == sym_i8) x = (float)(int8_t)value;
+  else if (f->type == sym_i16) x = (float)(int16_t)value;
+  else if (f->type == sym_i32) x = (float)(int32_t)value;
+  else x = (float)value;
+  return lbm_enc_float(x / f->scale);
+}
+
+// A scaled value is converted through int64_t so that negative values
+// wrap in the low bytes, as unscaled integers do. The value is first
+// clamped to what 32 bits can hold since converting an out of range
+// float to an integer is undefined.
+static lbm_uint codec_scaled_value(float x) {
+  int64_t i;
+  if (!(x > (float)INT32_MIN)) i = INT32_MIN; // Also NaN.
+  else if (x >= (float)UINT32_MAX) i = UINT32_MAX;
+  else i = (int64_t)x;
+  return (lbm_uint)(uint32_t)i;
+}
+
+static void codec_encode_field(codec_field_t *f, uint8_t *data, lbm_uint d_size, bool be, lbm_uint offset, lbm_value v) {
+  lbm_uint value;
+  if (f->scale == 0.0f) {
+    value = encode_field_value(f->type, v);
+  } else {
+    value = codec_scaled_value(lbm_dec_as_float(v) * f->scale);
+  }
+  buffer_append_bytes(data, d_size, be, offset + f->offset, f->nbytes, value);
+}
+
+// Decode the buffer and offset arguments of decode, unpack and encode.
+static bool decode_codec_args(lbm_value *args, lbm_uint argn, bool rw, codec_t **codec, lbm_array_header_t **array, lbm_uint *offset) {
+  if (argn < 2) return false;
+  *codec = dec_codec(args[0]);
+  *array = rw ? lbm_dec_array_rw(args[1]) : lbm_dec_array_r(args[1]);
+  *offset = 0;
+  if (argn >= 3) {
+    if (!lbm_is_number(args[2])) return false;
+    *offset = lbm_dec_as_u32(args[2]);
+  }
+  return *codec && *array;
+}
+
+/* (codec-compile schema [endianness]) */
+static lbm_value array_extensions_codec_compile(lbm_value *args, lbm_uint argn) {
+  if (argn != 1 && argn != 2) return ENC_SYM_EERROR;
+  if (!lbm_is_list(args[0])) return ENC_SYM_TERROR;
+
+  lbm_uint n = lbm_list_length(args[0]);
+  codec_t *codec = lbm_malloc(sizeof(codec_t) + n * sizeof(codec_field_t));
+  if (!codec) return ENC_SYM_MERROR;
+  codec->num_fields = n;
+  codec->be = !(argn == 2 &&
+                lbm_is_symbol(args[1]) &&
+                lbm_dec_sym(args[1]) == little_endian);
+
+  lbm_uint offset = 0;
+  lbm_value curr = args[0];
+  for (lbm_uint i = 0; i < n; i ++) {
+    lbm_value spec = lbm_car(curr);
+    curr = lbm_cdr(curr);
+    if (!lbm_is_cons(spec) || !lbm_is_cons(lbm_cdr(spec))) {
+      lbm_free(codec);
+      return ENC_SYM_TERROR;
+    }
+    lbm_value name = lbm_car(spec);
+    lbm_value type = lbm_car(lbm_cdr(spec));
+    lbm_value scale = lbm_cdr(lbm_cdr(spec));
+    codec_field_t *f = &codec->fields[i];
+    if (!lbm_is_symbol(name) || !lbm_is_symbol(type) ||
+        !(lbm_is_symbol_nil(scale) || lbm_is_number(lbm_car(scale)))) {
+      lbm_free(codec);
+      return ENC_SYM_TERROR;
+    }
+    f->name = name;
+    f->type = lbm_dec_sym(type);
+    f->nbytes = field_size(f->type);
+    f->offset = offset;
+    f->scale = lbm_is_symbol_nil(scale) ? 0.0f : lbm_dec_as_float(lbm_car(scale));
+    if (f->nbytes == 0 ||
+        (f->scale != 0.0f && f->type == sym_f32)) {
+      lbm_free(codec);
+      return ENC_SYM_EERROR;
+    }
+    offset += f->nbytes;
+  }
+  codec->size = offset;
+
+  lbm_value res;
+  if (!lbm_custom_type_create((lbm_uint)codec, codec_destructor, codec_desc, &res)) {
+    lbm_free(codec);
+    return ENC_SYM_MERROR;
+  }
+  return res;
+}
+
+/* (codec-size codec) */
+static lbm_value array_extensions_codec_size(lbm_value *args, lbm_uint argn) {
+  codec_t *codec;
+  if (argn != 1 || !(codec = dec_codec(args[0]))) return ENC_SYM_TERROR;
+  return lbm_enc_i((lbm_int)codec->size);
+}
+
+/* (codec-decode codec buffer [offset]) */
+/* Returns an association list from field names to values. */
+static lbm_value array_extensions_codec_decode(lbm_value *args, lbm_uint argn) {
+  codec_t *codec;
+  lbm_array_header_t *array;
+  lbm_uint offset;
+  if (argn > 3 || !decode_codec_args(args, argn, false, &codec, &array, &offset)) {
+    return ENC_SYM_TERROR;
+  }
+  if (offset + codec->size > array->size) return ENC_SYM_EERROR;
+
+  lbm_value res = ENC_SYM_NIL;
+  for (lbm_uint i = codec->num_fields; i > 0; i --) {
+    codec_field_t *f = &codec->fields[i - 1];
+    lbm_value v = codec_decode_field(f, (uint8_t*)array->data, array->size, codec->be, offset);
+    if (lbm_is_symbol_merror(v)) return v;
+    lbm_value binding = lbm_cons(f->name, v);
+    if (lbm_is_symbol_merror(binding)) return binding;
+    res = lbm_cons(binding, res);
+    if (lbm_is_symbol_merror(res)) return res;
+  }
+  return res;
+}
+
+/* (codec-unpack codec buffer [offset]) */
+/* Returns the field values in schema order in a lisp array. */
+static lbm_value array_extensions_codec_unpack(lbm_value *args, lbm_uint argn) {
+  codec_t *codec;
+  lbm_array_header_t *array;
+  lbm_uint offset;
+  if (argn > 3 || !decode_codec_args(args, argn, false, &codec, &array, &offset)) {
+    return ENC_SYM_TERROR;
+  }
+  if (offset + codec->size > array->size) return ENC_SYM_EERROR;
+
+  lbm_value res;
+  if (!lbm_heap_allocate_lisp_array(&res, codec->num_fields)) return res;
+  if (codec->num_fields == 0) return res;
+  lbm_value *res_data = (lbm_value*)lbm_dec_lisp_array_rw(res)->data;
+  for (lbm_uint i = 0; i < codec->num_fields; i ++) {
+    lbm_value v = codec_decode_field(&codec->fields[i], (uint8_t*)array->data, array->size, codec->be, offset);
+    if (lbm_is_symbol_merror(v)) return v;
+    res_data[i] = v;
+  }
+  return res;
+}
+
+/* (codec-encode codec buffer offset values) */
+/* values is an association list from field names to values or a list */
+/* or lisp array of values in schema order. */
+static lbm_value array_extensions_codec_encode(lbm_value *args, lbm_uint argn) {
+  codec_t *codec;
+  lbm_array_header_t *array;
+  lbm_uint offset;
+  if (argn != 4 || !decode_codec_args(args, argn, true, &codec, &array, &offset)) {
+    return ENC_SYM_TERROR;
+  }
+  if (offset + codec->size > array->size) return ENC_SYM_EERROR;
+
+  bool alist = lbm_is_cons(args[3]) && lbm_is_cons(lbm_car(args[3]));
+  seq_iter_t vals;
+  if (!alist) {
+    if (!seq_iter_init(&vals, args[3])) return ENC_SYM_TERROR;
+    if (vals.n != codec->num_fields) return ENC_SYM_EERROR;
+  }
+
+  // Look up all values before writing so that a missing field or a
+  // value of the wrong type leaves the buffer untouched.
+  for (int pass = 0; pass < 2; pass ++) {
+    if (!alist) seq_iter_init(&vals, args[3]);
+    for (lbm_uint i = 0; i < codec->num_fields; i ++) {
+      codec_field_t *f = &codec->fields[i];
+      lbm_value v = ENC_SYM_NIL;
+      if (alist) {
+        lbm_value binding = ENC_SYM_NIL;
+        for (lbm_value curr = args[3]; lbm_is_cons(curr); curr = lbm_cdr(curr)) {
+          if (lbm_car(lbm_car(curr)) == f->name) {
+            binding = lbm_car(curr);
+            break;
+          }
+        }
+        if (pass == 0 && !lbm_is_cons(binding)) return ENC_SYM_EERROR;
+        v = lbm_cdr(binding);
+      } else {
+        v = seq_iter_next(&vals);
+      }
+      if (pass == 0) {
+        if (!lbm_is_number(v)) return ENC_SYM_TERROR;
+      } else {
+        codec_encode_field(f, (uint8_t*)array->data, array->size, codec->be, offset, v);
+      }
+    }
+  }
+  return ENC_SYM_TRUE;
+}
+
+// Vectors
+//
+// A vector is a lisp array with spare capacity at the end of its data.
+// The array size is the number of elements in use so a vector can be
+// used anywhere a lisp array can. The capacity, in elements, is kept
+// after the fields of the lisp array header. GC frees the header by
+// pointer so the larger header needs no special treatment. Arrays
+// tagged as lisp arrays have no spare capacity and are turned into
+// vectors the first time they grow.
+
+#define VEC_MIN_CAPACITY 4
+
+typedef struct {
+  lbm_array_header_extended_t arr;
+  lbm_uint capacity;
+} vec_header_t;
+
+static lbm_array_header_t *dec_vec(lbm_value v) {
+  if (lbm_is_lisp_array_rw(v) &&
+      (lbm_cdr(v) == ENC_SYM_LISPARRAY_TYPE ||
+       lbm_cdr(v) == ENC_SYM_VECTOR_TYPE)) {
+    return (lbm_array_header_t*)lbm_car(v);
+  }
+  return NULL;
+}
+
+static lbm_uint vec_capacity(lbm_value v, lbm_array_header_t *arr) {
+  if (lbm_cdr(v) != ENC_SYM_VECTOR_TYPE) return arr->size / sizeof(lbm_value);
+  return ((vec_header_t*)arr)->capacity;
+}
+
+// Make room for n elements. The vector is unchanged on failure.
+// Returns the header, which is replaced when v becomes a vector.
+static lbm_array_header_t *vec_reserve(lbm_value v, lbm_array_header_t *arr, lbm_uint n) {
+  lbm_uint cap = vec_capacity(v, arr);
+  if (n <= cap) return arr;
+  if (cap < VEC_MIN_CAPACITY) cap = VEC_MIN_CAPACITY;
+  while (cap < n) cap *= 2;
+  vec_header_t *vh = (vec_header_t*)arr;
+  if (lbm_cdr(v) != ENC_SYM_VECTOR_TYPE) {
+    vh = lbm_malloc(sizeof(vec_header_t));
+    if (!vh) return NULL;
+  }
+  lbm_value *data = lbm_malloc(cap * sizeof(lbm_value));
+  if (!data) {
+    if ((lbm_array_header_t*)vh != arr) lbm_free(vh);
+    return NULL;
+  }
+  memset(data, 0, cap * sizeof(lbm_value));
+  if (arr->data) {
+    memcpy(data, arr->data, arr->size);
+    lbm_free(arr->data);
+  }
+  if ((lbm_array_header_t*)vh != arr) {
+    vh->arr = *(lbm_array_header_extended_t*)arr;
+    lbm_free(arr);
+    lbm_ref_cell(v)->car = (lbm_uint)vh;
+    lbm_ref_cell(v)->cdr = ENC_SYM_VECTOR_TYPE;
+  }
+  vh->arr.data = (lbm_uint*)data;
+  vh->capacity = cap;
+  return (lbm_array_header_t*)vh;
+}
+
+/* (vec-push vector value) */
+static lbm_value array_extensions_vec_push(lbm_value *args, lbm_uint argn) {
+  lbm_array_header_t *arr;
+  if (argn != 2 || !(arr = dec_vec(args[0]))) return ENC_SYM_TERROR;
+  lbm_uint n = arr->size / sizeof(lbm_value);
+  if (!(arr = vec_reserve(args[0], arr, n + 1))) return ENC_SYM_MERROR;
+  ((lbm_value*)arr->data)[n] = args[1];
+  arr->size += sizeof(lbm_value);
+  return args[0];
+}
+
+/* (vec-pop vector) */
+/* Returns the last element or nil for an empty vector. */
+static lbm_value array_extensions_vec_pop(lbm_value *args, lbm_uint argn) {
+  lbm_array_header_t *arr;
+  if (argn != 1 || !(arr = dec_vec(args[0]))) return ENC_SYM_TERROR;
+  lbm_uint n = arr->size / sizeof(lbm_value);
+  if (n == 0) return ENC_SYM_NIL;
+  lbm_value *data = (lbm_value*)arr->data;
+  lbm_value res = data[n - 1];
+  data[n - 1] = ENC_SYM_NIL;
+  arr->size -= sizeof(lbm_value);
+  // Give back half of the memory when a quarter or less is in use.
+  if (lbm_cdr(args[0]) == ENC_SYM_VECTOR_TYPE) {
+    vec_header_t *vh = (vec_header_t*)arr;
+    if (vh->capacity > VEC_MIN_CAPACITY &&
+        n - 1 <= vh->capacity / 4 &&
+        lbm_memory_shrink((lbm_uint*)data, vh->capacity / 2)) {
+      vh->capacity /= 2;
+    }
+  }
+  return res;
+}
+
+/* (vec-insert vector index value) */
+static lbm_value array_extensions_vec_insert(lbm_value *args, lbm_uint argn) {
+  lbm_array_header_t *arr;
+  if (argn != 3 || !(arr = dec_vec(args[0])) || !lbm_is_number(args[1])) {
+    return ENC_SYM_TERROR;
+  }
+  lbm_uint n = arr->size / sizeof(lbm_value);
+  lbm_int ix = lbm_dec_as_i32(args[1]);
+  if (ix < 0) ix += (lbm_int)n + 1;
+  if (ix < 0 || (lbm_uint)ix > n) return ENC_SYM_EERROR;
+  if (!(arr = vec_reserve(args[0], arr, n + 1))) return ENC_SYM_MERROR;
+  lbm_value *data = (lbm_value*)arr->data;
+  memmove(data + ix + 1, data + ix, (n - (lbm_uint)ix) * sizeof(lbm_value));
+  data[ix] = args[2];
+  arr->size += sizeof(lbm_value);
+  return args[0];
+}
+
+/* (vec-capacity vector) */
+static lbm_value array_extensions_vec_capacity(lbm_value *args, lbm_uint argn) {
+  lbm_array_header_t *arr;
+  if (argn != 1 || !(arr = dec_vec(args[0]))) return ENC_SYM_TERROR;
+  return lbm_enc_i((lbm_int)vec_capacity(args[0], arr));
+}
+
+// Array ranges
+//
+// Ranges are given as start and end indices where the end is exclusive
+// and defaults to the length. Negative indices count from the end.
+
+static bool decode_range(lbm_value *args, lbm_uint argn, lbm_uint ix, lbm_uint len, lbm_uint *start, lbm_uint *end) {
+  lbm_int r[2] = {0, (lbm_int)len};
+  for (int i = 0; i < 2 && ix + (lbm_uint)i < argn; i ++) {
+    lbm_value v = args[ix + (lbm_uint)i];
+    if (!lbm_is_number(v)) return false;
+    r[i] = lbm_dec_as_i32(v);
+    if (r[i] < 0) r[i] += (lbm_int)len;
+  }
+  if (r[0] < 0 || r[1] < r[0] || (lbm_uint)r[1] > len) return false;
+  *start = (lbm_uint)r[0];
+  *end = (lbm_uint)r[1];
+  return true;
+}
+
+/* (array-slice array start [end])
+ * A slice of a lisp array is a copy. A slice of a byte array is a view
+ * that shares storage with the original. */
+static lbm_value array_extensions_array_slice(lbm_value *args, lbm_uint argn) {
+  if (argn < 2 || argn > 3) return ENC_SYM_EERROR;
+  lbm_array_header_t *arr;
+  lbm_uint start, end;
+  lbm_value res = ENC_SYM_TERROR;
+  if ((arr = lbm_dec_lisp_array_r(args[0]))) {
+    if (!decode_range(args, argn, 1, arr->size / sizeof(lbm_value), &start, &end)) return ENC_SYM_EERROR;
+    if (lbm_heap_allocate_lisp_array(&res, end - start) && end > start) {
+      memcpy(lbm_dec_lisp_array_rw(res)->data, (lbm_value*)arr->data + start, (end - start) * sizeof(lbm_value));
+    }
+  } else if ((arr = lbm_dec_array_r(args[0]))) {
+    if (!decode_range(args, argn, 1, arr->size, &start, &end)) return ENC_SYM_EERROR;
+    lbm_heap_allocate_array_view(&res, args[0], start, end - start);
+  }
+  return res;
+}
+
+/* (array-fill! array value [start end]) */
+static lbm_value array_extensions_array_fill(lbm_value *args, lbm_uint argn) {
+  if (argn < 2 || argn > 4) return ENC_SYM_EERROR;
+  lbm_array_header_t *arr = lbm_dec_lisp_array_rw(args[0]);
+  if (!arr) return ENC_SYM_TERROR;
+  lbm_uint start, end;
+  if (!decode_range(args, argn, 2, arr->size / sizeof(lbm_value), &start, &end)) return ENC_SYM_EERROR;
+  lbm_value *data = (lbm_value*)arr->data;
+  for (lbm_uint i = start; i < end; i ++) {
+    data[i] = args[1];
+  }
+  return args[0];
+}
+
+/* (array-copy! dest dest-start src [src-start src-end]) */
+static lbm_value array_extensions_array_copy(lbm_value *args, lbm_uint argn) {
+  if (argn < 3 || argn > 5) return ENC_SYM_EERROR;
+  lbm_array_header_t *dst = lbm_dec_lisp_array_rw(args[0]);
+  lbm_array_header_t *src = lbm_dec_lisp_array_r(args[2]);
+  if (!dst || !src || !lbm_is_number(args[1])) return ENC_SYM_TERROR;
+  lbm_uint dst_len = dst->size / sizeof(lbm_value);
+  lbm_uint start, end;
+  if (!decode_range(args, argn, 3, src->size / sizeof(lbm_value), &start, &end)) return ENC_SYM_EERROR;
+  lbm_int at = lbm_dec_as_i32(args[1]);
+  if (at < 0) at += (lbm_int)dst_len;
+  if (at < 0 || (lbm_uint)at > dst_len || end - start > dst_len - (lbm_uint)at) return ENC_SYM_EERROR;
+  if (end > start) {
+    memmove((lbm_value*)dst->data + at, (lbm_value*)src->data + start, (end - start) * sizeof(lbm_value));
+  }
+  return args[0];
+}
@@ -0,0 +1,371 @@
+/*
+    Copyright 2025 Joel Svensson        svenssonjoel@yahoo.se
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "extensions/checksum_extensions.h"
+
+#include "extensions.h"
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+// All checksums are computed over the whole byte array, including the
+// terminating zero of a string. Use array-slice to checksum a part of
+// an array without copying.
+//
+// The CRCs can be computed in pieces by passing the result of one call
+// as the init argument of the next.
+//
+// The CRC tables for the default polynomials are const and live in
+// flash, see checksum_tables.h. CRC-32 and CRC-32C use one 1 KB table
+// each, defining LBM_CHECKSUM_SLICING_BY_8 selects slicing-by-8 with
+// 8 KB tables instead. When the compiler targets a CPU with CRC
+// instructions those are used instead of the tables. A custom poly is
+// computed bit by bit.
+
+#define CRC32_POLY   0x04C11DB7u
+#define CRC32C_POLY  0x1EDC6F41u
+#define CRC16_POLY   0x1021u
+#define CRC8_POLY    0x07u
+
+#ifdef LBM_CHECKSUM_SLICING_BY_8
+#define CRC32_SLICES 8
+#else
+#define CRC32_SLICES 1
+#endif
+
+#if !(defined(__ARM_FEATURE_CRC32))
+#define CRC32_USE_TABLES
+#endif
+#if !(defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32))
+#define CRC32C_USE_TABLES
+#endif
+
+#include "checksum_tables.h"
+
+// ////////////////////////////////////////////////////////////
+// Tables
+
+static uint32_t reflect32(uint32_t x) {
+  uint32_t r = 0;
+  for (int i = 0; i < 32; i ++) {
+    r = (r << 1) | (x & 1);
+    x >>= 1;
+  }
+  return r;
+}
+
+#if defined(CRC32_USE_TABLES) || defined(CRC32C_USE_TABLES)
+static uint32_t crc32_slices(const uint32_t tab[][256], uint32_t crc, const uint8_t *p, lbm_uint n) {
+#if CRC32_SLICES == 8
+  while (n >= 8) {
+    uint32_t one = crc ^ ((uint32_t)p[0] | (uint32_t)p[1] << 8 |
+                          (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24);
+    uint32_t two = ((uint32_t)p[4] | (uint32_t)p[5] << 8 |
+                    (uint32_t)p[6] << 16 | (uint32_t)p[7] << 24);
+    crc = tab[7][one & 0xFF] ^ tab[6][(one >> 8) & 0xFF] ^
+          tab[5][(one >> 16) & 0xFF] ^ tab[4][one >> 24] ^
+          tab[3][two & 0xFF] ^ tab[2][(two >> 8) & 0xFF] ^
+          tab[1][(two >> 16) & 0xFF] ^ tab[0][two >> 24];
+    p += 8;
+    n -= 8;
+  }
+#endif
+  while (n--) {
+    crc = (crc >> 8) ^ tab[0][(crc ^ *p++) & 0xFF];
+  }
+  return crc;
+}
+#endif
+
+// ////////////////////////////////////////////////////////////
+// CRC-32 and CRC-32C, the register is kept inverted.
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t *p, lbm_uint n) {
+#if defined(__ARM_FEATURE_CRC32)
+  while (n >= 4) {
+    uint32_t w;
+    memcpy(&w, p, 4);
+    crc = __crc32w(crc, w);
+    p += 4;
+    n -= 4;
+  }
+  while (n--) crc = __crc32b(crc, *p++);
+  return crc;
+#else
+  return crc32_slices(crc32_tab, crc, p, n);
+#endif
+}
+
+static uint32_t crc32c_update(uint32_t crc, const uint8_t *p, lbm_uint n) {
+#if defined(__SSE4_2__) && defined(__x86_64__)
+  uint64_t c = crc;
+  while (n >= 8) {
+    uint64_t w;
+    memcpy(&w, p, 8);
+    c = _mm_crc32_u64(c, w);
+    p += 8;
+    n -= 8;
+  }
+  crc = (uint32_t)c;
+  while (n--) crc = _mm_crc32_u8(crc, *p++);
+  return crc;
+#elif defined(__SSE4_2__)
+  while (n--) crc = _mm_crc32_u8(crc, *p++);
+  return crc;
+#elif defined(__ARM_FEATURE_CRC32)
+  while (n >= 4) {
+    uint32_t w;
+    memcpy(&w, p, 4);
+    crc = __crc32cw(crc, w);
+    p += 4;
+    n -= 4;
+  }
+  while (n--) crc = __crc32cb(crc, *p++);
+  return crc;
+#else
+  return crc32_slices(crc32c_tab, crc, p, n);
+#endif
+}
+
+static bool dec_buffer(lbm_value v, const uint8_t **data, lbm_uint *size) {
+  lbm_array_header_t *arr = lbm_dec_array_r(v);
+  if (!arr) return false;
+  *data = (const uint8_t*)arr->data;
+  *size = arr->size;
+  return true;
+}
+
+// Decode (buf [init [poly]]) style arguments.
+static bool dec_crc_args(lbm_value *args, lbm_uint argn, const uint8_t **data, lbm_uint *size,
+                         uint32_t *init, uint32_t *poly) {
+  if (argn < 1 || argn > 3 || !dec_buffer(args[0], data, size)) return false;
+  for (lbm_uint i = 1; i < argn; i ++) {
+    if (!lbm_is_number(args[i])) return false;
+  }
+  if (argn >= 2) *init = lbm_dec_as_u32(args[1]);
+  if (argn >= 3) *poly = lbm_dec_as_u32(args[2]);
+  return true;
+}
+
+/* (crc32 buf [init poly])
+ * CRC-32 as used by zlib and ethernet. The poly is given in normal form. */
+static lbm_value ext_crc32(lbm_value *args, lbm_uint argn) {
+  const uint8_t *data;
+  lbm_uint size;
+  uint32_t init = 0;
+  uint32_t poly = CRC32_POLY;
+  if (!dec_crc_args(args, argn, &data, &size, &init, &poly)) return ENC_SYM_TERROR;
+  uint32_t crc = ~init;
+  if (poly == CRC32_POLY) {
+    crc = crc32_update(crc, data, size);
+  } else {
+    uint32_t rpoly = reflect32(poly);
+    for (lbm_uint i = 0; i < size; i ++) {
+      crc ^= data[i];
+      for (int k = 0; k < 8; k ++) {
+        crc = (crc & 1) ? (crc >> 1) ^ rpoly : crc >> 1;
+      }
+    }
+  }
+  return lbm_enc_u32(~crc);
+}
+
+/* (crc32c buf [init]) */
+static lbm_value ext_crc32c(lbm_value *args, lbm_uint argn) {
+  const uint8_t *data;
+  lbm_uint size;
+  uint32_t init = 0;
+  uint32_t poly = CRC32C_POLY;
+  if (argn > 2 || !dec_crc_args(args, argn, &data, &size, &init, &poly)) return ENC_SYM_TERROR;
+  return lbm_enc_u32(~crc32c_update(~init, data, size));
+}
+
+/* (crc16 buf [init poly])
+ * Defaults to CRC-16/XMODEM, the CRC used by VESC packets. */
+static lbm_value ext_crc16(lbm_value *args, lbm_uint argn) {
+  const uint8_t *data;
+  lbm_uint size;
+  uint32_t init = 0;
+  uint32_t poly = CRC16_POLY;
+  if (!dec_crc_args(args, argn, &data, &size, &init, &poly)) return ENC_SYM_TERROR;
+  uint16_t crc = (uint16_t)init;
+  if ((poly & 0xFFFF) == CRC16_POLY) {
+    for (lbm_uint i = 0; i < size; i ++) {
+      crc = (uint16_t)((crc << 8) ^ crc16_tab[((crc >> 8) ^ data[i]) & 0xFF]);
+    }
+  } else {
+    for (lbm_uint i = 0; i < size; i ++) {
+      crc ^= (uint16_t)(data[i] << 8);
+      for (int k = 0; k < 8; k ++) {
+        crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ poly) : (uint16_t)(crc << 1);
+      }
+    }
+  }
+  return lbm_enc_i(crc);
+}
+
+/* (crc8 buf [init poly]) */
+static lbm_value ext_crc8(lbm_value *args, lbm_uint argn) {
+  const uint8_t *data;
+  lbm_uint size;
+  uint32_t init = 0;
+  uint32_t poly = CRC8_POLY;
+  if (!dec_crc_args(args, argn, &data, &size, &init, &poly)) return ENC_SYM_TERROR;
+  uint8_t crc = (uint8_t)init;
+  if ((poly & 0xFF) == CRC8_POLY) {
+    for (lbm_uint i = 0; i < size; i ++) {
+      crc = crc8_tab[crc ^ data[i]];
+    }
+  } else {
+    for (lbm_uint i = 0; i < size; i ++) {
+      crc ^= data[i];
+      for (int k = 0; k < 8; k ++) {
+        crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ poly) : (uint8_t)(crc << 1);
+      }
+    }
+  }
+  return lbm_enc_i(crc);
+}
+
+// ////////////////////////////////////////////////////////////
+// Checksums
+
+#define ADLER_MOD  65521u
+#define ADLER_NMAX 5552 // Largest n such that the sums fit in 32 bits.
+
+/* (adler32 buf [init]) */
+static lbm_value ext_adler32(lbm_value *args, lbm_uint argn) {
+  const uint8_t *data;
+  lbm_uint size;
+  uint32_t init = 1;
+  uint32_t unused = 0;
+  if (argn > 2 || !dec_crc_args(args, argn, &data, &size, &init, &unused)) return ENC_SYM_TERROR;
+  uint32_t a = init & 0xFFFF;
+  uint32_t b = init >> 16;
+  while (size > 0) {
+    lbm_uint n = size < ADLER_NMAX ? size : ADLER_NMAX;
+    size -= n;
+    while (n--) {
+      a += *data++;
+      b += a;
+    }
+    a %= ADLER_MOD;
+    b %= ADLER_MOD;
+  }
+  return lbm_enc_u32((b << 16) | a);
+}
+
+/* (fletcher16 buf) */
+static lbm_value ext_fletcher16(lbm_value *args, lbm_uint argn) {
+  const uint8_t *data;
+  lbm_uint size;
+  if (argn != 1 || !dec_buffer(args[0], &data, &size)) return ENC_SYM_TERROR;
+  uint32_t a = 0;
+  uint32_t b = 0;
+  while (size > 0) {
+    // 359 bytes keep b below 2^32 before the reduction.
+    lbm_uint n = size < 359 ? size : 359;
+    size -= n;
+    while (n--) {
+      a += *data++;
+      b += a;
+    }
+    a %= 255;
+    b %= 255;
+  }
+  return lbm_enc_i((lbm_int)((b << 8) | a));
+}
+
+// ////////////////////////////////////////////////////////////
+// xxHash32
+
+#define XXH_P1 2654435761u
+#define XXH_P2 2246822519u
+#define XXH_P3 3266489917u
+#define XXH_P4 668265263u
+#define XXH_P5 374761393u
+
+static uint32_t rotl32(uint32_t x, int r) {
+  return (x << r) | (x >> (32 - r));
+}
+
+static uint32_t read32le(const uint8_t *p) {
+  return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint32_t xxh32_round(uint32_t acc, uint32_t in) {
+  return rotl32(acc + in * XXH_P2, 13) * XXH_P1;
+}
+
+static uint32_t xxh32(const uint8_t *p, lbm_uint len, uint32_t seed) {
+  const uint8_t *end = p + len;
+  uint32_t h;
+  if (len >= 16) {
+    uint32_t v1 = seed + XXH_P1 + XXH_P2;
+    uint32_t v2 = seed + XXH_P2;
+    uint32_t v3 = seed;
+    uint32_t v4 = seed - XXH_P1;
+    while (end - p >= 16) {
+      v1 = xxh32_round(v1, read32le(p));
+      v2 = xxh32_round(v2, read32le(p + 4));
+      v3 = xxh32_round(v3, read32le(p + 8));
+      v4 = xxh32_round(v4, read32le(p + 12));
+      p += 16;
+    }
+    h = rotl32(v1, 1) + rotl32(v2, 7) + rotl32(v3, 12) + rotl32(v4, 18);
+  } else {
+    h = seed + XXH_P5;
+  }
+  h += (uint32_t)len;
+  while (end - p >= 4) {
+    h = rotl32(h + read32le(p) * XXH_P3, 17) * XXH_P4;
+    p += 4;
+  }
+  while (p < end) {
+    h = rotl32(h + (*p++) * XXH_P5, 11) * XXH_P1;
+  }
+  h ^= h >> 15;
+  h *= XXH_P2;
+  h ^= h >> 13;
+  h *= XXH_P3;
+  h ^= h >> 16;
+  return h;
+}
+
+/* (hash32 buf [seed]) */
+static lbm_value ext_hash32(lbm_value *args, lbm_uint argn) {
+  const uint8_t *data;
+  lbm_uint size;
+  uint32_t seed = 0;
+  uint32_t unused = 0;
+  if (argn > 2 || !dec_crc_args(args, argn, &data, &size, &seed, &unused)) return ENC_SYM_TERROR;
+  return lbm_enc_u32(xxh32(data, size, seed));
+}
+
+void lbm_checksum_extensions_init(void) {
+  lbm_add_extension("crc32", ext_crc32);
+  lbm_add_extension("crc32c", ext_crc32c);
+  lbm_add_extension("crc16", ext_crc16);
+  lbm_add_extension("crc8", ext_crc8);
+  lbm_add_extension("adler32", ext_adler32);
+  lbm_add_extension("fletcher16", ext_fletcher16);
+  lbm_add_extension("hash32", ext_hash32);
+}
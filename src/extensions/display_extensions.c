@@ -88,37 +88,37 @@ uint32_t lbm_display_rgb888_from_color(color_t color, int x, int y) {
   }
 }
 
-static lbm_uint symbol_indexed2 = 0;
-static lbm_uint symbol_indexed4 = 0;
-static lbm_uint symbol_indexed16 = 0;
-static lbm_uint symbol_rgb332 = 0;
-static lbm_uint symbol_rgb565 = 0;
-static lbm_uint symbol_rgb888 = 0;
-
-static lbm_uint symbol_thickness = 0;
-static lbm_uint symbol_filled = 0;
-static lbm_uint symbol_rounded = 0;
-static lbm_uint symbol_dotted = 0;
-static lbm_uint symbol_scale = 0;
-static lbm_uint symbol_rotate = 0;
-static lbm_uint symbol_resolution = 0;
-
-static lbm_uint symbol_regular = 0;
-static lbm_uint symbol_gradient_x = 0;
-static lbm_uint symbol_gradient_y = 0;
-static lbm_uint symbol_gradient_x_pre = 0;
-static lbm_uint symbol_gradient_y_pre = 0;
-static lbm_uint symbol_repeat = 0;
-static lbm_uint symbol_mirrored = 0;
-
-static lbm_uint symbol_color_0 = 0;
-static lbm_uint symbol_color_1 = 0;
-static lbm_uint symbol_width = 0;
-static lbm_uint symbol_offset = 0;
-static lbm_uint symbol_repeat_type = 0;
-
-static lbm_uint symbol_down = 0;
-static lbm_uint symbol_up = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_indexed2 = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_indexed4 = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_indexed16 = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_rgb332 = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_rgb565 = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_rgb888 = 0;
+
+static LBM_INSTANCE_LOCAL lbm_uint symbol_thickness = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_filled = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_rounded = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_dotted = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_scale = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_rotate = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_resolution = 0;
+
+static LBM_INSTANCE_LOCAL lbm_uint symbol_regular = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_gradient_x = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_gradient_y = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_gradient_x_pre = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_gradient_y_pre = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_repeat = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_mirrored = 0;
+
+static LBM_INSTANCE_LOCAL lbm_uint symbol_color_0 = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_color_1 = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_width = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_offset = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_repeat_type = 0;
+
+static LBM_INSTANCE_LOCAL lbm_uint symbol_down = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_up = 0;
 
 bool display_is_symbol_up(lbm_value v) {
   if (lbm_is_symbol(v)) {
@@ -829,9 +829,9 @@ static void line(image_buffer_t *img, int x0, int y0, int x1, int y1, int thickn
   if (dot1 > 0) {
     // These are used to deal with consecutive calls with
     // possibly overlapping pixels.
-    static int dotcnt = 0;
-    static int x_last = 0;
-    static int y_last = 0;
+    static LBM_INSTANCE_LOCAL int dotcnt = 0;
+    static LBM_INSTANCE_LOCAL int x_last = 0;
+    static LBM_INSTANCE_LOCAL int y_last = 0;
 
     while (true) {
       if (dotcnt <= dot1) {
@@ -2725,9 +2725,9 @@ bool display_dummy_render_image(image_buffer_t *img, uint16_t x, uint16_t y,  co
   return false;
 }
 
-static bool(* volatile disp_render_image)(image_buffer_t *img, uint16_t x, uint16_t y, color_t *colors) = display_dummy_render_image;
-static void(* volatile disp_clear)(uint32_t color) = display_dummy_clear;
-static void(* volatile disp_reset)(void) = display_dummy_reset;
+static LBM_INSTANCE_LOCAL bool(* volatile disp_render_image)(image_buffer_t *img, uint16_t x, uint16_t y, color_t *colors) = display_dummy_render_image;
+static LBM_INSTANCE_LOCAL void(* volatile disp_clear)(uint32_t color) = display_dummy_clear;
+static LBM_INSTANCE_LOCAL void(* volatile disp_reset)(void) = display_dummy_reset;
 
 static char *msg_not_supported = "Command not supported or display driver not initialized";
 
@@ -18,115 +18,115 @@
 
 #include <extensions.h>
 
+// Each table is sorted on name (in strcmp order) so that
+// lbm_dyn_lib_find can do a binary search. Keep it sorted when
+// adding entries.
+//
+// Some entries just bind a name to a builtin, such as filter to
+// builtin-filter. The name is then an ordinary global that programs
+// can redefine, while the work is done in C.
+typedef struct {
+  const char *name;
+  const char *code;
+} lbm_dyn_entry_t;
+
 #if defined(LBM_USE_DYN_FUNS) || defined(LBM_USE_DYN_ARRAYS)
-static const char* lbm_dyn_fun[] = {
+static const lbm_dyn_entry_t lbm_dyn_fun[] = {
 #ifdef LBM_USE_DYN_FUNS
-  "(defun str-merge () (str-join (rest-args)))",
-  "(defun iota (n) (range n))",
-
-  "(defun foldl (f init lst)"
-  "(if (eq lst nil) init (foldl f (f init (car lst)) (cdr lst))))",
-
-  "(defun foldr (f init lst)"
-  "(if (eq lst nil) init (f (car lst) (foldr f init (cdr lst)))))",
-
-  "(defun apply (f lst) (eval (cons f lst)))",
-
-  "(defun zipwith (f xs ys) "
-  "(let (( zip-acc (lambda (acc xs ys) "
-  "(if (and xs ys) "
-  "(zip-acc (cons (f (car xs) (car ys)) acc) (cdr xs) (cdr ys)) "
-  "acc)))) "
-  "(reverse (zip-acc nil xs ys))))",
-
-  "(defun zip (xs ys) "
-  "(zipwith cons xs ys))",
-
-  "(defun filter (f lst)"
-  "(let ((filter-rec (lambda (f lst ys)"
-  "(if (eq lst nil)"
-  "(reverse ys)"
-  "(if (f (car lst))"
-  "(filter-rec f (cdr lst) (cons (car lst) ys))"
-  "(filter-rec f (cdr lst) ys))))))"
-  "(filter-rec f lst nil)"
-  "))",
-
-  "(defun str-cmp-asc (a b) (< (str-cmp a b) 0))",
-  "(defun str-cmp-dsc (a b) (> (str-cmp a b) 0))",
-
-  "(defun second (x) (car (cdr x)))",
-  "(defun third (x) (car (cdr (cdr x))))",
-
-  "(defun abs (x) (if (< x 0) (- x) x))",
+  {"abs", "(defun abs (x) (if (< x 0) (- x) x))"},
 #ifdef LBM_USE_DYN_DEFSTRUCT
-  "(defun create-struct (dm name num-fields) { "
-  "(var arr (if dm (mkarray dm (+ 1 num-fields)) (mkarray (+ 1 num-fields)))) "
-  "(setix arr 0 name) "
-  "arr "
-  "})",
-
-  "(defun is-struct (struct name) "
-  "(and (eq (type-of struct) type-lisparray) "
-  "(eq (ix struct 0) name)))",
-
-  "(defun accessor-sym (name field) "
-  "(str2sym (str-merge name \"-\" (sym2str field))))",
-
-  "(defun access-set (i) "
-  "(lambda (struct) "
-  "(if (rest-args) "
-  "(setix struct i (rest-args 0)) "
-  "(ix struct i)))) ",
+  {"access-set",
+   "(defun access-set (i) "
+   "(lambda (struct) "
+   "(if (rest-args) "
+   "(setix struct i (rest-args 0)) "
+   "(ix struct i)))) "},
+
+  {"accessor-sym",
+   "(defun accessor-sym (name field) "
+   "(str2sym (str-merge name \"-\" (sym2str field))))"},
 #endif
+  {"apply", "(defun apply (f lst) (eval (cons f lst)))"},
 #endif //LBM_DYN_FUNS
 #ifdef LBM_USE_DYN_ARRAYS
-  "(defun list-to-array (ls)"
-  "(let ((n (length ls)) (arr (mkarray n)) (i 0)) {"
-  "(loopforeach e ls { (setix arr i e) (setq i (+ i 1)) }) arr }))",
-
-  "(defun array-to-list (arr)"
-  "(let ((n (length arr)) (ls nil)) {"
-  "(loopfor i (- n 1) (>= i 0) (- i 1) { (setq ls (cons (ix arr i) ls)) }) ls }))",
-
-  "(defun array? (a) (eq (type-of a) type-lisparray))",
+  {"array-to-list", "(define array-to-list builtin-array-to-list)"},
+  {"array?", "(defun array? (a) (eq (type-of a) type-lisparray))"},
+#endif
+#ifdef LBM_USE_DYN_FUNS
+#ifdef LBM_USE_DYN_DEFSTRUCT
+  {"create-struct",
+   "(defun create-struct (dm name num-fields) { "
+   "(var arr (if dm (mkarray dm (+ 1 num-fields)) (mkarray (+ 1 num-fields)))) "
+   "(setix arr 0 name) "
+   "arr "
+   "})"},
+#endif
+  {"filter", "(define filter builtin-filter)"},
+  {"foldl", "(define foldl builtin-foldl)"},
+  {"foldr", "(define foldr builtin-foldr)"},
+  {"iota", "(defun iota (n) (range n))"},
+#ifdef LBM_USE_DYN_DEFSTRUCT
+  {"is-struct",
+   "(defun is-struct (struct name) "
+   "(and (eq (type-of struct) type-lisparray) "
+   "(eq (ix struct 0) name)))"},
+#endif
+#endif //LBM_DYN_FUNS
+#ifdef LBM_USE_DYN_ARRAYS
+  {"list-to-array", "(define list-to-array builtin-list-to-array)"},
 #endif
+#ifdef LBM_USE_DYN_FUNS
+  {"second", "(defun second (x) (car (cdr x)))"},
+  {"str-cmp-asc", "(defun str-cmp-asc (a b) (< (str-cmp a b) 0))"},
+  {"str-cmp-dsc", "(defun str-cmp-dsc (a b) (> (str-cmp a b) 0))"},
+  {"str-merge", "(defun str-merge () (str-join (rest-args)))"},
+  {"third", "(defun third (x) (car (cdr (cdr x))))"},
+  {"zip", "(define zip builtin-zip)"},
+  {"zipwith",
+   "(defun zipwith (f xs ys) "
+   "(let (( zip-acc (lambda (acc xs ys) "
+   "(if (and xs ys) "
+   "(zip-acc (cons (f (car xs) (car ys)) acc) (cdr xs) (cdr ys)) "
+   "acc)))) "
+   "(reverse (zip-acc nil xs ys))))"},
+#endif //LBM_DYN_FUNS
 };
 #endif // defined(LBM_USE_DYN_FUNS) || defined(LBM_USE_DYN_ARRAYS)
 
 
 #ifdef LBM_USE_DYN_MACROS
-static const char* lbm_dyn_macros[] = {
-  "(define defun (macro (name args body) (me-defun name args body)))",
-  "(define defunret (macro (name args body) (me-defunret name args body)))",
-  "(define defmacro (macro (name args body) `(define ,name (macro ,args ,body))))",
-#ifdef LBM_USE_DYN_LOOPS
-  "(define loopfor (macro (it start cnd update body) (me-loopfor it start cnd update body)))",
-  "(define loopwhile (macro (cnd body) (me-loopwhile cnd body)))",
-  "(define looprange (macro (it start end body) (me-looprange it start end body)))",
-  "(define loopforeach (macro (it lst body) (me-loopforeach it lst body)))",
-  "(define loopwhile-thd (macro (stk cnd body) `(spawn ,@(if (list? stk) stk (list stk)) (fn () (loopwhile ,cnd ,body)))))",
-#endif
+static const lbm_dyn_entry_t lbm_dyn_macros[] = {
+  {"defmacro", "(define defmacro (macro (name args body) `(define ,name (macro ,args ,body))))"},
 #ifdef LBM_USE_DYN_DEFSTRUCT
-  "(define defstruct (macro (name list-of-fields)"
-  "{"
-  "(var num-fields (length list-of-fields))"
-  "(var name-as-string (sym2str name))"
-  "(var new-create-sym (str2sym (str-merge \"make-\" name-as-string)))"
-  "(var new-pred-sym (str2sym (str-merge name-as-string \"?\")))"
-  "(var field-ix (zip list-of-fields (range 1 (+ num-fields 1))))"
-  "`(progn"
-  "(define ,new-create-sym (lambda () (create-struct (rest-args 0) ',name ,num-fields)))"
-  "(define ,new-pred-sym (lambda (struct) (is-struct struct ',name)))"
-  ",@(map (lambda (x) (list define (accessor-sym name-as-string (car x))"
-  "(access-set (cdr x)))) field-ix)"
-  "'t"
-  ")"
-  "}))",
+  {"defstruct",
+   "(define defstruct (macro (name list-of-fields)"
+   "{"
+   "(var num-fields (length list-of-fields))"
+   "(var name-as-string (sym2str name))"
+   "(var new-create-sym (str2sym (str-merge \"make-\" name-as-string)))"
+   "(var new-pred-sym (str2sym (str-merge name-as-string \"?\")))"
+   "(var field-ix (zip list-of-fields (range 1 (+ num-fields 1))))"
+   "`(progn"
+   "(define ,new-create-sym (lambda () (create-struct (rest-args 0) ',name ,num-fields)))"
+   "(define ,new-pred-sym (lambda (struct) (is-struct struct ',name)))"
+   ",@(map (lambda (x) (list define (accessor-sym name-as-string (car x))"
+   "(access-set (cdr x)))) field-ix)"
+   "'t"
+   ")"
+   "}))"},
+#endif
+  {"defun", "(define defun (macro (name args body) (me-defun name args body)))"},
+  {"defunret", "(define defunret (macro (name args body) (me-defunret name args body)))"},
+#ifdef LBM_USE_DYN_LOOPS
+  {"loopfor", "(define loopfor (macro (it start cnd update body) (me-loopfor it start cnd update body)))"},
+  {"loopforeach", "(define loopforeach (macro (it lst body) (me-loopforeach it lst body)))"},
+  {"looprange", "(define looprange (macro (it start end body) (me-looprange it start end body)))"},
+  {"loopwhile", "(define loopwhile (macro (cnd body) (me-loopwhile cnd body)))"},
+  {"loopwhile-thd", "(define loopwhile-thd (macro (stk cnd body) `(spawn ,@(if (list? stk) stk (list stk)) (fn () (loopwhile ,cnd ,body)))))"},
 #endif
 };
 
-static lbm_uint sym_return;
+static LBM_INSTANCE_LOCAL lbm_uint sym_return;
 
 static lbm_value ext_me_defun(lbm_value *argsi, lbm_uint argn) {
   if (argn != 3) {
@@ -169,12 +169,12 @@ static lbm_value ext_me_defunret(lbm_value *argsi, lbm_uint argn) {
 // DYN LOOPS ////////////////////////////////////////////////////////////
 #ifdef LBM_USE_DYN_LOOPS
 
-static lbm_uint sym_res;
-static lbm_uint sym_loop;
-static lbm_uint sym_break;
-static lbm_uint sym_brk;
-static lbm_uint sym_rst;
-static lbm_uint sym_return;
+static LBM_INSTANCE_LOCAL lbm_uint sym_res;
+static LBM_INSTANCE_LOCAL lbm_uint sym_loop;
+static LBM_INSTANCE_LOCAL lbm_uint sym_break;
+static LBM_INSTANCE_LOCAL lbm_uint sym_brk;
+static LBM_INSTANCE_LOCAL lbm_uint sym_rst;
+static LBM_INSTANCE_LOCAL lbm_uint sym_return;
 
 static lbm_value ext_me_loopfor(lbm_value *args, lbm_uint argn) {
   if (argn != 5) {
@@ -345,29 +345,39 @@ void lbm_dyn_lib_init(void) {
 #endif
 }
 
+#if defined(LBM_USE_DYN_MACROS) || defined(LBM_USE_DYN_FUNS) || defined(LBM_USE_DYN_ARRAYS)
+static bool dyn_lib_lookup(const lbm_dyn_entry_t *table, unsigned int n, const char *str, const char **code) {
+  unsigned int lo = 0;
+  unsigned int hi = n;
+  while (lo < hi) {
+    unsigned int mid = lo + (hi - lo) / 2;
+    int c = strcmp(str, table[mid].name);
+    if (c == 0) {
+      *code = table[mid].code;
+      return true;
+    }
+    if (c < 0) hi = mid;
+    else lo = mid + 1;
+  }
+  return false;
+}
+#endif
+
 bool lbm_dyn_lib_find(const char *str, const char **code) {
-#ifndef LBM_USE_DYN_MACROS
-#ifndef LBM_USE_DYN_FUNS
+#if !defined(LBM_USE_DYN_MACROS) && !defined(LBM_USE_DYN_FUNS) && !defined(LBM_USE_DYN_ARRAYS)
   (void)str;
   (void)code;
 #endif
-#endif
 
 #ifdef LBM_USE_DYN_MACROS
-  for (unsigned int i = 0; i < (sizeof(lbm_dyn_macros) / sizeof(lbm_dyn_macros[0]));i++) {
-    if (strmatch(str, lbm_dyn_macros[i] + 8)) { // define is 6 char
-      *code = lbm_dyn_macros[i];
-      return true;
-    }
+  if (dyn_lib_lookup(lbm_dyn_macros, sizeof(lbm_dyn_macros) / sizeof(lbm_dyn_macros[0]), str, code)) {
+    return true;
   }
 #endif
 
 #if defined(LBM_USE_DYN_FUNS) || defined(LBM_USE_DYN_ARRAYS)
-  for (unsigned int i = 0; i < (sizeof(lbm_dyn_fun) / sizeof(lbm_dyn_fun[0]));i++) {
-    if (strmatch(str, lbm_dyn_fun[i] + 7)) { // defun is 5
-      *code = lbm_dyn_fun[i];
-      return true;
-    }
+  if (dyn_lib_lookup(lbm_dyn_fun, sizeof(lbm_dyn_fun) / sizeof(lbm_dyn_fun[0]), str, code)) {
+    return true;
   }
 #endif
   return false;
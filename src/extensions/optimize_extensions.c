@@ -0,0 +1,530 @@
+/*
+    Copyright 2025 Joel Svensson        svenssonjoel@yahoo.se
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "extensions/optimize_extensions.h"
+
+#include "extensions.h"
+#include "eval_cps.h"
+#include "env.h"
+#include "fundamental.h"
+
+// (optimize code [consts] [inline]) returns a copy of code where
+//  - applications of pure fundamentals to constant arguments are
+//    replaced by their result,
+//  - symbols listed in consts are replaced by their global value if
+//    that value is a number,
+//  - if expressions with a constant condition are replaced by the
+//    branch that would be taken,
+//  - calls to small global functions are inlined if inline is t or
+//    a list that names the function. Functions that use rest-args,
+//    eval, eval-program or setvar are never inlined.
+//
+// Code can also be a closure, then a closure with an optimized body is
+// returned. Quoted data, macro applications, patterns, binder names and
+// forms headed by an unbound symbol (that may later be loaded as a
+// macro) are left as they are. A symbol in consts that is bound
+// anywhere inside code is not inlined at all, the pass does not track
+// scope.
+//
+// The pass only conses, so running out of memory returns merror and
+// the evaluator retries it after GC.
+
+#define OPT_MAX_DEPTH   64
+#define OPT_MAX_ARGS    8
+#define OPT_INLINE_SIZE 24
+
+typedef struct {
+  lbm_value code;    // The whole input, to check for shadowing.
+  lbm_value env;     // Environment of the input closure.
+  lbm_value consts;
+  lbm_value inline_funs;
+  bool inline_all;
+} opt_state_t;
+
+static lbm_value opt_expr(lbm_value e, opt_state_t *st, int depth);
+
+static bool is_const_val(lbm_value v) {
+  return lbm_is_number(v) || v == ENC_SYM_NIL || v == ENC_SYM_TRUE;
+}
+
+static bool contains_sym(lbm_value e, lbm_value sym, int depth) {
+  if (depth > OPT_MAX_DEPTH) return true;
+  while (lbm_is_cons(e)) {
+    if (contains_sym(lbm_car(e), sym, depth + 1)) return true;
+    e = lbm_cdr(e);
+  }
+  return e == sym;
+}
+
+// Does e contain a form that binds sym. Errs on the side of true.
+static bool binds_sym(lbm_value e, lbm_value sym, int depth) {
+  if (depth > OPT_MAX_DEPTH) return true;
+  if (!lbm_is_cons(e)) return false;
+  lbm_value h = lbm_car(e);
+  if (h == ENC_SYM_QUOTE) return false;
+
+  lbm_value rest = lbm_cdr(e);
+  switch (lbm_is_symbol(h) ? lbm_dec_sym(h) : 0) {
+  case SYM_LAMBDA: /* fall through */
+  case SYM_MACRO:  /* fall through */
+  case SYM_CLOSURE:
+    if (contains_sym(lbm_car(rest), sym, 0)) return true;
+    break;
+  case SYM_DEFINE:    /* fall through */
+  case SYM_SETQ:      /* fall through */
+  case SYM_PROGN_VAR:
+    if (lbm_car(rest) == sym) return true;
+    break;
+  case SYM_LET: /* fall through */
+  case SYM_LOOP: {
+    lbm_value bs = lbm_car(rest);
+    while (lbm_is_cons(bs)) {
+      lbm_value b = lbm_car(bs);
+      if (contains_sym(lbm_is_cons(b) ? lbm_car(b) : b, sym, 0)) return true;
+      bs = lbm_cdr(bs);
+    }
+  } break;
+  case SYM_MATCH:           /* fall through */
+  case SYM_RECEIVE:         /* fall through */
+  case SYM_RECEIVE_TIMEOUT: {
+    lbm_value cs = (h == ENC_SYM_RECEIVE) ? rest : lbm_cdr(rest);
+    while (lbm_is_cons(cs)) {
+      if (contains_sym(lbm_car(lbm_car(cs)), sym, 0)) return true;
+      cs = lbm_cdr(cs);
+    }
+  } break;
+  default:
+    break;
+  }
+  while (lbm_is_cons(e)) {
+    if (binds_sym(lbm_car(e), sym, depth + 1)) return true;
+    e = lbm_cdr(e);
+  }
+  return false;
+}
+
+static bool is_member(lbm_value sym, lbm_value ls) {
+  while (lbm_is_cons(ls)) {
+    if (lbm_car(ls) == sym) return true;
+    ls = lbm_cdr(ls);
+  }
+  return false;
+}
+
+// Copy ls, optimizing every element from index keep onwards.
+static lbm_value opt_tail(lbm_value ls, int keep, opt_state_t *st, int depth) {
+  lbm_value res = ENC_SYM_NIL;
+  lbm_value last = ENC_SYM_NIL;
+  int i = 0;
+  while (lbm_is_cons(ls)) {
+    lbm_value v = lbm_car(ls);
+    if (i >= keep) {
+      v = opt_expr(v, st, depth + 1);
+      if (lbm_is_symbol_merror(v)) return v;
+    }
+    lbm_value cell = lbm_cons(v, ENC_SYM_NIL);
+    if (lbm_is_symbol_merror(cell)) return cell;
+    if (lbm_is_symbol_nil(res)) res = cell;
+    else lbm_set_cdr(last, cell);
+    last = cell;
+    ls = lbm_cdr(ls);
+    i++;
+  }
+  if (lbm_is_symbol_nil(res)) return ls;
+  lbm_set_cdr(last, ls);
+  return res;
+}
+
+// Copy a list of clauses or bindings, applying opt_tail(x, keep) to
+// each of them.
+static lbm_value opt_clauses(lbm_value ls, int keep, opt_state_t *st, int depth) {
+  lbm_value res = ENC_SYM_NIL;
+  lbm_value last = ENC_SYM_NIL;
+  while (lbm_is_cons(ls)) {
+    lbm_value v = opt_tail(lbm_car(ls), keep, st, depth + 1);
+    if (lbm_is_symbol_merror(v)) return v;
+    lbm_value cell = lbm_cons(v, ENC_SYM_NIL);
+    if (lbm_is_symbol_merror(cell)) return cell;
+    if (lbm_is_symbol_nil(res)) res = cell;
+    else lbm_set_cdr(last, cell);
+    last = cell;
+    ls = lbm_cdr(ls);
+  }
+  if (lbm_is_symbol_nil(res)) return ls;
+  lbm_set_cdr(last, ls);
+  return res;
+}
+
+// Rebuild (h x . rest) where rest is already processed.
+static lbm_value rebuild(lbm_value h, lbm_value x, lbm_value rest) {
+  if (lbm_is_symbol_merror(x)) return x;
+  if (lbm_is_symbol_merror(rest)) return rest;
+  lbm_value r = lbm_cons(x, rest);
+  if (lbm_is_symbol_merror(r)) return r;
+  return lbm_cons(h, r);
+}
+
+static bool is_foldable(lbm_uint s) {
+  switch (s) {
+  case SYM_ADD: case SYM_SUB: case SYM_MUL: case SYM_DIV: case SYM_MOD:
+  case SYM_INT_DIV:
+  case SYM_NUMEQ: case SYM_NUM_NOT_EQ:
+  case SYM_LT: case SYM_GT: case SYM_LEQ: case SYM_GEQ:
+  case SYM_TO_I: case SYM_TO_I32: case SYM_TO_U: case SYM_TO_U32:
+  case SYM_TO_FLOAT: case SYM_TO_I64: case SYM_TO_U64: case SYM_TO_DOUBLE:
+  case SYM_TO_BYTE:
+  case SYM_SHL: case SYM_SHR:
+  case SYM_BITWISE_AND: case SYM_BITWISE_OR: case SYM_BITWISE_XOR:
+  case SYM_BITWISE_NOT:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// These also accept nil and t as arguments.
+static bool is_foldable_logic(lbm_uint s) {
+  return s == SYM_NOT || s == SYM_EQ || s == SYM_NOT_EQ ||
+         s == SYM_IS_NUMBER || s == SYM_IDENTITY;
+}
+
+// Fold (f . args) if f is pure and all args are constants. Returns
+// the folded value or e if folding does not apply.
+static lbm_value fold(lbm_value e) {
+  lbm_uint s = lbm_dec_sym(lbm_car(e));
+  bool logic = is_foldable_logic(s);
+  if (!logic && !is_foldable(s)) return e;
+
+  lbm_value args[OPT_MAX_ARGS];
+  lbm_uint n = 0;
+  lbm_value curr = lbm_cdr(e);
+  while (lbm_is_cons(curr)) {
+    if (n == OPT_MAX_ARGS) return e;
+    lbm_value a = lbm_car(curr);
+    if (!(logic ? is_const_val(a) : lbm_is_number(a))) return e;
+    args[n++] = a;
+    curr = lbm_cdr(curr);
+  }
+  if (!lbm_is_symbol_nil(curr)) return e;
+
+  // Leave division by zero for run time to report.
+  if (s == SYM_DIV || s == SYM_MOD || s == SYM_INT_DIV) {
+    for (lbm_uint i = 1; i < n; i ++) {
+      if (lbm_dec_as_double(args[i]) == 0.0) return e;
+    }
+  }
+
+  lbm_value r = fundamental_table[SYMBOL_IX(s)](args, n, lbm_get_current_context());
+  if (lbm_is_symbol_merror(r)) return r;
+  if (lbm_is_error(r) || !is_const_val(r)) return e;
+  return r;
+}
+
+static lbm_value opt_symbol(lbm_value e, lbm_value consts) {
+  lbm_value v;
+  if (is_member(e, consts) &&
+      lbm_global_env_lookup(&v, e) &&
+      is_const_val(v)) {
+    return v;
+  }
+  return e;
+}
+
+static bool is_builtin(lbm_value sym) {
+  if (lbm_is_special(sym)) return true;
+  switch (SYMBOL_KIND(lbm_dec_sym(sym))) {
+  case SYMBOL_KIND_EXTENSION:   /* fall through */
+  case SYMBOL_KIND_FUNDAMENTAL: /* fall through */
+  case SYMBOL_KIND_APPFUN:
+    return true;
+  default:
+    return false;
+  }
+}
+
+static int code_size(lbm_value e, int limit) {
+  int n = 0;
+  while (lbm_is_cons(e) && n <= limit) {
+    n += 1 + code_size(lbm_car(e), limit - n);
+    e = lbm_cdr(e);
+  }
+  return n;
+}
+
+// Every global that body refers to must mean the same at the call
+// site, so none of them may be bound anywhere in the code being
+// optimized.
+static bool is_shadowed(lbm_value sym, opt_state_t *st) {
+  lbm_value v;
+  return binds_sym(st->code, sym, 0) || lbm_env_lookup_b(&v, sym, st->env);
+}
+
+static bool refs_unshadowed(lbm_value body, lbm_value params, opt_state_t *st) {
+  if (lbm_is_symbol(body)) {
+    return (is_builtin(body) ||
+            is_member(body, params) ||
+            !is_shadowed(body, st));
+  }
+  while (lbm_is_cons(body)) {
+    if (!refs_unshadowed(lbm_car(body), params, st)) return false;
+    body = lbm_cdr(body);
+  }
+  return !lbm_is_symbol(body) || refs_unshadowed(body, params, st);
+}
+
+// Forms that look at the environment they are evaluated in. Inlined,
+// they would see the environment of the call site instead of the one
+// the closure sets up, (rest-args) for example the caller's.
+static const lbm_value env_dependent[] = {
+  ENC_SYM_REST_ARGS,
+  ENC_SYM_EVAL,
+  ENC_SYM_EVAL_PROGRAM,
+  ENC_SYM_SETVAR,
+};
+
+static bool is_env_dependent(lbm_value body) {
+  for (unsigned int i = 0; i < sizeof(env_dependent) / sizeof(env_dependent[0]); i ++) {
+    if (contains_sym(body, env_dependent[i], 0)) return true;
+  }
+  return false;
+}
+
+// Return the closure that (f . args) can be inlined from, or nil.
+static lbm_value inline_candidate(lbm_value e, opt_state_t *st) {
+  lbm_value f = lbm_car(e);
+  lbm_value clo;
+  if (!(st->inline_all || is_member(f, st->inline_funs)) ||
+      !lbm_global_env_lookup(&clo, f) ||
+      !lbm_is_closure(clo)) {
+    return ENC_SYM_NIL;
+  }
+  // (closure params body env)
+  lbm_value params = lbm_car(lbm_cdr(clo));
+  lbm_value body = lbm_car(lbm_cdr(lbm_cdr(clo)));
+  lbm_value env = lbm_car(lbm_cdr(lbm_cdr(lbm_cdr(clo))));
+  if (!lbm_is_symbol_nil(env) ||
+      code_size(body, OPT_INLINE_SIZE) > OPT_INLINE_SIZE ||
+      contains_sym(body, f, 0) ||
+      is_env_dependent(body) ||
+      is_shadowed(f, st)) {
+    return ENC_SYM_NIL;
+  }
+
+  lbm_value p = params;
+  lbm_value a = lbm_cdr(e);
+  while (lbm_is_cons(p) && lbm_is_cons(a)) {
+    lbm_value sym = lbm_car(p);
+    if (!lbm_is_symbol(sym) || is_builtin(sym)) return ENC_SYM_NIL;
+    // An argument that mentions a parameter would be captured by the
+    // let that binds the parameters.
+    lbm_value as = lbm_cdr(e);
+    while (lbm_is_cons(as)) {
+      if (contains_sym(lbm_car(as), sym, 0)) return ENC_SYM_NIL;
+      as = lbm_cdr(as);
+    }
+    p = lbm_cdr(p);
+    a = lbm_cdr(a);
+  }
+  if (!lbm_is_symbol_nil(p) || !lbm_is_symbol_nil(a)) return ENC_SYM_NIL;
+  if (!refs_unshadowed(body, params, st)) return ENC_SYM_NIL;
+  return clo;
+}
+
+// Inline (f . args), where args are already optimized, as
+//   (if (eq f 'clo) (let ((p a) ...) body) (f . args))
+// The guard compares the current global value of f with the closure
+// that was inlined. It is the same heap cell until f is redefined, so
+// eq succeeds at once, and after a redefinition the new f is called.
+static lbm_value inline_call(lbm_value e, lbm_value clo, opt_state_t *st, int depth) {
+  lbm_value params = lbm_car(lbm_cdr(clo));
+  lbm_value body = lbm_car(lbm_cdr(lbm_cdr(clo)));
+
+  // The body is only folded, not inlined into again.
+  opt_state_t body_st = *st;
+  body_st.inline_all = false;
+  body_st.inline_funs = ENC_SYM_NIL;
+  lbm_value b = opt_expr(body, &body_st, depth + 1);
+  if (lbm_is_symbol_merror(b)) return b;
+
+  lbm_value inl = b;
+  if (lbm_is_cons(params)) {
+    lbm_value binds = ENC_SYM_NIL;
+    lbm_value p = params;
+    lbm_value a = lbm_cdr(e);
+    while (lbm_is_cons(p)) {
+      lbm_value bind = rebuild(lbm_car(p), lbm_car(a), ENC_SYM_NIL);
+      if (lbm_is_symbol_merror(bind)) return bind;
+      binds = lbm_cons(bind, binds);
+      if (lbm_is_symbol_merror(binds)) return binds;
+      p = lbm_cdr(p);
+      a = lbm_cdr(a);
+    }
+    binds = lbm_list_destructive_reverse(binds);
+    inl = rebuild(ENC_SYM_LET, binds, lbm_cons(b, ENC_SYM_NIL));
+    if (lbm_is_symbol_merror(inl)) return inl;
+  }
+
+  lbm_value q = rebuild(ENC_SYM_QUOTE, clo, ENC_SYM_NIL);
+  if (lbm_is_symbol_merror(q)) return q;
+  lbm_value guard = rebuild(ENC_SYM_EQ, lbm_car(e), lbm_cons(q, ENC_SYM_NIL));
+  if (lbm_is_symbol_merror(guard)) return guard;
+  lbm_value branches = lbm_cons(e, ENC_SYM_NIL);
+  if (lbm_is_symbol_merror(branches)) return branches;
+  return rebuild(ENC_SYM_IF, guard, lbm_cons(inl, branches));
+}
+
+// Is sym the head of a form that must be left as it is, a macro
+// application or a symbol with no binding that may be loaded later.
+static bool is_opaque_head(lbm_value h) {
+  lbm_value v;
+  if (is_builtin(h)) return false;
+  if (lbm_global_env_lookup(&v, h)) return lbm_is_macro(v);
+  return true;
+}
+
+static lbm_value opt_expr(lbm_value e, opt_state_t *st, int depth) {
+  if (depth > OPT_MAX_DEPTH) return e;
+  if (lbm_is_symbol(e)) return opt_symbol(e, st->consts);
+  if (!lbm_is_cons(e)) return e;
+
+  lbm_value h = lbm_car(e);
+  lbm_value rest = lbm_cdr(e);
+
+  if (!lbm_is_symbol(h)) {
+    return opt_tail(e, 0, st, depth);
+  }
+
+  lbm_uint s = lbm_dec_sym(h);
+  switch (s) {
+  case SYM_IF: {
+    lbm_value c = opt_expr(lbm_car(rest), st, depth + 1);
+    if (lbm_is_symbol_merror(c)) return c;
+    if (is_const_val(c)) {
+      lbm_value branch = lbm_is_symbol_nil(c) ? lbm_car(lbm_cdr(lbm_cdr(rest))) : lbm_car(lbm_cdr(rest));
+      return opt_expr(branch, st, depth + 1);
+    }
+    return rebuild(h, c, opt_tail(lbm_cdr(rest), 0, st, depth));
+  }
+  case SYM_LAMBDA:    /* fall through */
+  case SYM_DEFINE:    /* fall through */
+  case SYM_SETQ:      /* fall through */
+  case SYM_PROGN_VAR:
+    return opt_tail(e, 2, st, depth);
+  case SYM_LET:  /* fall through */
+  case SYM_LOOP:
+    return rebuild(h,
+                   opt_clauses(lbm_car(rest), 1, st, depth),
+                   opt_tail(lbm_cdr(rest), 0, st, depth));
+  case SYM_MATCH:           /* fall through */
+  case SYM_RECEIVE_TIMEOUT:
+    return rebuild(h,
+                   opt_expr(lbm_car(rest), st, depth + 1),
+                   opt_clauses(lbm_cdr(rest), 1, st, depth));
+  case SYM_RECEIVE: {
+    lbm_value cs = opt_clauses(rest, 1, st, depth);
+    if (lbm_is_symbol_merror(cs)) return cs;
+    return lbm_cons(h, cs);
+  }
+  case SYM_COND: {
+    lbm_value cs = opt_clauses(rest, 0, st, depth);
+    if (lbm_is_symbol_merror(cs)) return cs;
+    return lbm_cons(h, cs);
+  }
+  case SYM_PROGN:          /* fall through */
+  case SYM_AND:            /* fall through */
+  case SYM_OR:             /* fall through */
+  case SYM_CALLCC:         /* fall through */
+  case SYM_CALL_CC_UNSAFE: /* fall through */
+  case SYM_CALL_CC_COPY:   /* fall through */
+  case SYM_ATOMIC:         /* fall through */
+  case SYM_TRAP:
+    return opt_tail(e, 1, st, depth);
+  default:
+    break;
+  }
+
+  // Remaining special forms (quote, macro, closure, move-to-flash, ...)
+  if (lbm_is_special(h) || is_opaque_head(h)) return e;
+
+  lbm_value r = opt_tail(e, 1, st, depth);
+  if (!lbm_is_cons(r)) return r;
+  if (SYMBOL_KIND(s) == SYMBOL_KIND_FUNDAMENTAL) {
+    return fold(r);
+  }
+  if (!is_builtin(h)) {
+    lbm_value clo = inline_candidate(r, st);
+    if (lbm_is_closure(clo)) return inline_call(r, clo, st, depth);
+  }
+  return r;
+}
+
+// Keep the symbols of consts that are not bound in code.
+static lbm_value usable_consts(lbm_value consts, lbm_value code, lbm_value env) {
+  lbm_value res = ENC_SYM_NIL;
+  while (lbm_is_cons(consts)) {
+    lbm_value sym = lbm_car(consts);
+    lbm_value v;
+    if (lbm_is_symbol(sym) &&
+        !binds_sym(code, sym, 0) &&
+        !lbm_env_lookup_b(&v, sym, env)) {
+      res = lbm_cons(sym, res);
+      if (lbm_is_symbol_merror(res)) return res;
+    }
+    consts = lbm_cdr(consts);
+  }
+  return res;
+}
+
+static lbm_value ext_optimize(lbm_value *args, lbm_uint argn) {
+  if (argn < 1 || argn > 3 ||
+      (argn >= 2 && !lbm_is_list(args[1])) ||
+      (argn == 3 && !lbm_is_list(args[2]) && args[2] != ENC_SYM_TRUE)) {
+    return ENC_SYM_TERROR;
+  }
+  opt_state_t st;
+  st.code = args[0];
+  st.env = ENC_SYM_NIL;
+  st.inline_all = argn == 3 && args[2] == ENC_SYM_TRUE;
+  st.inline_funs = (argn == 3 && !st.inline_all) ? args[2] : ENC_SYM_NIL;
+
+  lbm_value code = args[0];
+  lbm_value consts_in = argn >= 2 ? args[1] : ENC_SYM_NIL;
+
+  if (lbm_is_closure(code)) {
+    // (closure params body env)
+    lbm_value params = lbm_car(lbm_cdr(code));
+    lbm_value body = lbm_car(lbm_cdr(lbm_cdr(code)));
+    st.env = lbm_car(lbm_cdr(lbm_cdr(lbm_cdr(code))));
+    st.consts = usable_consts(consts_in, code, st.env);
+    if (lbm_is_symbol_merror(st.consts)) return st.consts;
+    lbm_value b = opt_expr(body, &st, 0);
+    if (lbm_is_symbol_merror(b)) return b;
+    lbm_value r = lbm_cons(st.env, ENC_SYM_NIL);
+    if (lbm_is_symbol_merror(r)) return r;
+    r = lbm_cons(b, r);
+    if (lbm_is_symbol_merror(r)) return r;
+    return rebuild(ENC_SYM_CLOSURE, params, r);
+  }
+
+  st.consts = usable_consts(consts_in, code, ENC_SYM_NIL);
+  if (lbm_is_symbol_merror(st.consts)) return st.consts;
+  return opt_expr(code, &st, 0);
+}
+
+void lbm_optimize_extensions_init(void) {
+  lbm_add_extension("optimize", ext_optimize);
+}
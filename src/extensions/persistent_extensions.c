@@ -0,0 +1,658 @@
+/*
+    Copyright 2025 Joel Svensson        svenssonjoel@yahoo.se
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "extensions/persistent_extensions.h"
+
+#include "extensions.h"
+#include "fundamental.h"
+
+// Persistent vectors and maps.
+//
+// Both structures are trees of lisp arrays. An update copies the nodes
+// on the path from the root to the changed element and shares all
+// other nodes with the previous version. No node is ever modified
+// after it has been returned to lisp. Nodes are tagged $persistent in
+// the cdr of their heap cell, which makes them read-only to setix and
+// the other array mutators.
+//
+// unflatten gives back plain arrays and anyone can build an array that
+// looks like a header, so a node is checked every time it is read and
+// a malformed tree results in a type error.
+//
+// A vector is [| $pvec count shift root |]. The root is a tree with
+// PVEC_WIDTH children per node where the elements are in the leaves.
+// Element i is found by taking PVEC_BITS bits of i at a time starting
+// at bit shift. Nodes hold only as many children as are in use.
+//
+// A map is [| $pmap count root |]. The root is a hash array mapped trie
+// where each node is [| bitmap slot ... |]. The bitmap tells which of
+// the PMAP_WIDTH hash fragments are present and the slots are stored
+// in fragment order. A slot is either a child node or a bucket, a list
+// of (key . value) pairs whose keys have the same hash. The bitmap is
+// kept in an unboxed lbm_enc_u which limits the width to 16 on 32 bit
+// platforms.
+
+#define PVEC_BITS   5
+#define PVEC_WIDTH  (1 << PVEC_BITS)
+#define PVEC_MASK   (PVEC_WIDTH - 1)
+
+#define PMAP_BITS   4
+#define PMAP_WIDTH  (1 << PMAP_BITS)
+#define PMAP_MASK   (PMAP_WIDTH - 1)
+#define PMAP_HASH_BITS 32
+
+#define PVEC_COUNT 1
+#define PVEC_SHIFT 2
+#define PVEC_ROOT  3
+#define PVEC_SIZE  4
+
+#define PMAP_COUNT 1
+#define PMAP_ROOT  2
+#define PMAP_SIZE  3
+
+#define HASH_MAX_DEPTH 8
+
+static LBM_INSTANCE_LOCAL lbm_uint sym_pvec = 0;
+static LBM_INSTANCE_LOCAL lbm_uint sym_pmap = 0;
+
+// ////////////////////////////////////////////////////////////
+// Helpers
+
+static lbm_uint node_len(lbm_value node) {
+  lbm_array_header_t *arr = lbm_dec_lisp_array_r(node);
+  return arr ? arr->size / sizeof(lbm_value) : 0;
+}
+
+// Only for nodes that are known to be lisp arrays.
+static lbm_value *node_data(lbm_value node) {
+  return (lbm_value*)lbm_dec_lisp_array_r(node)->data;
+}
+
+// The elements of node if it is a lisp array of at least n elements.
+static lbm_value *node_elts(lbm_value node, lbm_uint n) {
+  lbm_array_header_t *arr = lbm_dec_lisp_array_r(node);
+  if (arr && arr->size >= n * sizeof(lbm_value)) {
+    return (lbm_value*)arr->data;
+  }
+  return NULL;
+}
+
+static lbm_value node_alloc(lbm_uint n) {
+  lbm_value res;
+  if (lbm_heap_allocate_lisp_array(&res, n)) {
+    lbm_ref_cell(res)->cdr = ENC_SYM_PERSISTENT_TYPE;
+  }
+  return res;
+}
+
+// Allocate an array of n elements with the first m copied from node.
+static lbm_value node_copy(lbm_value node, lbm_uint n, lbm_uint m) {
+  lbm_value res = node_alloc(n);
+  if (lbm_is_symbol_merror(res)) return res;
+  if (m > 0) {
+    memcpy(node_data(res), node_data(node), m * sizeof(lbm_value));
+  }
+  return res;
+}
+
+static lbm_value *dec_tagged(lbm_value v, lbm_uint tag, lbm_uint size) {
+  lbm_array_header_t *arr = lbm_dec_lisp_array_r(v);
+  if (arr && arr->size == size * sizeof(lbm_value)) {
+    lbm_value *data = (lbm_value*)arr->data;
+    if (data[0] == lbm_enc_sym(tag)) return data;
+  }
+  return NULL;
+}
+
+static lbm_value *dec_pvec(lbm_value v) {
+  lbm_value *data = dec_tagged(v, sym_pvec, PVEC_SIZE);
+  if (data &&
+      lbm_type_of(data[PVEC_COUNT]) == LBM_TYPE_U &&
+      lbm_type_of(data[PVEC_SHIFT]) == LBM_TYPE_U) {
+    lbm_uint shift = lbm_dec_u(data[PVEC_SHIFT]);
+    if (shift % PVEC_BITS == 0 && shift < sizeof(lbm_uint) * 8) return data;
+  }
+  return NULL;
+}
+
+static lbm_value *dec_pmap(lbm_value v) {
+  lbm_value *data = dec_tagged(v, sym_pmap, PMAP_SIZE);
+  if (data && lbm_type_of(data[PMAP_COUNT]) == LBM_TYPE_U) return data;
+  return NULL;
+}
+
+static lbm_value mk_tagged(lbm_uint tag, lbm_uint size) {
+  lbm_value res = node_alloc(size);
+  if (lbm_is_symbol_merror(res)) return res;
+  node_data(res)[0] = lbm_enc_sym(tag);
+  return res;
+}
+
+// ////////////////////////////////////////////////////////////
+// Vector
+
+static lbm_value pvec_node_set(lbm_value node, lbm_uint shift, lbm_uint i, lbm_value val) {
+  lbm_uint idx = (i >> shift) & PVEC_MASK;
+  lbm_uint n = node_len(node);
+  lbm_value res = node_copy(node, idx < n ? n : idx + 1, n);
+  if (lbm_is_symbol_merror(res)) return res;
+  if (shift == 0) {
+    node_data(res)[idx] = val;
+  } else {
+    lbm_value child = idx < n ? node_data(node)[idx] : ENC_SYM_NIL;
+    lbm_value c = pvec_node_set(child, shift - PVEC_BITS, i, val);
+    if (lbm_is_error(c)) return c;
+    node_data(res)[idx] = c;
+  }
+  return res;
+}
+
+static lbm_value pvec_make(lbm_uint count, lbm_uint shift, lbm_value root) {
+  lbm_value res = mk_tagged(sym_pvec, PVEC_SIZE);
+  if (lbm_is_symbol_merror(res)) return res;
+  lbm_value *data = node_data(res);
+  data[PVEC_COUNT] = lbm_enc_u(count);
+  data[PVEC_SHIFT] = lbm_enc_u(shift);
+  data[PVEC_ROOT] = root;
+  return res;
+}
+
+// Build a vector from n values taken from vals, or from list when
+// vals is NULL.
+static lbm_value pvec_build(lbm_value *vals, lbm_value list, lbm_uint n) {
+  if (n == 0) return pvec_make(0, 0, ENC_SYM_NIL);
+
+  // Leaves
+  lbm_uint num = (n + PVEC_WIDTH - 1) / PVEC_WIDTH;
+  lbm_value level = ENC_SYM_NIL;
+  lbm_value tail = ENC_SYM_NIL;
+  for (lbm_uint j = 0; j < num; j ++) {
+    lbm_uint start = j * PVEC_WIDTH;
+    lbm_uint len = n - start < PVEC_WIDTH ? n - start : PVEC_WIDTH;
+    lbm_value leaf = node_alloc(len);
+    if (lbm_is_symbol_merror(leaf)) return leaf;
+    for (lbm_uint k = 0; k < len; k ++) {
+      if (vals) {
+        node_data(leaf)[k] = vals[start + k];
+      } else {
+        node_data(leaf)[k] = lbm_car(list);
+        list = lbm_cdr(list);
+      }
+    }
+    lbm_value cell = lbm_cons(leaf, ENC_SYM_NIL);
+    if (lbm_is_symbol_merror(cell)) return cell;
+    if (lbm_is_symbol_nil(tail)) {
+      level = cell;
+    } else {
+      lbm_set_cdr(tail, cell);
+    }
+    tail = cell;
+  }
+
+  // Inner levels, until a single root remains.
+  lbm_uint shift = 0;
+  while (num > 1) {
+    lbm_uint parents = (num + PVEC_WIDTH - 1) / PVEC_WIDTH;
+    lbm_value next = ENC_SYM_NIL;
+    tail = ENC_SYM_NIL;
+    lbm_value curr = level;
+    for (lbm_uint j = 0; j < parents; j ++) {
+      lbm_uint len = num - j * PVEC_WIDTH < PVEC_WIDTH ? num - j * PVEC_WIDTH : PVEC_WIDTH;
+      lbm_value node = node_alloc(len);
+      if (lbm_is_symbol_merror(node)) return node;
+      for (lbm_uint k = 0; k < len; k ++) {
+        node_data(node)[k] = lbm_car(curr);
+        curr = lbm_cdr(curr);
+      }
+      lbm_value cell = lbm_cons(node, ENC_SYM_NIL);
+      if (lbm_is_symbol_merror(cell)) return cell;
+      if (lbm_is_symbol_nil(tail)) {
+        next = cell;
+      } else {
+        lbm_set_cdr(tail, cell);
+      }
+      tail = cell;
+    }
+    level = next;
+    num = parents;
+    shift += PVEC_BITS;
+  }
+  return pvec_make(n, shift, lbm_car(level));
+}
+
+// signature: (pvec val1 ... valN) -> pvec
+static lbm_value ext_pvec(lbm_value *args, lbm_uint argn) {
+  return pvec_build(args, ENC_SYM_NIL, argn);
+}
+
+// signature: (list-to-pvec list) -> pvec
+static lbm_value ext_list_to_pvec(lbm_value *args, lbm_uint argn) {
+  if (argn != 1 || !lbm_is_list(args[0])) return ENC_SYM_TERROR;
+  return pvec_build(NULL, args[0], lbm_list_length(args[0]));
+}
+
+// signature: (pvec-len pvec) -> int
+static lbm_value ext_pvec_len(lbm_value *args, lbm_uint argn) {
+  lbm_value *v;
+  if (argn != 1 || !(v = dec_pvec(args[0]))) return ENC_SYM_TERROR;
+  return lbm_enc_i((lbm_int)lbm_dec_u(v[PVEC_COUNT]));
+}
+
+// signature: (pvec-ref pvec index) -> value
+static lbm_value ext_pvec_ref(lbm_value *args, lbm_uint argn) {
+  lbm_value *v;
+  if (argn != 2 ||
+      !(v = dec_pvec(args[0])) ||
+      !lbm_is_number(args[1])) {
+    return ENC_SYM_TERROR;
+  }
+  lbm_uint count = lbm_dec_u(v[PVEC_COUNT]);
+  lbm_int i = lbm_dec_as_i32(args[1]);
+  if (i < 0) i += (lbm_int)count;
+  if (i < 0 || (lbm_uint)i >= count) return ENC_SYM_EERROR;
+  lbm_value node = v[PVEC_ROOT];
+  for (lbm_uint shift = lbm_dec_u(v[PVEC_SHIFT]); ; shift -= PVEC_BITS) {
+    lbm_uint idx = ((lbm_uint)i >> shift) & PVEC_MASK;
+    lbm_value *data = node_elts(node, idx + 1);
+    if (!data) return ENC_SYM_TERROR;
+    node = data[idx];
+    if (shift == 0) break;
+  }
+  return node;
+}
+
+// signature: (pvec-set pvec index value) -> pvec
+static lbm_value ext_pvec_set(lbm_value *args, lbm_uint argn) {
+  lbm_value *v;
+  if (argn != 3 ||
+      !(v = dec_pvec(args[0])) ||
+      !lbm_is_number(args[1])) {
+    return ENC_SYM_TERROR;
+  }
+  lbm_uint count = lbm_dec_u(v[PVEC_COUNT]);
+  lbm_int i = lbm_dec_as_i32(args[1]);
+  if (i < 0) i += (lbm_int)count;
+  if (i < 0 || (lbm_uint)i >= count) return ENC_SYM_EERROR;
+  lbm_uint shift = lbm_dec_u(v[PVEC_SHIFT]);
+  lbm_value root = pvec_node_set(v[PVEC_ROOT], shift, (lbm_uint)i, args[2]);
+  if (lbm_is_error(root)) return root;
+  return pvec_make(count, shift, root);
+}
+
+// signature: (pvec-push pvec value) -> pvec
+static lbm_value ext_pvec_push(lbm_value *args, lbm_uint argn) {
+  lbm_value *v;
+  if (argn != 2 || !(v = dec_pvec(args[0]))) return ENC_SYM_TERROR;
+  lbm_uint count = lbm_dec_u(v[PVEC_COUNT]);
+  lbm_uint shift = lbm_dec_u(v[PVEC_SHIFT]);
+  lbm_value root = v[PVEC_ROOT];
+  if (count > 0 && (count >> shift) == PVEC_WIDTH) {
+    // The tree is full, add a level on top.
+    if (shift + PVEC_BITS >= sizeof(lbm_uint) * 8) return ENC_SYM_MERROR;
+    lbm_value top = node_alloc(1);
+    if (lbm_is_symbol_merror(top)) return top;
+    node_data(top)[0] = root;
+    root = top;
+    shift += PVEC_BITS;
+  }
+  root = pvec_node_set(root, shift, count, args[1]);
+  if (lbm_is_error(root)) return root;
+  return pvec_make(count + 1, shift, root);
+}
+
+// Fill the list cells starting at out with the elements under node.
+static lbm_value pvec_collect(lbm_value node, lbm_uint shift, lbm_value out) {
+  lbm_uint n = node_len(node);
+  for (lbm_uint i = 0; i < n && lbm_is_cons(out); i ++) {
+    if (shift == 0) {
+      lbm_set_car(out, node_data(node)[i]);
+      out = lbm_cdr(out);
+    } else {
+      out = pvec_collect(node_data(node)[i], shift - PVEC_BITS, out);
+    }
+  }
+  return out;
+}
+
+// signature: (pvec-to-list pvec) -> list
+static lbm_value ext_pvec_to_list(lbm_value *args, lbm_uint argn) {
+  lbm_value *v;
+  if (argn != 1 || !(v = dec_pvec(args[0]))) return ENC_SYM_TERROR;
+  lbm_uint count = lbm_dec_u(v[PVEC_COUNT]);
+  if (count == 0) return ENC_SYM_NIL;
+  lbm_value res = lbm_heap_allocate_list(count);
+  if (lbm_is_symbol_merror(res)) return res;
+  pvec_collect(v[PVEC_ROOT], lbm_dec_u(v[PVEC_SHIFT]), res);
+  return res;
+}
+
+// ////////////////////////////////////////////////////////////
+// Map
+
+// Hash consistent with eq. Numbers of different types that eq
+// distinguishes may hash equal, which only costs a bucket compare.
+static uint32_t hash_bytes(uint32_t h, const uint8_t *data, lbm_uint n) {
+  for (lbm_uint i = 0; i < n; i ++) {
+    h = (h ^ data[i]) * 16777619u;
+  }
+  return h;
+}
+
+static uint32_t pmap_hash(lbm_value v, int depth) {
+  uint32_t h = 2166136261u;
+  if (depth > HASH_MAX_DEPTH) return h;
+  if (lbm_is_number(v)) {
+    lbm_type t = lbm_type_of(v);
+    if (t == LBM_TYPE_FLOAT || t == LBM_TYPE_DOUBLE) {
+      double d = lbm_dec_as_double(v);
+      return hash_bytes(h, (uint8_t*)&d, sizeof(d));
+    }
+    int64_t i = lbm_dec_as_i64(v);
+    return hash_bytes(h, (uint8_t*)&i, sizeof(i));
+  }
+  if (lbm_is_cons(v)) {
+    return pmap_hash(lbm_car(v), depth + 1) * 31u + pmap_hash(lbm_cdr(v), depth + 1);
+  }
+  lbm_array_header_t *arr = lbm_dec_array_r(v);
+  if (arr) {
+    // A string and a view of it that lacks the zero terminator are eq.
+    lbm_uint n = arr->size;
+    if (n > 0 && ((uint8_t*)arr->data)[n - 1] == 0) n --;
+    return hash_bytes(h, (uint8_t*)arr->data, n);
+  }
+  arr = lbm_dec_lisp_array_r(v);
+  if (arr) {
+    lbm_uint n = arr->size / sizeof(lbm_value);
+    for (lbm_uint i = 0; i < n; i ++) {
+      h = h * 31u + pmap_hash(((lbm_value*)arr->data)[i], depth + 1);
+    }
+    return h;
+  }
+  return hash_bytes(h, (uint8_t*)&v, sizeof(v));
+}
+
+static lbm_uint popcount(lbm_uint x) {
+  lbm_uint n = 0;
+  while (x) {
+    x &= x - 1;
+    n ++;
+  }
+  return n;
+}
+
+static lbm_value bucket_find(lbm_value bucket, lbm_value key) {
+  for (lbm_value curr = bucket; lbm_is_cons(curr); curr = lbm_cdr(curr)) {
+    if (struct_eq(lbm_car(lbm_car(curr)), key)) return lbm_car(curr);
+  }
+  return ENC_SYM_NIL;
+}
+
+// Copy of bucket without the pair for key.
+static lbm_value bucket_remove(lbm_value bucket, lbm_value key) {
+  if (!lbm_is_cons(bucket)) return ENC_SYM_NIL;
+  if (struct_eq(lbm_car(lbm_car(bucket)), key)) return lbm_cdr(bucket);
+  lbm_value rest = bucket_remove(lbm_cdr(bucket), key);
+  if (lbm_is_symbol_merror(rest)) return rest;
+  return lbm_cons(lbm_car(bucket), rest);
+}
+
+// The bitmap of a map node, or NULL if node is not a node with one
+// slot per bit set in its bitmap.
+static lbm_value *pmap_node_elts(lbm_value node, lbm_uint shift, lbm_uint *bitmap) {
+  if (shift >= PMAP_HASH_BITS) return NULL;
+  lbm_value *data = node_elts(node, 1);
+  if (!data || lbm_type_of(data[0]) != LBM_TYPE_U) return NULL;
+  *bitmap = lbm_dec_u(data[0]);
+  if (node_len(node) != popcount(*bitmap) + 1) return NULL;
+  return data;
+}
+
+// Copy of node with a slot inserted, replaced or removed at position pos.
+static lbm_value pmap_node_update(lbm_value node, lbm_uint bitmap, lbm_uint pos, lbm_value slot, int change) {
+  lbm_uint n = node_len(node);
+  lbm_value res = node_alloc((lbm_uint)((lbm_int)n + change));
+  if (lbm_is_symbol_merror(res)) return res;
+  lbm_value *src = node_data(node);
+  lbm_value *dst = node_data(res);
+  dst[0] = lbm_enc_u(bitmap);
+  if (change > 0) {
+    memcpy(dst + 1, src + 1, (pos - 1) * sizeof(lbm_value));
+    dst[pos] = slot;
+    memcpy(dst + pos + 1, src + pos, (n - pos) * sizeof(lbm_value));
+  } else if (change < 0) {
+    memcpy(dst + 1, src + 1, (pos - 1) * sizeof(lbm_value));
+    memcpy(dst + pos, src + pos + 1, (n - pos - 1) * sizeof(lbm_value));
+  } else {
+    memcpy(dst + 1, src + 1, (n - 1) * sizeof(lbm_value));
+    dst[pos] = slot;
+  }
+  return res;
+}
+
+static lbm_value pmap_node_set(lbm_value node, uint32_t hash, lbm_uint shift, lbm_value pair, bool *added) {
+  lbm_uint bit = (lbm_uint)1 << ((hash >> shift) & PMAP_MASK);
+  if (lbm_is_symbol_nil(node)) {
+    lbm_value res = node_alloc(2);
+    if (lbm_is_symbol_merror(res)) return res;
+    lbm_value bucket = lbm_cons(pair, ENC_SYM_NIL);
+    if (lbm_is_symbol_merror(bucket)) return bucket;
+    node_data(res)[0] = lbm_enc_u(bit);
+    node_data(res)[1] = bucket;
+    *added = true;
+    return res;
+  }
+  lbm_uint bitmap;
+  lbm_value *data = pmap_node_elts(node, shift, &bitmap);
+  if (!data) return ENC_SYM_TERROR;
+  lbm_uint pos = popcount(bitmap & (bit - 1)) + 1;
+  if (!(bitmap & bit)) {
+    lbm_value bucket = lbm_cons(pair, ENC_SYM_NIL);
+    if (lbm_is_symbol_merror(bucket)) return bucket;
+    *added = true;
+    return pmap_node_update(node, bitmap | bit, pos, bucket, 1);
+  }
+
+  lbm_value slot = data[pos];
+  lbm_value new_slot;
+  if (lbm_is_lisp_array_r(slot)) {
+    new_slot = pmap_node_set(slot, hash, shift + PMAP_BITS, pair, added);
+  } else {
+    lbm_value key = lbm_car(pair);
+    uint32_t slot_hash = pmap_hash(lbm_car(lbm_car(slot)), 0);
+    if (!lbm_is_symbol_nil(bucket_find(slot, key))) {
+      lbm_value rest = bucket_remove(slot, key);
+      if (lbm_is_symbol_merror(rest)) return rest;
+      new_slot = lbm_cons(pair, rest);
+    } else if (slot_hash == hash || shift + PMAP_BITS >= PMAP_HASH_BITS) {
+      new_slot = lbm_cons(pair, slot);
+      *added = true;
+    } else {
+      // Push the bucket down one level and insert next to it.
+      lbm_value sub = node_alloc(2);
+      if (lbm_is_symbol_merror(sub)) return sub;
+      node_data(sub)[0] = lbm_enc_u((lbm_uint)1 << ((slot_hash >> (shift + PMAP_BITS)) & PMAP_MASK));
+      node_data(sub)[1] = slot;
+      new_slot = pmap_node_set(sub, hash, shift + PMAP_BITS, pair, added);
+    }
+  }
+  if (lbm_is_error(new_slot)) return new_slot;
+  return pmap_node_update(node, bitmap, pos, new_slot, 0);
+}
+
+// Returns node itself when key is not present and nil when the
+// node becomes empty.
+static lbm_value pmap_node_del(lbm_value node, uint32_t hash, lbm_uint shift, lbm_value key) {
+  if (lbm_is_symbol_nil(node)) return node;
+  lbm_uint bit = (lbm_uint)1 << ((hash >> shift) & PMAP_MASK);
+  lbm_uint bitmap;
+  lbm_value *data = pmap_node_elts(node, shift, &bitmap);
+  if (!data) return ENC_SYM_TERROR;
+  if (!(bitmap & bit)) return node;
+  lbm_uint pos = popcount(bitmap & (bit - 1)) + 1;
+  lbm_value slot = data[pos];
+  lbm_value new_slot;
+  if (lbm_is_lisp_array_r(slot)) {
+    new_slot = pmap_node_del(slot, hash, shift + PMAP_BITS, key);
+  } else {
+    if (lbm_is_symbol_nil(bucket_find(slot, key))) return node;
+    new_slot = bucket_remove(slot, key);
+  }
+  if (lbm_is_error(new_slot)) return new_slot;
+  if (new_slot == slot) return node;
+  if (lbm_is_symbol_nil(new_slot)) {
+    if (bitmap == bit) return ENC_SYM_NIL;
+    return pmap_node_update(node, bitmap & ~bit, pos, ENC_SYM_NIL, -1);
+  }
+  return pmap_node_update(node, bitmap, pos, new_slot, 0);
+}
+
+static lbm_value pmap_node_get(lbm_value node, uint32_t hash, lbm_value key) {
+  for (lbm_uint shift = 0; !lbm_is_symbol_nil(node); shift += PMAP_BITS) {
+    lbm_uint bit = (lbm_uint)1 << ((hash >> shift) & PMAP_MASK);
+    lbm_uint bitmap;
+    lbm_value *data = pmap_node_elts(node, shift, &bitmap);
+    if (!data) return ENC_SYM_TERROR;
+    if (!(bitmap & bit)) break;
+    lbm_value slot = data[popcount(bitmap & (bit - 1)) + 1];
+    if (!lbm_is_lisp_array_r(slot)) {
+      return bucket_find(slot, key);
+    }
+    node = slot;
+  }
+  return ENC_SYM_NIL;
+}
+
+static lbm_value pmap_make(lbm_uint count, lbm_value root) {
+  lbm_value res = mk_tagged(sym_pmap, PMAP_SIZE);
+  if (lbm_is_symbol_merror(res)) return res;
+  node_data(res)[PMAP_COUNT] = lbm_enc_u(count);
+  node_data(res)[PMAP_ROOT] = root;
+  return res;
+}
+
+// signature: (pmap key1 val1 ... keyN valN) -> pmap
+static lbm_value ext_pmap(lbm_value *args, lbm_uint argn) {
+  if (argn % 2 != 0) return ENC_SYM_EERROR;
+  lbm_value root = ENC_SYM_NIL;
+  lbm_uint count = 0;
+  for (lbm_uint i = 0; i < argn; i += 2) {
+    lbm_value pair = lbm_cons(args[i], args[i + 1]);
+    if (lbm_is_symbol_merror(pair)) return pair;
+    bool added = false;
+    root = pmap_node_set(root, pmap_hash(args[i], 0), 0, pair, &added);
+    if (lbm_is_error(root)) return root;
+    if (added) count ++;
+  }
+  return pmap_make(count, root);
+}
+
+// signature: (pmap-get pmap key [default]) -> value
+static lbm_value ext_pmap_get(lbm_value *args, lbm_uint argn) {
+  lbm_value *m;
+  if ((argn != 2 && argn != 3) || !(m = dec_pmap(args[0]))) {
+    return ENC_SYM_TERROR;
+  }
+  lbm_value pair = pmap_node_get(m[PMAP_ROOT], pmap_hash(args[1], 0), args[1]);
+  if (lbm_is_error(pair)) return pair;
+  if (lbm_is_cons(pair)) return lbm_cdr(pair);
+  return argn == 3 ? args[2] : ENC_SYM_NIL;
+}
+
+// signature: (pmap-has pmap key) -> t or nil
+static lbm_value ext_pmap_has(lbm_value *args, lbm_uint argn) {
+  lbm_value *m;
+  if (argn != 2 || !(m = dec_pmap(args[0]))) return ENC_SYM_TERROR;
+  lbm_value pair = pmap_node_get(m[PMAP_ROOT], pmap_hash(args[1], 0), args[1]);
+  if (lbm_is_error(pair)) return pair;
+  return lbm_is_cons(pair) ? ENC_SYM_TRUE : ENC_SYM_NIL;
+}
+
+// signature: (pmap-set pmap key value) -> pmap
+static lbm_value ext_pmap_set(lbm_value *args, lbm_uint argn) {
+  lbm_value *m;
+  if (argn != 3 || !(m = dec_pmap(args[0]))) return ENC_SYM_TERROR;
+  lbm_value pair = lbm_cons(args[1], args[2]);
+  if (lbm_is_symbol_merror(pair)) return pair;
+  bool added = false;
+  lbm_value root = pmap_node_set(m[PMAP_ROOT], pmap_hash(args[1], 0), 0, pair, &added);
+  if (lbm_is_error(root)) return root;
+  return pmap_make(lbm_dec_u(m[PMAP_COUNT]) + (added ? 1 : 0), root);
+}
+
+// signature: (pmap-del pmap key) -> pmap
+static lbm_value ext_pmap_del(lbm_value *args, lbm_uint argn) {
+  lbm_value *m;
+  if (argn != 2 || !(m = dec_pmap(args[0]))) return ENC_SYM_TERROR;
+  lbm_value root = pmap_node_del(m[PMAP_ROOT], pmap_hash(args[1], 0), 0, args[1]);
+  if (lbm_is_error(root)) return root;
+  if (root == m[PMAP_ROOT]) return args[0];
+  return pmap_make(lbm_dec_u(m[PMAP_COUNT]) - 1, root);
+}
+
+// signature: (pmap-count pmap) -> int
+static lbm_value ext_pmap_count(lbm_value *args, lbm_uint argn) {
+  lbm_value *m;
+  if (argn != 1 || !(m = dec_pmap(args[0]))) return ENC_SYM_TERROR;
+  return lbm_enc_i((lbm_int)lbm_dec_u(m[PMAP_COUNT]));
+}
+
+static lbm_value pmap_collect(lbm_value node, lbm_uint shift, lbm_value acc) {
+  if (shift >= PMAP_HASH_BITS) return ENC_SYM_TERROR;
+  lbm_uint n = node_len(node);
+  for (lbm_uint i = 1; i < n && !lbm_is_error(acc); i ++) {
+    lbm_value slot = node_data(node)[i];
+    if (lbm_is_lisp_array_r(slot)) {
+      acc = pmap_collect(slot, shift + PMAP_BITS, acc);
+    } else {
+      for (lbm_value curr = slot; lbm_is_cons(curr); curr = lbm_cdr(curr)) {
+        acc = lbm_cons(lbm_car(curr), acc);
+        if (lbm_is_symbol_merror(acc)) break;
+      }
+    }
+  }
+  return acc;
+}
+
+// signature: (pmap-to-alist pmap) -> alist
+// The order of the pairs is unspecified.
+static lbm_value ext_pmap_to_alist(lbm_value *args, lbm_uint argn) {
+  lbm_value *m;
+  if (argn != 1 || !(m = dec_pmap(args[0]))) return ENC_SYM_TERROR;
+  return pmap_collect(m[PMAP_ROOT], 0, ENC_SYM_NIL);
+}
+
+void lbm_persistent_extensions_init(void) {
+
+  lbm_add_symbol_const("$pvec", &sym_pvec);
+  lbm_add_symbol_const("$pmap", &sym_pmap);
+
+  lbm_add_extension("pvec", ext_pvec);
+  lbm_add_extension("list-to-pvec", ext_list_to_pvec);
+  lbm_add_extension("pvec-len", ext_pvec_len);
+  lbm_add_extension("pvec-ref", ext_pvec_ref);
+  lbm_add_extension("pvec-set", ext_pvec_set);
+  lbm_add_extension("pvec-push", ext_pvec_push);
+  lbm_add_extension("pvec-to-list", ext_pvec_to_list);
+
+  lbm_add_extension("pmap", ext_pmap);
+  lbm_add_extension("pmap-get", ext_pmap_get);
+  lbm_add_extension("pmap-has", ext_pmap_has);
+  lbm_add_extension("pmap-set", ext_pmap_set);
+  lbm_add_extension("pmap-del", ext_pmap_del);
+  lbm_add_extension("pmap-count", ext_pmap_count);
+  lbm_add_extension("pmap-to-alist", ext_pmap_to_alist);
+}
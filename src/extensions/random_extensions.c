@@ -23,7 +23,7 @@
 #define C 268434949
 
 
-static lbm_uint random_seed = 177739;
+static LBM_INSTANCE_LOCAL lbm_uint random_seed = 177739;
 
 static lbm_value ext_seed(lbm_value *args, lbm_uint argn) {
 
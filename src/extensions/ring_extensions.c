@@ -0,0 +1,347 @@
+/*
+    Copyright 2025 Joel Svensson        svenssonjoel@yahoo.se
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "extensions/ring_extensions.h"
+
+#include "extensions.h"
+#include "lbm_memory.h"
+#include "lbm_custom_type.h"
+
+// A ring buffer holds up to capacity elements of one type. Pushing to a
+// full ring drops the oldest element.
+//
+// The sum of the elements is kept up to date on push and pop. For the
+// integer types it is an exact 64 bit integer sum. For f32 it is
+// accumulated in a double to limit rounding drift. The minimum and
+// maximum are kept in two monotonic queues of data indices. The front
+// of the max queue is the largest element and every later entry is
+// smaller than the one before it. Both queues are
+// updated in amortized constant time.
+
+typedef enum {
+  RING_I8,
+  RING_U8,
+  RING_I16,
+  RING_U16,
+  RING_I32,
+  RING_U32,
+  RING_F32
+} ring_type_t;
+
+typedef struct {
+  uint32_t *ix;
+  uint32_t head;
+  uint32_t count;
+} ring_queue_t;
+
+typedef struct {
+  ring_type_t type;
+  uint32_t cap;
+  uint32_t head;  // Data index of the oldest element.
+  uint32_t count;
+  int64_t isum;   // Sum of integer elements.
+  double fsum;    // Sum of f32 elements.
+  ring_queue_t min_q;
+  ring_queue_t max_q;
+  void *data;
+} ring_t;
+
+static const char *ring_desc = "Ring";
+
+static LBM_INSTANCE_LOCAL lbm_uint sym_i8  = 0;
+static LBM_INSTANCE_LOCAL lbm_uint sym_u8  = 0;
+static LBM_INSTANCE_LOCAL lbm_uint sym_i16 = 0;
+static LBM_INSTANCE_LOCAL lbm_uint sym_u16 = 0;
+static LBM_INSTANCE_LOCAL lbm_uint sym_i32 = 0;
+static LBM_INSTANCE_LOCAL lbm_uint sym_u32 = 0;
+static LBM_INSTANCE_LOCAL lbm_uint sym_f32 = 0;
+
+// Element ix of an integer ring.
+static int64_t ring_get_int(ring_t *r, uint32_t ix) {
+  switch (r->type) {
+  case RING_I8:  return ((int8_t*)r->data)[ix];
+  case RING_U8:  return ((uint8_t*)r->data)[ix];
+  case RING_I16: return ((int16_t*)r->data)[ix];
+  case RING_U16: return ((uint16_t*)r->data)[ix];
+  case RING_I32: return ((int32_t*)r->data)[ix];
+  default:       return ((uint32_t*)r->data)[ix];
+  }
+}
+
+static bool ring_greater(ring_t *r, uint32_t a, uint32_t b) {
+  if (r->type == RING_F32) {
+    return ((float*)r->data)[a] > ((float*)r->data)[b];
+  }
+  return ring_get_int(r, a) > ring_get_int(r, b);
+}
+
+static void ring_add_to_sum(ring_t *r, uint32_t ix, bool sub) {
+  if (r->type == RING_F32) {
+    double v = ((float*)r->data)[ix];
+    r->fsum += sub ? -v : v;
+  } else {
+    int64_t v = ring_get_int(r, ix);
+    r->isum += sub ? -v : v;
+  }
+}
+
+static lbm_value ring_get_value(ring_t *r, uint32_t ix) {
+  switch (r->type) {
+  case RING_I8:  return lbm_enc_i(((int8_t*)r->data)[ix]);
+  case RING_U8:  return lbm_enc_i(((uint8_t*)r->data)[ix]);
+  case RING_I16: return lbm_enc_i(((int16_t*)r->data)[ix]);
+  case RING_U16: return lbm_enc_i(((uint16_t*)r->data)[ix]);
+  case RING_I32: return lbm_enc_i(((int32_t*)r->data)[ix]);
+  case RING_U32: return lbm_enc_u32(((uint32_t*)r->data)[ix]);
+  default:       return lbm_enc_float(((float*)r->data)[ix]);
+  }
+}
+
+static void ring_set(ring_t *r, uint32_t ix, lbm_value v) {
+  switch (r->type) {
+  case RING_I8:  ((int8_t*)r->data)[ix]   = (int8_t)lbm_dec_as_i32(v); break;
+  case RING_U8:  ((uint8_t*)r->data)[ix]  = (uint8_t)lbm_dec_as_u32(v); break;
+  case RING_I16: ((int16_t*)r->data)[ix]  = (int16_t)lbm_dec_as_i32(v); break;
+  case RING_U16: ((uint16_t*)r->data)[ix] = (uint16_t)lbm_dec_as_u32(v); break;
+  case RING_I32: ((int32_t*)r->data)[ix]  = lbm_dec_as_i32(v); break;
+  case RING_U32: ((uint32_t*)r->data)[ix] = lbm_dec_as_u32(v); break;
+  default:       ((float*)r->data)[ix]    = lbm_dec_as_float(v); break;
+  }
+}
+
+static uint32_t queue_back(ring_t *r, ring_queue_t *q) {
+  return q->ix[(q->head + q->count - 1) % r->cap];
+}
+
+// Remove entries from the back that the new element makes redundant
+// and add it. For the max queue that is every element not larger than
+// the new one.
+static void queue_push(ring_t *r, ring_queue_t *q, uint32_t ix, bool max) {
+  while (q->count > 0) {
+    uint32_t b = queue_back(r, q);
+    if (max ? ring_greater(r, b, ix) : ring_greater(r, ix, b)) break;
+    q->count --;
+  }
+  q->ix[(q->head + q->count) % r->cap] = ix;
+  q->count ++;
+}
+
+static void queue_pop(ring_t *r, ring_queue_t *q, uint32_t ix) {
+  if (q->count > 0 && q->ix[q->head] == ix) {
+    q->head = (q->head + 1) % r->cap;
+    q->count --;
+  }
+}
+
+static void ring_drop_oldest(ring_t *r) {
+  ring_add_to_sum(r, r->head, true);
+  queue_pop(r, &r->min_q, r->head);
+  queue_pop(r, &r->max_q, r->head);
+  r->head = (r->head + 1) % r->cap;
+  r->count --;
+  if (r->count == 0) r->fsum = 0.0;
+}
+
+static void ring_clear(ring_t *r) {
+  r->head = 0;
+  r->count = 0;
+  r->isum = 0;
+  r->fsum = 0.0;
+  r->min_q.head = 0;
+  r->min_q.count = 0;
+  r->max_q.head = 0;
+  r->max_q.count = 0;
+}
+
+static bool ring_destructor(lbm_uint value) {
+  lbm_free((void*)value);
+  return true;
+}
+
+static ring_t *dec_ring(lbm_value v) {
+  if (lbm_is_custom(v) &&
+      lbm_get_custom_descriptor(v) == ring_desc) {
+    return (ring_t*)lbm_get_custom_value(v);
+  }
+  return NULL;
+}
+
+static bool decode_ring_type(lbm_value v, ring_type_t *type, lbm_uint *size) {
+  if (!lbm_is_symbol(v)) return false;
+  lbm_uint s = lbm_dec_sym(v);
+  if (s == sym_i8)       { *type = RING_I8;  *size = 1; }
+  else if (s == sym_u8)  { *type = RING_U8;  *size = 1; }
+  else if (s == sym_i16) { *type = RING_I16; *size = 2; }
+  else if (s == sym_u16) { *type = RING_U16; *size = 2; }
+  else if (s == sym_i32) { *type = RING_I32; *size = 4; }
+  else if (s == sym_u32) { *type = RING_U32; *size = 4; }
+  else if (s == sym_f32) { *type = RING_F32; *size = 4; }
+  else return false;
+  return true;
+}
+
+// signature: (ring-create type capacity) -> ring
+static lbm_value ext_ring_create(lbm_value *args, lbm_uint argn) {
+  ring_type_t type;
+  lbm_uint elt_size;
+  if (argn != 2 ||
+      !decode_ring_type(args[0], &type, &elt_size) ||
+      !lbm_is_number(args[1])) {
+    return ENC_SYM_TERROR;
+  }
+  uint32_t cap = lbm_dec_as_u32(args[1]);
+  if (cap == 0) return ENC_SYM_EERROR;
+
+  // Header, both queues and the data in a single allocation. The
+  // queues are placed first to keep them word aligned. A capacity
+  // whose size does not fit in an lbm_uint is an error.
+  lbm_uint bytes_per_elt = 2 * sizeof(uint32_t) + elt_size;
+  if (cap > (LBM_UINT_MAX - sizeof(ring_t)) / bytes_per_elt) return ENC_SYM_EERROR;
+  ring_t *r = lbm_malloc(sizeof(ring_t) + cap * bytes_per_elt);
+  if (!r) return ENC_SYM_MERROR;
+  r->type = type;
+  r->cap = cap;
+  r->min_q.ix = (uint32_t*)(r + 1);
+  r->max_q.ix = r->min_q.ix + cap;
+  r->data = r->max_q.ix + cap;
+  ring_clear(r);
+
+  lbm_value res;
+  if (!lbm_custom_type_create((lbm_uint)r, ring_destructor, ring_desc, &res)) {
+    lbm_free(r);
+    return ENC_SYM_MERROR;
+  }
+  return res;
+}
+
+// signature: (ring-push ring val1 ... valN) -> t
+static lbm_value ext_ring_push(lbm_value *args, lbm_uint argn) {
+  ring_t *r;
+  if (argn < 1 || !(r = dec_ring(args[0]))) return ENC_SYM_TERROR;
+  for (lbm_uint i = 1; i < argn; i ++) {
+    if (!lbm_is_number(args[i])) return ENC_SYM_TERROR;
+  }
+  for (lbm_uint i = 1; i < argn; i ++) {
+    if (r->count == r->cap) {
+      ring_drop_oldest(r);
+    }
+    uint32_t ix = (r->head + r->count) % r->cap;
+    ring_set(r, ix, args[i]);
+    r->count ++;
+    ring_add_to_sum(r, ix, false);
+    queue_push(r, &r->min_q, ix, false);
+    queue_push(r, &r->max_q, ix, true);
+  }
+  return ENC_SYM_TRUE;
+}
+
+// signature: (ring-pop ring) -> oldest element or nil
+static lbm_value ext_ring_pop(lbm_value *args, lbm_uint argn) {
+  ring_t *r;
+  if (argn != 1 || !(r = dec_ring(args[0]))) return ENC_SYM_TERROR;
+  if (r->count == 0) return ENC_SYM_NIL;
+  lbm_value v = ring_get_value(r, r->head);
+  if (!lbm_is_symbol_merror(v)) {
+    ring_drop_oldest(r);
+  }
+  return v;
+}
+
+// signature: (ring-peek ring) -> oldest element or nil
+static lbm_value ext_ring_peek(lbm_value *args, lbm_uint argn) {
+  ring_t *r;
+  if (argn != 1 || !(r = dec_ring(args[0]))) return ENC_SYM_TERROR;
+  if (r->count == 0) return ENC_SYM_NIL;
+  return ring_get_value(r, r->head);
+}
+
+// signature: (ring-ref ring index) -> element
+// Index 0 is the oldest element and -1 the newest.
+static lbm_value ext_ring_ref(lbm_value *args, lbm_uint argn) {
+  ring_t *r;
+  if (argn != 2 || !(r = dec_ring(args[0])) || !lbm_is_number(args[1])) {
+    return ENC_SYM_TERROR;
+  }
+  lbm_int ix = lbm_dec_as_i32(args[1]);
+  if (ix < 0) ix += (lbm_int)r->count;
+  if (ix < 0 || ix >= (lbm_int)r->count) return ENC_SYM_EERROR;
+  return ring_get_value(r, (r->head + (uint32_t)ix) % r->cap);
+}
+
+// signature: (ring-len ring) -> int
+static lbm_value ext_ring_len(lbm_value *args, lbm_uint argn) {
+  ring_t *r;
+  if (argn != 1 || !(r = dec_ring(args[0]))) return ENC_SYM_TERROR;
+  return lbm_enc_i((lbm_int)r->count);
+}
+
+// signature: (ring-clear ring) -> t
+static lbm_value ext_ring_clear(lbm_value *args, lbm_uint argn) {
+  ring_t *r;
+  if (argn != 1 || !(r = dec_ring(args[0]))) return ENC_SYM_TERROR;
+  ring_clear(r);
+  return ENC_SYM_TRUE;
+}
+
+// signature: (ring-mean ring) -> float or nil
+static lbm_value ext_ring_mean(lbm_value *args, lbm_uint argn) {
+  ring_t *r;
+  if (argn != 1 || !(r = dec_ring(args[0]))) return ENC_SYM_TERROR;
+  if (r->count == 0) return ENC_SYM_NIL;
+  if (r->type == RING_F32) {
+    return lbm_enc_float((float)(r->fsum / r->count));
+  }
+  return lbm_enc_float((float)r->isum / (float)r->count);
+}
+
+// signature: (ring-min ring) -> element or nil
+static lbm_value ext_ring_min(lbm_value *args, lbm_uint argn) {
+  ring_t *r;
+  if (argn != 1 || !(r = dec_ring(args[0]))) return ENC_SYM_TERROR;
+  if (r->count == 0) return ENC_SYM_NIL;
+  return ring_get_value(r, r->min_q.ix[r->min_q.head]);
+}
+
+// signature: (ring-max ring) -> element or nil
+static lbm_value ext_ring_max(lbm_value *args, lbm_uint argn) {
+  ring_t *r;
+  if (argn != 1 || !(r = dec_ring(args[0]))) return ENC_SYM_TERROR;
+  if (r->count == 0) return ENC_SYM_NIL;
+  return ring_get_value(r, r->max_q.ix[r->max_q.head]);
+}
+
+void lbm_ring_extensions_init(void) {
+
+  lbm_add_symbol_const("i8", &sym_i8);
+  lbm_add_symbol_const("u8", &sym_u8);
+  lbm_add_symbol_const("i16", &sym_i16);
+  lbm_add_symbol_const("u16", &sym_u16);
+  lbm_add_symbol_const("i32", &sym_i32);
+  lbm_add_symbol_const("u32", &sym_u32);
+  lbm_add_symbol_const("f32", &sym_f32);
+
+  lbm_add_extension("ring-create", ext_ring_create);
+  lbm_add_extension("ring-push", ext_ring_push);
+  lbm_add_extension("ring-pop", ext_ring_pop);
+  lbm_add_extension("ring-peek", ext_ring_peek);
+  lbm_add_extension("ring-ref", ext_ring_ref);
+  lbm_add_extension("ring-len", ext_ring_len);
+  lbm_add_extension("ring-clear", ext_ring_clear);
+  lbm_add_extension("ring-mean", ext_ring_mean);
+  lbm_add_extension("ring-min", ext_ring_min);
+  lbm_add_extension("ring-max", ext_ring_max);
+}
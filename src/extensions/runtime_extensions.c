@@ -24,16 +24,16 @@
 #include <env.h>
 
 #ifdef FULL_RTS_LIB
-static lbm_uint sym_heap_size;
-static lbm_uint sym_heap_bytes;
-static lbm_uint sym_num_alloc_cells;
-static lbm_uint sym_num_alloc_arrays;
-static lbm_uint sym_num_gc;
-static lbm_uint sym_num_gc_marked;
-static lbm_uint sym_num_gc_recovered_cells;
-static lbm_uint sym_num_gc_recovered_arrays;
-static lbm_uint sym_num_least_free;
-static lbm_uint sym_num_last_free;
+static LBM_INSTANCE_LOCAL lbm_uint sym_heap_size;
+static LBM_INSTANCE_LOCAL lbm_uint sym_heap_bytes;
+static LBM_INSTANCE_LOCAL lbm_uint sym_num_alloc_cells;
+static LBM_INSTANCE_LOCAL lbm_uint sym_num_alloc_arrays;
+static LBM_INSTANCE_LOCAL lbm_uint sym_num_gc;
+static LBM_INSTANCE_LOCAL lbm_uint sym_num_gc_marked;
+static LBM_INSTANCE_LOCAL lbm_uint sym_num_gc_recovered_cells;
+static LBM_INSTANCE_LOCAL lbm_uint sym_num_gc_recovered_arrays;
+static LBM_INSTANCE_LOCAL lbm_uint sym_num_least_free;
+static LBM_INSTANCE_LOCAL lbm_uint sym_num_last_free;
 #endif
 
 lbm_value ext_eval_set_quota(lbm_value *args, lbm_uint argn) {
@@ -24,6 +24,7 @@
 #include "lbm_c_interop.h"
 #include "eval_cps.h"
 #include "print.h"
+#include "lbm_custom_type.h"
 
 #include <ctype.h>
 
@@ -34,10 +35,8 @@
 #define MAX(a,b) (((a)>(b))?(a):(b))
 #endif
 
-static char print_val_buffer[256];
-
-static lbm_uint sym_left;
-static lbm_uint sym_case_insensitive;
+static LBM_INSTANCE_LOCAL lbm_uint sym_left;
+static LBM_INSTANCE_LOCAL lbm_uint sym_case_insensitive;
 
 
 static size_t strlen_max(const char *s, size_t maxlen) {
@@ -59,6 +58,100 @@ static bool dec_str_size(lbm_value v, char **data, size_t *size) {
   return result;
 }
 
+// Number of characters in a string array. Strings keep a terminating
+// zero in the last byte, views into the middle of a string do not.
+static lbm_int str_array_len(lbm_value v, lbm_array_header_t *array) {
+  if (lbm_is_array_view(v) &&
+      (array->size == 0 || ((char*)array->data)[array->size - 1] != 0)) {
+    return (lbm_int)array->size;
+  }
+  return (lbm_int)array->size - 1;
+}
+
+// Decode a string into a zero terminated C string for use with the
+// C library. A view that lacks the terminating zero is copied into buf.
+// Returns NULL and sets *err to a type error if v is not a string or
+// to an eval error if the view does not fit in buf.
+static char *dec_str_terminated(lbm_value v, char *buf, size_t buf_size, lbm_value *err) {
+  char *str = lbm_dec_str(v);
+  char *data;
+  size_t size;
+  *err = ENC_SYM_TERROR;
+  if (!str && dec_str_size(v, &data, &size)) {
+    size_t n = strlen_max(data, size);
+    if (n >= buf_size) {
+      lbm_set_error_reason("String view too long to convert");
+      *err = ENC_SYM_EERROR;
+      return NULL;
+    }
+    memcpy(buf, data, n);
+    buf[n] = '\0';
+    str = buf;
+  }
+  return str;
+}
+
+// Needles shorter than this are located with memchr on the first
+// character, longer needles use the Horspool skip table.
+#define STR_SEARCH_SKIP_MIN 4
+
+// Find the first occurrence of needle in the n first characters of str.
+static char *str_search(char *str, size_t n, const char *needle, size_t needle_len) {
+  if (needle_len == 0) return str;
+  if (needle_len > n) return NULL;
+
+  if (needle_len < STR_SEARCH_SKIP_MIN) {
+    while (n >= needle_len) {
+      char *c = memchr(str, needle[0], n - needle_len + 1);
+      if (!c) break;
+      if (memcmp(c, needle, needle_len) == 0) return c;
+      n -= (size_t)(c - str) + 1;
+      str = c + 1;
+    }
+    return NULL;
+  }
+
+  // Horspool. Shifts are capped at 255 to keep the table small, which
+  // only makes the search take shorter steps for very long needles.
+  uint8_t skip[256];
+  size_t max_skip = MIN(needle_len, 255);
+  memset(skip, (int)max_skip, sizeof(skip));
+  for (size_t i = needle_len - max_skip; i < needle_len - 1; i ++) {
+    skip[(uint8_t)needle[i]] = (uint8_t)(needle_len - 1 - i);
+  }
+
+  const uint8_t last = (uint8_t)needle[needle_len - 1];
+  size_t pos = 0;
+  while (pos <= n - needle_len) {
+    uint8_t c = (uint8_t)str[pos + needle_len - 1];
+    if (c == last && memcmp(str + pos, needle, needle_len - 1) == 0) {
+      return str + pos;
+    }
+    pos += skip[c];
+  }
+  return NULL;
+}
+
+// Create a string from n characters at offset start of the string src.
+// The result is either a copy or a view sharing data with src.
+static lbm_value mk_substr(lbm_value src, size_t start, size_t n, bool view) {
+  lbm_value res = ENC_SYM_MERROR;
+  if (view) {
+    lbm_array_header_t *arr = lbm_dec_array_r(src);
+    // Include the terminating zero if the view reaches the end of
+    // the string, that makes the view a complete string.
+    if (start + n < arr->size && ((char*)arr->data)[start + n] == '\0') {
+      n++;
+    }
+    lbm_heap_allocate_array_view(&res, src, start, n);
+  } else if (lbm_create_array(&res, n + 1)) {
+    lbm_array_header_t *arr = (lbm_array_header_t*)lbm_car(res);
+    memcpy(arr->data, (char*)lbm_dec_array_r(src)->data + start, n);
+    ((char*)(arr->data))[n] = '\0';
+  }
+  return res;
+}
+
 static lbm_value ext_str_from_n(lbm_value *args, lbm_uint argn) {
   if (argn != 1 && argn != 2) {
     lbm_set_error_reason((char*)lbm_error_str_num_args);
@@ -73,8 +166,11 @@ static lbm_value ext_str_from_n(lbm_value *args, lbm_uint argn) {
   }
 
   char *format = 0;
+  char format_buf[32];
   if (argn == 2) {
-    format = lbm_dec_str(args[1]);
+    lbm_value err;
+    format = dec_str_terminated(args[1], format_buf, sizeof(format_buf), &err);
+    if (!format) return err;
   }
 
   char buffer[100];
@@ -141,17 +237,18 @@ static lbm_value ext_str_join(lbm_value *args, lbm_uint argn) {
     }
   }
 
-  const char *delim = "";
+  char *delim = "";
+  size_t delim_len = 0;
   if (argn >= 2) {
-    delim = lbm_dec_str(args[1]);
-    if (!delim) {
+    size_t delim_arr_size = 0;
+    if (!dec_str_size(args[1], &delim, &delim_arr_size)) {
       lbm_set_error_reason((char *)lbm_error_str_incorrect_arg);
       lbm_set_error_suspect(args[1]);
       return ENC_SYM_TERROR;
     }
+    delim_len = strlen_max(delim, delim_arr_size);
   }
 
-  size_t delim_len = strlen(delim);
   if (str_count > 0) {
     str_len += (str_count - 1) * delim_len;
   }
@@ -192,9 +289,11 @@ static lbm_value ext_str_to_i(lbm_value *args, lbm_uint argn) {
     return ENC_SYM_EERROR;
   }
 
-  char *str = lbm_dec_str(args[0]);
+  char buf[64];
+  lbm_value err;
+  char *str = dec_str_terminated(args[0], buf, sizeof(buf), &err);
   if (!str) {
-    return ENC_SYM_TERROR;
+    return err;
   }
 
   int base = 0;
@@ -215,15 +314,17 @@ static lbm_value ext_str_to_f(lbm_value *args, lbm_uint argn) {
     return ENC_SYM_EERROR;
   }
 
-  char *str = lbm_dec_str(args[0]);
+  char buf[64];
+  lbm_value err;
+  char *str = dec_str_terminated(args[0], buf, sizeof(buf), &err);
   if (!str) {
-    return ENC_SYM_TERROR;
+    return err;
   }
 
   return lbm_enc_float(strtof(str, NULL));
 }
 
-static lbm_value ext_str_part(lbm_value *args, lbm_uint argn) {
+static lbm_value str_part(lbm_value *args, lbm_uint argn, bool view) {
   if ((argn != 2 && argn != 3) || !lbm_is_number(args[1])) {
     lbm_set_error_reason((char*)lbm_error_str_num_args);
     return ENC_SYM_TERROR;
@@ -252,18 +353,20 @@ static lbm_value ext_str_part(lbm_value *args, lbm_uint argn) {
     n = MIN(lbm_dec_as_u32(args[2]), n);
   }
 
-  lbm_value res;
-  if (lbm_create_array(&res, n + 1)) {
-    lbm_array_header_t *arr = (lbm_array_header_t*)lbm_car(res);
-    memcpy(arr->data, str + start, n);
-    ((char*)(arr->data))[n] = '\0';
-    return res;
-  } else {
-    return ENC_SYM_MERROR;
-  }
+  return mk_substr(args[0], start, n, view);
 }
 
-static lbm_value ext_str_split(lbm_value *args, lbm_uint argn) {
+static lbm_value ext_str_part(lbm_value *args, lbm_uint argn) {
+  return str_part(args, argn, false);
+}
+
+// signature: (str-view str start [n]) -> str
+// Same as str-part but the result shares data with str.
+static lbm_value ext_str_view(lbm_value *args, lbm_uint argn) {
+  return str_part(args, argn, true);
+}
+
+static lbm_value str_split(lbm_value *args, lbm_uint argn, bool view) {
   if (argn != 2) {
     lbm_set_error_reason((char*)lbm_error_str_num_args);
     return ENC_SYM_EERROR;
@@ -275,8 +378,9 @@ static lbm_value ext_str_split(lbm_value *args, lbm_uint argn) {
     return ENC_SYM_TERROR;
   }
 
-  char *split = lbm_dec_str(args[1]);
-  if (!split) {
+  size_t split_arr_size = 0;
+  char *split = NULL;
+  if (!dec_str_size(args[1], &split, &split_arr_size)) {
     if (lbm_is_number(args[1])) {
       int step = MAX(lbm_dec_as_i32(args[1]), 1);
       lbm_value res = ENC_SYM_NIL;
@@ -292,41 +396,47 @@ static lbm_value ext_str_split(lbm_value *args, lbm_uint argn) {
           step_now--;
         }
 
-        lbm_value tok;
-        if (lbm_create_array(&tok, (lbm_uint)step_now + 1)) {
-          lbm_array_header_t *arr = (lbm_array_header_t*)lbm_car(tok);
-          memcpy(arr->data, str + ind_now, (unsigned int)step_now);
-          ((char*)(arr->data))[step_now] = '\0';
-          res = lbm_cons(tok, res);
-        } else {
-          return ENC_SYM_MERROR;
+        lbm_value tok = mk_substr(args[0], (size_t)ind_now, (size_t)step_now, view);
+        if (lbm_is_symbol(tok)) {
+          return tok;
         }
+        res = lbm_cons(tok, res);
       }
       return res;
     } else {
       return ENC_SYM_TERROR;
     }
   } else {
-     lbm_value res = ENC_SYM_NIL;
-    const char *s = str;
-    while (*(s += strspn(s, split)) != '\0') {
-      size_t len = strcspn(s, split);
-
-      lbm_value tok;
-      if (lbm_create_array(&tok, len + 1)) {
-        lbm_array_header_t *arr = (lbm_array_header_t*)lbm_car(tok);
-        memcpy(arr->data, s, len);
-        ((char*)(arr->data))[len] = '\0';
-        res = lbm_cons(tok, res);
-      } else {
-        return ENC_SYM_MERROR;
+    lbm_value res = ENC_SYM_NIL;
+    size_t len = strlen_max(str, str_arr_size);
+    size_t split_len = strlen_max(split, split_arr_size);
+    size_t i = 0;
+    while (true) {
+      while (i < len && memchr(split, str[i], split_len)) i++;
+      if (i >= len) break;
+      size_t start = i;
+      while (i < len && !memchr(split, str[i], split_len)) i++;
+
+      lbm_value tok = mk_substr(args[0], start, i - start, view);
+      if (lbm_is_symbol(tok)) {
+        return tok;
       }
-      s += len;
+      res = lbm_cons(tok, res);
     }
     return lbm_list_destructive_reverse(res);
   }
 }
 
+static lbm_value ext_str_split(lbm_value *args, lbm_uint argn) {
+  return str_split(args, argn, false);
+}
+
+// signature: (str-split-view str delim) -> list of str
+// Same as str-split but the results share data with str.
+static lbm_value ext_str_split_view(lbm_value *args, lbm_uint argn) {
+  return str_split(args, argn, true);
+}
+
 // Todo: Clean this up for 64bit
 static lbm_value ext_str_replace(lbm_value *args, lbm_uint argn) {
   if (argn != 2 && argn != 3) {
@@ -354,50 +464,49 @@ static lbm_value ext_str_replace(lbm_value *args, lbm_uint argn) {
     }
   }
 
-  // See https://stackoverflow.com/questions/779875/what-function-is-to-replace-a-substring-from-a-string-in-c
-  //char *result; // the return string
-  char *ins;    // the next insert point
-  char *tmp;    // varies
-  size_t len_rep;  // length of rep (the string to remove)
-  size_t len_with; // length of with (the string to replace rep with)
-  //size_t len_front; // distance between rep and end of last rep
-  int count;    // number of replacements
-
-  len_rep = strlen_max(rep, rep_arr_size);
+  size_t len_rep = strlen_max(rep, rep_arr_size);
   if (len_rep == 0) {
     return args[0]; // empty rep causes infinite loop during count
   }
 
-  len_with = strlen_max(with,with_arr_size);
+  size_t len_with = strlen_max(with, with_arr_size);
+  size_t len_orig = strlen_max(orig, orig_arr_size);
 
   // count the number of replacements needed
-  ins = orig;
-  for (count = 0; (tmp = strstr(ins, rep)); ++count) {
+  size_t count = 0;
+  char *ins = orig;
+  char *tmp;
+  while ((tmp = str_search(ins, len_orig - (size_t)(ins - orig), rep, len_rep))) {
     ins = tmp + len_rep;
+    count ++;
   }
 
-  size_t len_res = strlen_max(orig, orig_arr_size) + (len_with - len_rep) * (unsigned int)count + 1;
+  size_t len_res = len_orig - (len_rep * count) + (len_with * count) + 1;
   lbm_value lbm_res;
+  char *res;
   if (lbm_create_array(&lbm_res, len_res)) {
     lbm_array_header_t *arr = (lbm_array_header_t*)lbm_car(lbm_res);
-    tmp = (char*)arr->data;
+    res = (char*)arr->data;
   } else {
     return ENC_SYM_MERROR;
   }
 
-  // first time through the loop, all the variable are set correctly
-  // from here on,
-  //    tmp points to the end of the result string
+  //    res points to the end of the result string
   //    ins points to the next occurrence of rep in orig
   //    orig points to the remainder of orig after "end of rep"
+  char *orig_end = orig + len_orig;
   while (count--) {
-    ins = strstr(orig, rep);
-    size_t len_front = (size_t)ins - (size_t)orig;
-    tmp = strncpy(tmp, orig, len_front) + len_front;
-    tmp = strncpy(tmp, with, len_with) + len_with;
+    ins = str_search(orig, (size_t)(orig_end - orig), rep, len_rep);
+    size_t len_front = (size_t)(ins - orig);
+    memcpy(res, orig, len_front);
+    res += len_front;
+    memcpy(res, with, len_with);
+    res += len_with;
     orig += len_front + len_rep; // move to next "end of rep"
   }
-  strcpy(tmp, orig);
+  size_t len_back = (size_t)(orig_end - orig);
+  memcpy(res, orig, len_back);
+  res[len_back] = '\0';
 
   return lbm_res;
 }
@@ -446,13 +555,15 @@ static lbm_value ext_str_cmp(lbm_value *args, lbm_uint argn) {
     return ENC_SYM_EERROR;
   }
 
-  char *str1 = lbm_dec_str(args[0]);
-  if (!str1) {
+  size_t str1_arr_size = 0;
+  char *str1 = NULL;
+  if (!dec_str_size(args[0], &str1, &str1_arr_size)) {
     return ENC_SYM_TERROR;
   }
 
-  char *str2 = lbm_dec_str(args[1]);
-  if (!str2) {
+  size_t str2_arr_size = 0;
+  char *str2 = NULL;
+  if (!dec_str_size(args[1], &str2, &str2_arr_size)) {
     return ENC_SYM_TERROR;
   }
 
@@ -465,65 +576,212 @@ static lbm_value ext_str_cmp(lbm_value *args, lbm_uint argn) {
     n = lbm_dec_as_i32(args[2]);
   }
 
+  size_t len1 = strlen_max(str1, str1_arr_size);
+  size_t len2 = strlen_max(str2, str2_arr_size);
   if (n > 0) {
-    return lbm_enc_i(strncmp(str1, str2, (unsigned int)n));
+    len1 = MIN(len1, (size_t)n);
+    len2 = MIN(len2, (size_t)n);
+  }
+
+  int res = memcmp(str1, str2, MIN(len1, len2));
+  if (res == 0) {
+    // One string is a prefix of the other.
+    if (len1 < len2) {
+      res = -(unsigned char)str2[len1];
+    } else if (len1 > len2) {
+      res = (unsigned char)str1[len2];
+    }
+  }
+  return lbm_enc_i(res);
+}
+
+// String builder
+//
+// A growable character buffer in lbm_memory. Capacity grows
+// geometrically so that a sequence of appends is linear in the total
+// length. The buffer is always kept zero terminated and is handed over
+// as the data of a byte array when the builder is finished.
+
+#define STR_BUILDER_MIN_CAPACITY 16
+
+typedef struct {
+  char *data;
+  lbm_uint len; // Number of characters, excluding the terminating zero.
+  lbm_uint cap; // Size of data in bytes.
+} str_builder_t;
+
+static const char *str_builder_desc = "StringBuilder";
+
+// Make room for n more characters and a terminating zero. Fails if
+// the size does not fit in an lbm_uint.
+static bool sb_reserve(str_builder_t *sb, lbm_uint n) {
+  if (n > LBM_UINT_MAX - sb->len - 1) return false;
+  lbm_uint need = sb->len + n + 1;
+  if (need <= sb->cap) return true;
+  lbm_uint cap = sb->cap ? sb->cap : STR_BUILDER_MIN_CAPACITY;
+  while (cap < need) {
+    if (cap > LBM_UINT_MAX / 2) {
+      cap = need;
+      break;
+    }
+    cap *= 2;
+  }
+  char *data = lbm_malloc(cap);
+  if (!data) return false;
+  if (sb->data) {
+    memcpy(data, sb->data, sb->len + 1);
+    lbm_free(sb->data);
   } else {
-    return lbm_enc_i(strcmp(str1, str2));
+    data[0] = 0;
   }
+  sb->data = data;
+  sb->cap = cap;
+  return true;
 }
 
-// TODO: This is very similar to ext-print. Maybe they can share code.
-static lbm_value to_str(char *delimiter, lbm_value *args, lbm_uint argn) {
-  const int str_len = 300;
-  char *str = lbm_malloc((lbm_uint)str_len);
-  if (!str) {
+static bool sb_append_chars(str_builder_t *sb, const char *str, lbm_uint n) {
+  if (!sb_reserve(sb, n)) return false;
+  memcpy(sb->data + sb->len, str, n);
+  sb->len += n;
+  sb->data[sb->len] = 0;
+  return true;
+}
+
+// Strings are appended as is, other values are printed directly into
+// the builder. Returns ENC_SYM_TRUE on success or an error symbol.
+static lbm_value sb_append_value(str_builder_t *sb, lbm_value v) {
+  char *str;
+  lbm_uint len;
+  if (lbm_value_is_printable_string_len(v, &str, &len)) {
+    return sb_append_chars(sb, str, len) ? ENC_SYM_TRUE : ENC_SYM_MERROR;
+  }
+  lbm_uint n = STR_BUILDER_MIN_CAPACITY;
+  while (sb_reserve(sb, n)) {
+    int r = lbm_print_value_len(sb->data + sb->len, (unsigned int)(sb->cap - sb->len), v);
+    if (r >= 0) {
+      sb->len += (lbm_uint)r;
+      return ENC_SYM_TRUE;
+    }
+    sb->data[sb->len] = 0;
+    if (r != -1) return ENC_SYM_EERROR;
+    n = sb->cap;
+  }
+  return ENC_SYM_MERROR;
+}
+
+// Hand the buffer over to a byte array. The builder is left empty.
+static lbm_value sb_finish(str_builder_t *sb) {
+  if (!sb_reserve(sb, 0)) return ENC_SYM_MERROR;
+  lbm_uint size = sb->len + 1;
+  lbm_uint words = (size + sizeof(lbm_uint) - 1) / sizeof(lbm_uint);
+  if (lbm_memory_shrink((lbm_uint*)sb->data, words)) {
+    sb->cap = words * sizeof(lbm_uint);
+  }
+  lbm_value res;
+  if (!lbm_lift_array(&res, sb->data, size)) {
     return ENC_SYM_MERROR;
   }
+  sb->data = NULL;
+  sb->len = 0;
+  sb->cap = 0;
+  return res;
+}
 
-  int str_ofs = 0;
+static bool str_builder_destructor(lbm_uint value) {
+  str_builder_t *sb = (str_builder_t*)value;
+  if (sb->data) lbm_free(sb->data);
+  lbm_free(sb);
+  return true;
+}
 
-  for (lbm_uint i = 0; i < argn; i ++) {
-    lbm_value t = args[i];
-    int max = str_len - str_ofs - 1;
+static str_builder_t *dec_str_builder(lbm_value v) {
+  if (lbm_is_custom(v) &&
+      lbm_get_custom_descriptor(v) == str_builder_desc) {
+    return (str_builder_t*)lbm_get_custom_value(v);
+  }
+  return NULL;
+}
 
-    char *arr_str;
-    int chars = 0;
+// signature: (sb-create [capacity]) -> builder
+static lbm_value ext_sb_create(lbm_value *args, lbm_uint argn) {
+  if (argn > 1 || (argn == 1 && !lbm_is_number(args[0]))) {
+    return ENC_SYM_TERROR;
+  }
+  if (argn == 1 && lbm_dec_as_i64(args[0]) < 0) return ENC_SYM_EERROR;
+  str_builder_t *sb = lbm_malloc(sizeof(str_builder_t));
+  if (!sb) return ENC_SYM_MERROR;
+  sb->data = NULL;
+  sb->len = 0;
+  sb->cap = 0;
+  if (argn == 1 && !sb_reserve(sb, lbm_dec_as_u32(args[0]))) {
+    lbm_free(sb);
+    return ENC_SYM_MERROR;
+  }
+  lbm_value res;
+  if (!lbm_custom_type_create((lbm_uint)sb, str_builder_destructor, str_builder_desc, &res)) {
+    str_builder_destructor((lbm_uint)sb);
+    return ENC_SYM_MERROR;
+  }
+  return res;
+}
 
-    if (lbm_value_is_printable_string(t, &arr_str)) {
-      if (str_ofs == 0) {
-        chars = snprintf(str + str_ofs, (unsigned int)max, "%s", arr_str);
-      } else {
-        chars = snprintf(str + str_ofs, (unsigned int)max, "%s%s", delimiter, arr_str);
-      }
-    } else {
-      lbm_print_value(print_val_buffer, 256, t);
-      if (str_ofs == 0) {
-        chars = snprintf(str + str_ofs, (unsigned int)max, "%s", print_val_buffer);
-      } else {
-        chars = snprintf(str + str_ofs, (unsigned int)max, "%s%s", delimiter, print_val_buffer);
-      }
+// signature: (sb-append builder val1 ... valN) -> builder
+static lbm_value ext_sb_append(lbm_value *args, lbm_uint argn) {
+  str_builder_t *sb;
+  if (argn < 1 || !(sb = dec_str_builder(args[0]))) {
+    return ENC_SYM_TERROR;
+  }
+  lbm_uint len = sb->len;
+  for (lbm_uint i = 1; i < argn; i ++) {
+    lbm_value r = sb_append_value(sb, args[i]);
+    if (r != ENC_SYM_TRUE) {
+      // Roll back so that a retry after GC does not append twice.
+      sb->len = len;
+      if (sb->data) sb->data[len] = 0;
+      return r;
     }
-    if (chars >= max) {
-      str_ofs += max;
-    } else {
-      str_ofs += chars;
-      }
   }
+  return args[0];
+}
 
-  lbm_value res;
-  if (lbm_create_array(&res, (lbm_uint)str_ofs + 1)) {
-    lbm_array_header_t *arr = (lbm_array_header_t*)lbm_car(res);
-    strncpy((char*)arr->data, str, (unsigned int)str_ofs + 1);
-    lbm_free(str);
-    return res;
-  } else {
-    lbm_free(str);
-    return ENC_SYM_MERROR;
+// signature: (sb-len builder) -> int
+static lbm_value ext_sb_len(lbm_value *args, lbm_uint argn) {
+  str_builder_t *sb;
+  if (argn != 1 || !(sb = dec_str_builder(args[0]))) {
+    return ENC_SYM_TERROR;
+  }
+  return lbm_enc_i((lbm_int)sb->len);
+}
+
+// signature: (sb-finish builder) -> str
+static lbm_value ext_sb_finish(lbm_value *args, lbm_uint argn) {
+  str_builder_t *sb;
+  if (argn != 1 || !(sb = dec_str_builder(args[0]))) {
+    return ENC_SYM_TERROR;
+  }
+  return sb_finish(sb);
+}
+
+static lbm_value to_str(char *delimiter, int delim_len, lbm_value *args, lbm_uint argn) {
+  str_builder_t sb = {NULL, 0, 0};
+  lbm_value r = ENC_SYM_TRUE;
+
+  for (lbm_uint i = 0; i < argn && r == ENC_SYM_TRUE; i ++) {
+    if (i > 0 && !sb_append_chars(&sb, delimiter, (lbm_uint)delim_len)) {
+      r = ENC_SYM_MERROR;
+    } else {
+      r = sb_append_value(&sb, args[i]);
+    }
+  }
+  if (r == ENC_SYM_TRUE) {
+    r = sb_finish(&sb);
   }
+  if (sb.data) lbm_free(sb.data);
+  return r;
 }
 
 static lbm_value ext_to_str(lbm_value *args, lbm_uint argn) {
-  return to_str(" ", args, argn);
+  return to_str(" ", 1, args, argn);
 }
 
 static lbm_value ext_to_str_delim(lbm_value *args, lbm_uint argn) {
@@ -532,12 +790,13 @@ static lbm_value ext_to_str_delim(lbm_value *args, lbm_uint argn) {
     return ENC_SYM_EERROR;
   }
 
-  char *delim = lbm_dec_str(args[0]);
-  if (!delim) {
+  size_t delim_arr_size = 0;
+  char *delim = NULL;
+  if (!dec_str_size(args[0], &delim, &delim_arr_size)) {
     return ENC_SYM_TERROR;
   }
 
-  return to_str(delim, args + 1, argn - 1);
+  return to_str(delim, (int)strlen_max(delim, delim_arr_size), args + 1, argn - 1);
 }
 
 static lbm_value ext_str_len(lbm_value *args, lbm_uint argn) {
@@ -616,7 +875,7 @@ static lbm_value ext_str_find(lbm_value *args, lbm_uint argn) {
       }
       lbm_array_header_t *header = (lbm_array_header_t *)lbm_car(args[1]);
 
-      lbm_int len = (lbm_int)header->size - 1;
+      lbm_int len = str_array_len(args[1], header);
       if (len < 0) {
         // substr is zero length array
         return lbm_enc_i(-1);
@@ -627,7 +886,7 @@ static lbm_value ext_str_find(lbm_value *args, lbm_uint argn) {
         lbm_value car_val = lbm_car(current);
         lbm_array_header_t *header = lbm_dec_array_r(car_val);
         if (header) {
-          lbm_int len = (lbm_int)header->size - 1;
+          lbm_int len = str_array_len(car_val, header);
           if (len < 0) {
             // substr is zero length array
             continue;
@@ -683,7 +942,7 @@ static lbm_value ext_str_find(lbm_value *args, lbm_uint argn) {
     if (start < 0) {
       // start: -1 starts the search at the character index before the final null
       // byte index.
-      start = str_size - 1 + start;
+      start = str_array_len(args[0], str_header) + start;
     }
 
     if (!to_right && (start > str_size - min_substr_len)) {
@@ -693,11 +952,32 @@ static lbm_value ext_str_find(lbm_value *args, lbm_uint argn) {
       start = 0;
     }
 
+    if (to_right && case_sensitive &&
+        lbm_is_cons(substrings) &&
+        lbm_cdr(substrings) == ENC_SYM_NIL &&
+        min_substr_len > 0) {
+      // Single substring searched left to right.
+      lbm_array_header_t *header = (lbm_array_header_t *)lbm_car(lbm_car(substrings));
+      const char *substr = (const char *)header->data;
+      lbm_int i = start;
+      while (i <= str_size - min_substr_len) {
+        char *m = str_search((char *)str + i, (size_t)(str_size - i), substr, (size_t)min_substr_len);
+        if (!m) break;
+        i = (lbm_int)(m - str);
+        if (occurrence == 0) {
+          return lbm_enc_i(i);
+        }
+        occurrence -= 1;
+        i ++;
+      }
+      return lbm_enc_i(-1);
+    }
+
     lbm_int dir = to_right ? 1 : -1;
     for (lbm_int i = start; to_right ? (i <= str_size - min_substr_len) : (i >= 0); i += dir) {
       for (lbm_value current = substrings; lbm_is_cons(current); current = lbm_cdr(current)) {
         lbm_array_header_t *header = (lbm_array_header_t *)lbm_car(lbm_car(current));
-        lbm_int substr_len         = (lbm_int)header->size - 1;
+        lbm_int substr_len         = str_array_len(lbm_car(current), header);
         const char *substr         = (const char *)header->data;
 
         if (
@@ -724,6 +1004,174 @@ static lbm_value ext_str_find(lbm_value *args, lbm_uint argn) {
   }
 }
 
+// Aho-Corasick automaton used by str-find-any. The trie is stored as
+// first child / next sibling lists to keep the nodes small. Node 0 is
+// the root.
+typedef struct {
+  uint32_t child;
+  uint32_t next;
+  uint32_t fail;
+  uint32_t dict;   // Closest node on the fail chain that ends a pattern.
+  int32_t pattern; // Index of the pattern ending at this node or -1.
+  uint8_t c;
+} ac_node_t;
+
+static uint32_t ac_goto(ac_node_t *nodes, uint32_t n, uint8_t c) {
+  for (uint32_t ch = nodes[n].child; ch; ch = nodes[ch].next) {
+    if (nodes[ch].c == c) return ch;
+  }
+  return 0;
+}
+
+static uint8_t ac_char(char c, bool case_sensitive) {
+  return (uint8_t)(case_sensitive ? c : tolower(c));
+}
+
+// signature: (str-find-any str patterns [start] ['nocase]) -> (index . pattern-index) | nil
+// Returns the leftmost match. When several patterns match at the same
+// index the one appearing first in the pattern list is reported.
+static lbm_value ext_str_find_any(lbm_value *args, lbm_uint argn) {
+  if (argn < 2 || argn > 4) {
+    lbm_set_error_reason((char *)lbm_error_str_num_args);
+    return ENC_SYM_EERROR;
+  }
+  lbm_array_header_t *str_header = lbm_dec_array_r(args[0]);
+  if (!str_header || !lbm_is_list(args[1])) {
+    lbm_set_error_reason((char *)lbm_error_str_incorrect_arg);
+    return ENC_SYM_TERROR;
+  }
+
+  lbm_int start = 0;
+  bool case_sensitive = true;
+  for (lbm_uint i = 2; i < argn; i ++) {
+    if (lbm_is_number(args[i])) {
+      start = lbm_dec_as_int(args[i]);
+    } else if (lbm_is_symbol(args[i]) && lbm_dec_sym(args[i]) == sym_case_insensitive) {
+      case_sensitive = false;
+    } else {
+      lbm_set_error_suspect(args[i]);
+      lbm_set_error_reason((char *)lbm_error_str_incorrect_arg);
+      return ENC_SYM_TERROR;
+    }
+  }
+
+  lbm_uint num_patterns = 0;
+  lbm_uint total_len = 0;
+  lbm_int max_len = 0;
+  for (lbm_value curr = args[1]; lbm_is_cons(curr); curr = lbm_cdr(curr)) {
+    lbm_array_header_t *h = lbm_dec_array_r(lbm_car(curr));
+    if (!h) {
+      lbm_set_error_suspect(args[1]);
+      lbm_set_error_reason((char *)lbm_error_str_incorrect_arg);
+      return ENC_SYM_TERROR;
+    }
+    lbm_int len = str_array_len(lbm_car(curr), h);
+    if (len > 0) {
+      total_len += (lbm_uint)len;
+      if (len > max_len) max_len = len;
+    }
+    num_patterns ++;
+  }
+
+  lbm_int str_len = str_array_len(args[0], str_header);
+  if (start < 0) start = 0;
+  if (max_len == 0 || start >= str_len) return ENC_SYM_NIL;
+
+  lbm_uint num_nodes = total_len + 1;
+  ac_node_t *nodes = lbm_malloc(num_nodes * sizeof(ac_node_t));
+  lbm_int *lens = lbm_malloc(num_patterns * sizeof(lbm_int));
+  if (!nodes || !lens) {
+    if (nodes) lbm_free(nodes);
+    if (lens) lbm_free(lens);
+    return ENC_SYM_MERROR;
+  }
+  memset(nodes, 0, sizeof(ac_node_t));
+  nodes[0].pattern = -1;
+  uint32_t used = 1;
+
+  // Build the trie
+  lbm_uint p = 0;
+  for (lbm_value curr = args[1]; lbm_is_cons(curr); curr = lbm_cdr(curr), p ++) {
+    lbm_array_header_t *h = (lbm_array_header_t *)lbm_car(lbm_car(curr));
+    const char *pat = (const char *)h->data;
+    lbm_int len = str_array_len(lbm_car(curr), h);
+    lens[p] = len;
+    if (len <= 0) continue;
+    uint32_t n = 0;
+    for (lbm_int i = 0; i < len; i ++) {
+      uint8_t c = ac_char(pat[i], case_sensitive);
+      uint32_t next = ac_goto(nodes, n, c);
+      if (!next) {
+        next = used++;
+        memset(&nodes[next], 0, sizeof(ac_node_t));
+        nodes[next].pattern = -1;
+        nodes[next].c = c;
+        nodes[next].next = nodes[n].child;
+        nodes[n].child = next;
+      }
+      n = next;
+    }
+    if (nodes[n].pattern < 0) nodes[n].pattern = (int32_t)p;
+  }
+
+  // Breadth first computation of fail and dictionary links. The fail
+  // field of the nodes in the queue is not yet needed by the nodes
+  // behind them so the queue is stored in a separate array.
+  uint32_t *queue = lbm_malloc(used * sizeof(uint32_t));
+  if (!queue) {
+    lbm_free(nodes);
+    lbm_free(lens);
+    return ENC_SYM_MERROR;
+  }
+  uint32_t q_head = 0;
+  uint32_t q_tail = 0;
+  for (uint32_t ch = nodes[0].child; ch; ch = nodes[ch].next) {
+    queue[q_tail++] = ch;
+  }
+  while (q_head < q_tail) {
+    uint32_t u = queue[q_head++];
+    for (uint32_t v = nodes[u].child; v; v = nodes[v].next) {
+      uint32_t f = nodes[u].fail;
+      uint32_t g;
+      while (!(g = ac_goto(nodes, f, nodes[v].c)) && f) {
+        f = nodes[f].fail;
+      }
+      nodes[v].fail = g;
+      nodes[v].dict = nodes[g].pattern >= 0 ? g : nodes[g].dict;
+      queue[q_tail++] = v;
+    }
+  }
+  lbm_free(queue);
+
+  // Scan
+  const char *str = (const char *)str_header->data;
+  lbm_int best = -1;
+  int32_t best_pattern = -1;
+  uint32_t s = 0;
+  for (lbm_int j = start; j < str_len; j ++) {
+    if (best >= 0 && j - max_len + 1 > best) break;
+    uint8_t c = ac_char(str[j], case_sensitive);
+    uint32_t g;
+    while (!(g = ac_goto(nodes, s, c)) && s) {
+      s = nodes[s].fail;
+    }
+    s = g;
+    for (uint32_t o = nodes[s].pattern >= 0 ? s : nodes[s].dict; o; o = nodes[o].dict) {
+      int32_t pat = nodes[o].pattern;
+      lbm_int pos = j - lens[pat] + 1;
+      if (best < 0 || pos < best || (pos == best && pat < best_pattern)) {
+        best = pos;
+        best_pattern = pat;
+      }
+    }
+  }
+  lbm_free(nodes);
+  lbm_free(lens);
+
+  if (best < 0) return ENC_SYM_NIL;
+  return lbm_cons(lbm_enc_i(best), lbm_enc_i(best_pattern));
+}
+
 void lbm_string_extensions_init(void) {
 
   lbm_add_symbol_const("left", &sym_left);
@@ -734,7 +1182,9 @@ void lbm_string_extensions_init(void) {
   lbm_add_extension("str-to-i", ext_str_to_i);
   lbm_add_extension("str-to-f", ext_str_to_f);
   lbm_add_extension("str-part", ext_str_part);
+  lbm_add_extension("str-view", ext_str_view);
   lbm_add_extension("str-split", ext_str_split);
+  lbm_add_extension("str-split-view", ext_str_split_view);
   lbm_add_extension("str-replace", ext_str_replace);
   lbm_add_extension("str-to-lower", ext_str_to_lower);
   lbm_add_extension("str-to-upper", ext_str_to_upper);
@@ -744,4 +1194,9 @@ void lbm_string_extensions_init(void) {
   lbm_add_extension("str-len", ext_str_len);
   lbm_add_extension("str-replicate", ext_str_replicate);
   lbm_add_extension("str-find", ext_str_find);
+  lbm_add_extension("str-find-any", ext_str_find_any);
+  lbm_add_extension("sb-create", ext_sb_create);
+  lbm_add_extension("sb-append", ext_sb_append);
+  lbm_add_extension("sb-len", ext_sb_len);
+  lbm_add_extension("sb-finish", ext_sb_finish);
 }
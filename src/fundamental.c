@@ -215,8 +215,21 @@ static bool bytearray_equality(lbm_value a, lbm_value b) {
   // A NULL array arriving here should be impossible.
   // if the a and b are not valid arrays at this point, the data
   // is most likely nonsense - corrupted by cosmic radiation.
-  if ((a_ && b_) && a_->size == b_->size) {
-    res = (memcmp((char*)a_->data, (char*)b_->data, a_->size) == 0);
+  if (a_ && b_) {
+    lbm_uint a_size = a_->size;
+    lbm_uint b_size = b_->size;
+    // A string view lacks the terminating zero of the string it is
+    // compared to.
+    if (a_size == b_size + 1 && lbm_is_array_view(b) &&
+        ((char*)a_->data)[b_size] == 0) {
+      a_size = b_size;
+    } else if (b_size == a_size + 1 && lbm_is_array_view(a) &&
+               ((char*)b_->data)[a_size] == 0) {
+      b_size = a_size;
+    }
+    if (a_size == b_size) {
+      res = (memcmp((char*)a_->data, (char*)b_->data, a_size) == 0);
+    }
   }
   return res;
 }
@@ -256,8 +269,9 @@ bool struct_eq(lbm_value a, lbm_value b) {
     case LBM_TYPE_CHAR:
       res = (lbm_dec_char(a) == lbm_dec_char(b)); break;
     case LBM_TYPE_CONS:
-      res = ( struct_eq(lbm_car(a),lbm_car(b)) &&
-              struct_eq(lbm_cdr(a),lbm_cdr(b)) ); break;
+      res = ( a == b ||
+              (struct_eq(lbm_car(a),lbm_car(b)) &&
+               struct_eq(lbm_cdr(a),lbm_cdr(b))) ); break;
     case LBM_TYPE_I32:
       res = (lbm_dec_i32(a) == lbm_dec_i32(b)); break;
     case LBM_TYPE_U32:
@@ -1448,7 +1462,8 @@ static lbm_value fundamental_is_string(lbm_value *args, lbm_uint argn, eval_cont
   lbm_value res = ENC_SYM_TERROR;
   if (argn == 1) {
     char *str;
-    res = lbm_value_is_printable_string(args[0], &str) ? ENC_SYM_TRUE : ENC_SYM_NIL;
+    lbm_uint len;
+    res = lbm_value_is_printable_string_len(args[0], &str, &len) ? ENC_SYM_TRUE : ENC_SYM_NIL;
   }
   return res;
 }
@@ -1467,6 +1482,86 @@ static lbm_value fundamental_is_constant(lbm_value *args, lbm_uint argn, eval_co
   return res;
 }
 
+// (zip xs ys) pairs up elements until either list runs out.
+static lbm_value fundamental_zip(lbm_value *args, lbm_uint argn, eval_context_t *ctx) {
+  (void) ctx;
+  if (argn != 2 || !lbm_is_list(args[0]) || !lbm_is_list(args[1])) {
+    return ENC_SYM_TERROR;
+  }
+  lbm_uint n = 0;
+  lbm_value xs = args[0];
+  lbm_value ys = args[1];
+  while (lbm_is_cons(xs) && lbm_is_cons(ys)) {
+    xs = lbm_cdr(xs);
+    ys = lbm_cdr(ys);
+    n ++;
+  }
+  if (2 * n > lbm_heap_num_free()) {
+    return ENC_SYM_MERROR;
+  }
+  lbm_value res = ENC_SYM_NIL;
+  lbm_value last = ENC_SYM_NIL;
+  xs = args[0];
+  ys = args[1];
+  for (lbm_uint i = 0; i < n; i ++) {
+    lbm_value cell = lbm_cons(lbm_cons(lbm_car(xs), lbm_car(ys)), ENC_SYM_NIL);
+    if (lbm_is_symbol_nil(last)) {
+      res = cell;
+    } else {
+      lbm_set_cdr(last, cell);
+    }
+    last = cell;
+    xs = lbm_cdr(xs);
+    ys = lbm_cdr(ys);
+  }
+  return res;
+}
+
+static lbm_value fundamental_list_to_array(lbm_value *args, lbm_uint argn, eval_context_t *ctx) {
+  (void) ctx;
+  if (argn != 1 || !lbm_is_list(args[0])) {
+    return ENC_SYM_TERROR;
+  }
+  lbm_uint n = lbm_list_length(args[0]);
+  lbm_value res;
+  if (!lbm_heap_allocate_lisp_array(&res, n)) {
+    return ENC_SYM_MERROR;
+  }
+  lbm_value *data = (lbm_value*)((lbm_array_header_t*)lbm_car(res))->data;
+  lbm_value curr = args[0];
+  for (lbm_uint i = 0; i < n; i ++) {
+    data[i] = lbm_car(curr);
+    curr = lbm_cdr(curr);
+  }
+  return res;
+}
+
+// Elements of a byte array are returned as bytes, as by ix.
+static lbm_value fundamental_array_to_list(lbm_value *args, lbm_uint argn, eval_context_t *ctx) {
+  (void) ctx;
+  if (argn != 1) {
+    return ENC_SYM_TERROR;
+  }
+  lbm_array_header_t *arr;
+  bool lisp_array = true;
+  if (!(arr = lbm_dec_lisp_array_r(args[0]))) {
+    if (!(arr = lbm_dec_array_r(args[0]))) {
+      return ENC_SYM_TERROR;
+    }
+    lisp_array = false;
+  }
+  lbm_uint n = lisp_array ? arr->size / sizeof(lbm_value) : arr->size;
+  if (n > lbm_heap_num_free()) {
+    return ENC_SYM_MERROR;
+  }
+  lbm_value res = ENC_SYM_NIL;
+  for (lbm_uint i = n; i > 0; i --) {
+    lbm_value v = lisp_array ? ((lbm_value*)arr->data)[i-1] : lbm_enc_char(((uint8_t*)arr->data)[i-1]);
+    res = lbm_cons(v, res);
+  }
+  return res;
+}
+
 const fundamental_fun fundamental_table[] =
   {fundamental_add,
    fundamental_sub,
@@ -1535,5 +1630,8 @@ const fundamental_fun fundamental_table[] =
    fundamental_identity,
    fundamental_array,
    fundamental_is_string,
-   fundamental_is_constant
+   fundamental_is_constant,
+   fundamental_zip,
+   fundamental_list_to_array,
+   fundamental_array_to_list
   };
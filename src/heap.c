@@ -63,17 +63,17 @@ static inline lbm_value lbm_clr_gc_flag(lbm_value x) {
 }
 
 
-lbm_heap_state_t lbm_heap_state;
+LBM_INSTANCE_LOCAL lbm_heap_state_t lbm_heap_state;
 
-lbm_const_heap_t *lbm_const_heap_state;
+LBM_INSTANCE_LOCAL lbm_const_heap_t *lbm_const_heap_state;
 
-lbm_cons_t *lbm_heaps[2] = {NULL, NULL};
+LBM_INSTANCE_LOCAL lbm_cons_t *lbm_heaps[2] = {NULL, NULL};
 
-static mutex_t lbm_const_heap_mutex;
-static bool    lbm_const_heap_mutex_initialized = false;
+static LBM_INSTANCE_LOCAL mutex_t lbm_const_heap_mutex;
+static LBM_INSTANCE_LOCAL bool    lbm_const_heap_mutex_initialized = false;
 
-static mutex_t lbm_mark_mutex;
-static bool    lbm_mark_mutex_initialized = false;
+static LBM_INSTANCE_LOCAL mutex_t lbm_mark_mutex;
+static LBM_INSTANCE_LOCAL bool    lbm_mark_mutex_initialized = false;
 
 #ifdef USE_GC_PTR_REV
 void lbm_gc_lock(void) {
@@ -241,6 +241,11 @@ char *lbm_dec_str(lbm_value val) {
     lbm_array_header_t *array = (lbm_array_header_t *)lbm_car(val);
     if (array) {
       res = (char *)array->data;
+      // A view into the middle of a string has no terminating zero.
+      if (lbm_cdr(val) == ENC_SYM_ARRAY_VIEW_TYPE &&
+          (array->size == 0 || res[array->size - 1] != 0)) {
+        res = 0;
+      }
     }
   }
   return res;
@@ -746,6 +751,10 @@ void lbm_gc_mark_phase_nm(lbm_value root) {
         for (size_t i = 0; i < arr_size; i ++) {
           lbm_gc_mark_phase_nm(arr_data[i]);
         }
+      } else if (lbm_type_of(curr) == LBM_TYPE_ARRAY &&
+                 lbm_clr_gc_mark(cell->cdr) == ENC_SYM_ARRAY_VIEW_TYPE) {
+        lbm_array_header_view_t *view = (lbm_array_header_view_t*)cell->car;
+        lbm_gc_mark_phase_nm(view->parent);
       }
       // Will jump out next iteration as gc mark is set in curr.
     }
@@ -865,6 +874,13 @@ void lbm_gc_mark_phase(lbm_value root) {
         goto mark_shortcut;
       }
       continue;
+    } else if (t_ptr == LBM_TYPE_ARRAY &&
+               cell->cdr == ENC_SYM_ARRAY_VIEW_TYPE) {
+      // A view keeps the array it refers into alive.
+      cell->cdr = lbm_set_gc_mark(cell->cdr);
+      lbm_heap_state.gc_marked ++;
+      curr = ((lbm_array_header_view_t*)cell->car)->parent;
+      goto mark_shortcut;
     }
 
     cell->cdr = lbm_set_gc_mark(cell->cdr);
@@ -944,6 +960,8 @@ int lbm_gc_sweep_phase(void) {
         case ENC_SYM_DEFRAG_ARRAY_TYPE:
           lbm_defrag_mem_free((lbm_uint*)heap[i].car);
           break;
+        case ENC_SYM_VECTOR_TYPE: /* fall through */
+        case ENC_SYM_PERSISTENT_TYPE: /* fall through */
         case ENC_SYM_LISPARRAY_TYPE: /* fall through */
         case ENC_SYM_ARRAY_TYPE:{
           lbm_array_header_t *arr = (lbm_array_header_t*)heap[i].car;
@@ -951,6 +969,11 @@ int lbm_gc_sweep_phase(void) {
           lbm_heap_state.gc_recovered_arrays++;
           lbm_memory_free((lbm_uint *)arr);
         } break;
+        case ENC_SYM_ARRAY_VIEW_TYPE:
+          // The data belongs to the parent array.
+          lbm_memory_free((lbm_uint*)heap[i].car);
+          lbm_heap_state.gc_recovered_arrays++;
+          break;
         case ENC_SYM_CHANNEL_TYPE:{
           lbm_char_channel_t *chan = (lbm_char_channel_t*)heap[i].car;
           lbm_memory_free((lbm_uint*)chan->state);
@@ -1277,6 +1300,47 @@ int lbm_heap_allocate_lisp_array(lbm_value *res, lbm_uint size) {
   return lbm_heap_allocate_array_base(res, false, size);
 }
 
+// A view is a byte array whose data pointer points into the data
+// of another byte array, the parent. The parent is stored in the view
+// header where GC finds it. Views of views are flattened so that the
+// parent is always an array that owns its data.
+// Defragmentable arrays may move and are not viewable.
+int lbm_heap_allocate_array_view(lbm_value *res, lbm_value parent, lbm_uint offset, lbm_uint size) {
+  lbm_array_header_t *parent_arr = lbm_dec_array_r(parent);
+  if (!parent_arr || offset > parent_arr->size || size > parent_arr->size - offset) {
+    *res = ENC_SYM_TERROR;
+    return 0;
+  }
+
+  lbm_value tag = lbm_cdr(parent);
+  if (tag == ENC_SYM_ARRAY_VIEW_TYPE) {
+    parent = ((lbm_array_header_view_t*)parent_arr)->parent;
+  } else if (tag != ENC_SYM_ARRAY_TYPE) {
+    *res = ENC_SYM_TERROR;
+    return 0;
+  }
+
+  return lbm_heap_allocate_foreign_array_view(res, parent, (uint8_t*)parent_arr->data + offset, size);
+}
+
+int lbm_heap_allocate_foreign_array_view(lbm_value *res, lbm_value owner, uint8_t *data, lbm_uint size) {
+  lbm_array_header_view_t *view = (lbm_array_header_view_t*)lbm_malloc(sizeof(lbm_array_header_view_t));
+  if (view) {
+    view->size = size;
+    view->data = (lbm_uint*)data;
+    view->parent = owner;
+    lbm_value cell = lbm_heap_allocate_cell(LBM_TYPE_ARRAY, (lbm_uint)view, ENC_SYM_ARRAY_VIEW_TYPE);
+    if (cell != ENC_SYM_MERROR) {
+      *res = cell;
+      lbm_heap_state.num_alloc_arrays ++;
+      return 1;
+    }
+    lbm_memory_free((lbm_uint*)view);
+  }
+  *res = ENC_SYM_MERROR;
+  return 0;
+}
+
 int lbm_lift_array(lbm_value *value, char *data, lbm_uint num_elt) {
 
   lbm_array_header_t *array = NULL;
@@ -1402,7 +1466,7 @@ static bool dummy_flash_write(lbm_uint ix, lbm_uint val) {
   return false;
 }
 
-static const_heap_write_fun const_heap_write = dummy_flash_write;
+static LBM_INSTANCE_LOCAL const_heap_write_fun const_heap_write = dummy_flash_write;
 
 int lbm_const_heap_init(const_heap_write_fun w_fun,
                         lbm_const_heap_t *heap,
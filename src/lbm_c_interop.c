@@ -73,7 +73,10 @@ lbm_cid eval_cps_load_and_eval(lbm_char_channel_t *tokenizer, bool program, bool
       lbm_type_of(start_prg) != LBM_TYPE_CONS ) {
     return -1;
   }
-  return lbm_create_ctx(start_prg, ENC_SYM_NIL, 256, name);
+  if (read_mode == ENC_SYM_READ_AND_EVAL_PROGRAM) {
+    return lbm_create_ctx(start_prg, ENC_SYM_NIL, 256, name);
+  }
+  return lbm_create_load_ctx(start_prg, ENC_SYM_NIL, 256, name);
 }
 
 lbm_cid eval_cps_load_and_define(lbm_char_channel_t *tokenizer, char *symbol, bool program) {
@@ -15,9 +15,10 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include <lbm_types.h>
 #include <lbm_flags.h>
 
-static volatile uint32_t lbm_flags;
+static LBM_INSTANCE_LOCAL volatile uint32_t lbm_flags;
 
 uint32_t lbm_get_flags(void) {
   return lbm_flags;
@@ -241,7 +241,7 @@ bool f_lbm_array(lbm_flat_value_t *v, uint32_t num_bytes, uint8_t *data) {
   return res;
 }
 
-static int flatten_maximum_depth = FLATTEN_VALUE_MAXIMUM_DEPTH;
+static LBM_INSTANCE_LOCAL int flatten_maximum_depth = FLATTEN_VALUE_MAXIMUM_DEPTH;
 
 void lbm_set_max_flatten_depth(int depth) {
   flatten_maximum_depth = depth;
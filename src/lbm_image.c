@@ -148,13 +148,13 @@
 #define DOWNWARDS true
 #define UPWARDS   false
 
-static lbm_image_write_fun image_write = NULL;
+static LBM_INSTANCE_LOCAL lbm_image_write_fun image_write = NULL;
 
-static uint32_t *image_address = NULL;
-static int32_t write_index = 0;
-static uint32_t image_size = 0;
-static bool image_has_extensions = false;
-static char* image_version = NULL;
+static LBM_INSTANCE_LOCAL uint32_t *image_address = NULL;
+static LBM_INSTANCE_LOCAL int32_t write_index = 0;
+static LBM_INSTANCE_LOCAL uint32_t image_size = 0;
+static LBM_INSTANCE_LOCAL bool image_has_extensions = false;
+static LBM_INSTANCE_LOCAL char* image_version = NULL;
 
 uint32_t *lbm_image_get_image(void) {
   return image_address;
@@ -211,8 +211,8 @@ bool write_u64(uint64_t dw, int32_t *i, bool direction) {
 
 // fv_write function write values as big endian.
 
-uint32_t fv_buf_ix = 0;
-uint8_t  fv_buf[4] = {0};
+LBM_INSTANCE_LOCAL uint32_t fv_buf_ix = 0;
+LBM_INSTANCE_LOCAL uint8_t  fv_buf[4] = {0};
 bool fv_write_u8(uint8_t b) {
   bool r = true;
   if (fv_buf_ix >= 4) {
@@ -532,8 +532,8 @@ char *lbm_image_get_version(void) {
 // ////////////////////////////////////////////////////////////
 // Constant heaps as part of an image.
 
-lbm_const_heap_t image_const_heap;
-lbm_uint image_const_heap_start_ix = 0;
+LBM_INSTANCE_LOCAL lbm_const_heap_t image_const_heap;
+LBM_INSTANCE_LOCAL lbm_uint image_const_heap_start_ix = 0;
 
 bool image_const_heap_write(lbm_uint w, lbm_uint ix) {
 #ifdef LBM64
@@ -684,7 +684,7 @@ bool lbm_image_save_extensions(void) {
   return true;
 }
 
-static uint32_t last_const_heap_ix = 0;
+static LBM_INSTANCE_LOCAL uint32_t last_const_heap_ix = 0;
 
 bool lbm_image_save_constant_heap_ix(void) {
   bool r = true; // saved or no need to save it.
@@ -39,17 +39,17 @@ void lbm_request_gc(void);
 #define ALLOC_DONE           0xF00DF00D
 #define ALLOC_FAILED         0xDEADBEAF
 
-static lbm_uint *bitmap = NULL;
-static lbm_uint *memory = NULL;
-static lbm_uint memory_size;  // in 4 or 8 byte words depending on 32 or 64 bit platform
-static lbm_uint bitmap_size;  // in 4 or 8 byte words
-static lbm_uint memory_base_address = 0;
-static lbm_uint memory_num_free = 0;
-static lbm_uint memory_min_free = 0;
-static volatile lbm_uint memory_reserve_level = 0;
-static mutex_t lbm_mem_mutex;
-static bool    lbm_mem_mutex_initialized;
-static lbm_uint alloc_offset = 0;
+static LBM_INSTANCE_LOCAL lbm_uint *bitmap = NULL;
+static LBM_INSTANCE_LOCAL lbm_uint *memory = NULL;
+static LBM_INSTANCE_LOCAL lbm_uint memory_size;  // in 4 or 8 byte words depending on 32 or 64 bit platform
+static LBM_INSTANCE_LOCAL lbm_uint bitmap_size;  // in 4 or 8 byte words
+static LBM_INSTANCE_LOCAL lbm_uint memory_base_address = 0;
+static LBM_INSTANCE_LOCAL lbm_uint memory_num_free = 0;
+static LBM_INSTANCE_LOCAL lbm_uint memory_min_free = 0;
+static LBM_INSTANCE_LOCAL volatile lbm_uint memory_reserve_level = 0;
+static LBM_INSTANCE_LOCAL mutex_t lbm_mem_mutex;
+static LBM_INSTANCE_LOCAL bool    lbm_mem_mutex_initialized;
+static LBM_INSTANCE_LOCAL lbm_uint alloc_offset = 0;
 
 int lbm_memory_init(lbm_uint *data, lbm_uint data_size,
                     lbm_uint *bits, lbm_uint bits_size) {
@@ -18,16 +18,16 @@
 #include "lbm_prof.h"
 #include "platform_mutex.h"
 
-static lbm_uint num_samples = 0;
-static lbm_uint num_system_samples = 0;
-static lbm_uint num_sleep_samples = 0;
-extern eval_context_t *ctx_running;
-extern mutex_t qmutex;
-extern bool    qmutex_initialized;
-extern volatile bool lbm_system_sleeping;
+static LBM_INSTANCE_LOCAL lbm_uint num_samples = 0;
+static LBM_INSTANCE_LOCAL lbm_uint num_system_samples = 0;
+static LBM_INSTANCE_LOCAL lbm_uint num_sleep_samples = 0;
+extern LBM_INSTANCE_LOCAL eval_context_t *ctx_running;
+extern LBM_INSTANCE_LOCAL mutex_t qmutex;
+extern LBM_INSTANCE_LOCAL bool    qmutex_initialized;
+extern LBM_INSTANCE_LOCAL volatile bool lbm_system_sleeping;
 
-static lbm_prof_t *prof_data;
-static lbm_uint    prof_data_num;
+static LBM_INSTANCE_LOCAL lbm_prof_t *prof_data;
+static LBM_INSTANCE_LOCAL lbm_uint    prof_data_num;
 
 #define TRUNC_SIZE(N) (((N) > LBM_PROF_MAX_NAME_SIZE -1) ? LBM_PROF_MAX_NAME_SIZE-1 : N)
 
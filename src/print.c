@@ -39,8 +39,8 @@
 #define CONTINUE_ARRAY 8
 #define END_ARRAY      9
 
-static lbm_stack_t print_stack = { NULL, 0, 0};
-static bool print_has_stack = false;
+static LBM_INSTANCE_LOCAL lbm_stack_t print_stack = { NULL, 0, 0};
+static LBM_INSTANCE_LOCAL bool print_has_stack = false;
 
 const char *failed_str = "Error: print failed\n";
 
@@ -79,6 +79,27 @@ bool lbm_value_is_printable_string(lbm_value v, char **str) {
   return is_a_string;
 }
 
+bool lbm_value_is_printable_string_len(lbm_value v, char **str, lbm_uint *len) {
+  lbm_array_header_t *array = lbm_dec_array_r(v);
+  if (array && lbm_is_array_view(v) && array->size > 0 &&
+      ((char*)array->data)[array->size - 1] != 0) {
+    char *c_data = (char *)array->data;
+    for (unsigned int i = 0; i < array->size; i ++) {
+      if (!isprint((unsigned char)c_data[i]) && ((c_data[i] < 8) || c_data[i] > 13)) {
+        return false;
+      }
+    }
+    *str = c_data;
+    *len = array->size;
+    return true;
+  }
+  if (lbm_value_is_printable_string(v, str)) {
+    *len = (lbm_uint)strlen(*str);
+    return true;
+  }
+  return false;
+}
+
 static int push_n(lbm_stack_t *s, lbm_uint *values, lbm_uint n) {
   if (s->sp + n < s->size) {
     for (lbm_uint i = 0; i < n; i ++) {
@@ -140,10 +161,10 @@ static int emit_escape(lbm_char_channel_t *chan, char c) {
   }
 }
 
-static int print_emit_string_value(lbm_char_channel_t *chan, char* str) {
+static int print_emit_string_value(lbm_char_channel_t *chan, char* str, lbm_uint len) {
   if (str == NULL) return EMIT_FAILED;
-  while (*str != 0) {
-    int r = emit_escape(chan, *str++);
+  for (lbm_uint i = 0; i < len; i ++) {
+    int r = emit_escape(chan, str[i]);
     if (r != EMIT_OK) return r;
   }
   return EMIT_OK;
@@ -261,12 +282,13 @@ static int print_emit_array_data(lbm_char_channel_t *chan, lbm_array_header_t *a
 static int print_emit_bytearray(lbm_char_channel_t *chan, lbm_value v) {
   int r = 0;
   char *str;
+  lbm_uint len;
   lbm_array_header_t *array = lbm_dec_array_r(v);
   if (array) {
-    if (lbm_value_is_printable_string(v, &str)) {
+    if (lbm_value_is_printable_string_len(v, &str, &len)) {
       r = print_emit_char(chan, '"');
       if (r == EMIT_OK) {
-        r = print_emit_string_value(chan, str);
+        r = print_emit_string_value(chan, str, len);
         if (r == EMIT_OK) {
           r = print_emit_char(chan, '"');
         }
@@ -511,3 +533,18 @@ int lbm_print_value(char *buf, unsigned int len, lbm_value v) {
     return 1;
   return 0;
 }
+
+int lbm_print_value_len(char *buf, unsigned int len, lbm_value v) {
+
+  lbm_string_channel_state_t st;
+  lbm_char_channel_t chan;
+
+  if (len == 0) return -1;
+  lbm_create_string_char_channel_size(&st, &chan, buf, len);
+  if (lbm_print_internal(&chan,v) == EMIT_OK) {
+    buf[st.write_pos] = 0;
+    return (int)st.write_pos;
+  }
+  if (st.write_pos >= len - 1) return -1;
+  return -2;
+}
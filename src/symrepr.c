@@ -82,7 +82,14 @@ special_sym const special_symbols[] =  {
   {"trap"         , SYM_TRAP},
   {"rest-args"    , SYM_REST_ARGS},
   {"rotate"       , SYM_ROTATE},
+  {"array-map"    , SYM_ARRAY_MAP},
+  {"array-fold"   , SYM_ARRAY_FOLD},
+  {"macroexpand-all", SYM_MACROEXPAND_ALL},
+  {"builtin-filter", SYM_FILTER},
+  {"builtin-foldl", SYM_FOLDL},
+  {"builtin-foldr", SYM_FOLDR},
   {"call-cc-unsafe", SYM_CALL_CC_UNSAFE},
+  {"call-cc-copy" , SYM_CALL_CC_COPY},
 
   // pattern matching
   {"?"          , SYM_MATCH_ANY},
@@ -115,6 +122,9 @@ special_sym const special_symbols[] =  {
   {"$nonsense"       , SYM_NONSENSE},
   {"$dm-array"       , SYM_DEFRAG_ARRAY_TYPE},
   {"$dm"             , SYM_DEFRAG_MEM_TYPE},
+  {"$barray-view"    , SYM_ARRAY_VIEW_TYPE},
+  {"$vector"         , SYM_VECTOR_TYPE},
+  {"$persistent"     , SYM_PERSISTENT_TYPE},
 
   // tokenizer symbols with unparsable names
   {"[openpar]"        , SYM_OPENPAR},
@@ -240,6 +250,9 @@ special_sym const special_symbols[] =  {
 
   {"identity"       , SYM_IDENTITY},
   {"array"          , SYM_ARRAY},
+  {"builtin-zip"    , SYM_ZIP},
+  {"builtin-list-to-array", SYM_LIST_TO_ARRAY},
+  {"builtin-array-to-list", SYM_ARRAY_TO_LIST},
 
   // aliases
   {"first"          , SYM_CAR},
@@ -255,12 +268,12 @@ special_sym const special_symbols[] =  {
 
 };
 
-static lbm_uint *symlist = NULL;
-static lbm_uint next_symbol_id = RUNTIME_SYMBOLS_START;
-static lbm_uint symbol_table_size_list = 0;
-static lbm_uint symbol_table_size_list_flash = 0;
-static lbm_uint symbol_table_size_strings = 0;
-static lbm_uint symbol_table_size_strings_flash = 0;
+static LBM_INSTANCE_LOCAL lbm_uint *symlist = NULL;
+static LBM_INSTANCE_LOCAL lbm_uint next_symbol_id = RUNTIME_SYMBOLS_START;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_table_size_list = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_table_size_list_flash = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_table_size_strings = 0;
+static LBM_INSTANCE_LOCAL lbm_uint symbol_table_size_strings_flash = 0;
 
 // When rebooting an image...
 void lbm_symrepr_set_symlist(lbm_uint *ls) {
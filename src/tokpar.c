@@ -29,7 +29,7 @@
 #include "env.h"
 
 // +1 to ensure there is always a zero at last ix
-char tokpar_sym_str[TOKENIZER_MAX_SYMBOL_AND_STRING_LENGTH+1];
+LBM_INSTANCE_LOCAL char tokpar_sym_str[TOKENIZER_MAX_SYMBOL_AND_STRING_LENGTH+1];
 
 typedef struct {
   const char *str;
@@ -0,0 +1,12 @@
+;; Escaping out of a trap with a call-cc continuation removes the trap.
+;; A later error in the same context is then an ordinary error and not
+;; reported as trapped. The runner fails the test if a fatal_error
+;; shows up in the output.
+(define c1 (spawn (fn () (progn (call-cc (lambda (k) (trap (k 1)))) (car 1)))))
+(define c2 (spawn (fn () (progn (call-cc-unsafe (lambda (k) (trap (trap (k 1))))) (car 1)))))
+(sleep 0.2)
+
+(define ok (eq (trap (progn (call-cc (lambda (k) (trap (k 1)))) (car 1)))
+               '(exit-error type_error)))
+
+(print (if ok "SUCCESS" "FAILURE"))
@@ -0,0 +1,12 @@
+;; repl-args: --expand_macros
+;; Code is macro expanded as it is loaded. Names in binding positions
+;; and match patterns that happen to name a macro are left alone.
+(defmacro inc1 (x) `(+ ,x 1))
+
+(define r1 (eq (let ((inc1 3)) inc1) 3))
+(define r2 (eq (progn (var inc1 (inc1 1)) inc1) 2))
+(define r3 (eq (match '(inc1 10) ((inc1 (? v)) (inc1 v)) (_ 0)) 11))
+(define r4 (eq (match '(inc1 10) ((inc1 . _) 1)) 1))
+(define r5 (eq (inc1 1) 2))
+
+(print (if (and r1 r2 r3 r4 r5) "SUCCESS" "FAILURE"))
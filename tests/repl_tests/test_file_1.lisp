@@ -0,0 +1,67 @@
+(define fname "repl_tests/tmp/file_1.txt")
+
+(define fw (fopen fname "w"))
+(define w1 (fwrite-str fw "hello\nworld"))
+(define w2 (fclose fw))
+
+;; fread with an offset into the buffer and a byte count.
+(define fr (fopen fname "r"))
+(define buf (bufcreate 8))
+(define n1 (fread fr buf 2 3))
+(define b1 (and (= (bufget-u8 buf 0) 0)
+                (= (bufget-u8 buf 1) 0)
+                (= (bufget-u8 buf 2) \#h)
+                (= (bufget-u8 buf 3) \#e)
+                (= (bufget-u8 buf 4) \#l)
+                (= (bufget-u8 buf 5) 0)))
+;; The count is clamped to the space left after the offset.
+(define n2 (fread fr buf 6 10))
+(define b2 (and (= (bufget-u8 buf 6) \#l) (= (bufget-u8 buf 7) \#o)))
+(define e1 (trap (fread fr buf 9)))
+(define w3 (fclose fr))
+
+;; fread-line splits at the delimiter and the last line has none.
+(define fl (fopen fname "r"))
+(define l1 (fread-line fl))
+(define l2 (fread-line fl))
+(define l3 (fread-line fl))
+(define w4 (fclose fl))
+
+(define fd (fopen fname "r"))
+(define d1 (fread-line fd \#o))
+(define d2 (fread-line fd \#o))
+(define d3 (fread-line fd \#o))
+(define d4 (fread-line fd \#o))
+(define w5 (fclose fd))
+
+;; An mmapped file is a read-only view of the file.
+(define m (fmmap fname))
+(define m1 (= (buflen m) 11))
+(define m2 (eq (trap (bufset-u8 m 0 \#H)) '(exit-error type_error)))
+(define m3 (= (bufget-u8 m 0) \#h))
+(define m4 (eq (fmmap "repl_tests/tmp/no_such_file") nil))
+
+;; Only open file handles are accepted.
+(define t1 (trap (fread 5 buf)))
+(define t2 (trap (fread-line 'a)))
+(define t3 (trap (fread fr buf)))
+(define t4 (trap (fwrite-str 1.5 "x")))
+
+(define ok (and w1 w2 w3 w4 w5
+                (= n1 3) b1
+                (= n2 2) b2
+                (eq e1 '(exit-error eval_error))
+                (eq l1 "hello")
+                (eq l2 "world")
+                (eq l3 nil)
+                (eq d1 "hell")
+                (eq d2 "\nw")
+                (eq d3 "rld")
+                (eq d4 nil)
+                m1 m2 m3 m4
+                (eq t1 '(exit-error type_error))
+                (eq t2 '(exit-error type_error))
+                (eq t3 '(exit-error type_error))
+                (eq t4 '(exit-error type_error))))
+
+(print (if ok "SUCCESS" "FAILURE"))
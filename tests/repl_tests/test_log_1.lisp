@@ -0,0 +1,78 @@
+(define fname "repl_tests/tmp/log_1.bin")
+
+;; A small buffer so that records are flushed while writing and the
+;; large one is written on its own.
+(define lw (log-open fname 64))
+(define w1 (log-write lw 1))
+(define w2 (log-write lw '(a b "str")))
+(define w3 (log-write lw (range 100)))
+(define w4 (log-flush lw))
+(define w5 (log-write lw 3.5))
+(define w6 (log-close lw))
+
+(define lr (log-reader fname))
+(define v1 (log-next lr))
+(define v2 (log-next lr))
+(define v3 (log-next lr))
+(define v4 (log-next lr))
+(define v5 (log-next lr))
+
+;; A reader that reaches a record that is only partly written returns
+;; eof and reads the whole record once the rest is there.
+(define ff (fopen fname "r"))
+(define all (load-file ff))
+(fclose ff)
+
+(define pname "repl_tests/tmp/log_1_partial.bin")
+(defun append-bytes (from to)
+  (let ((b (bufcreate (- to from)))
+        (f (fopen pname "a")))
+    (progn (bufcpy b 0 all from (- to from))
+           (fwrite f b)
+           (fclose f))))
+
+(append-bytes 0 2)
+(define pr (log-reader pname))
+(define p1 (log-next pr))
+(append-bytes 2 6)
+(define p2 (log-next pr))
+(append-bytes 6 (buflen all))
+(define p3 (log-next pr))
+(define p4 (log-next pr))
+
+;; Only log writers and readers are accepted.
+(define e1 (trap (log-next 5)))
+(define e2 (trap (log-write 5 1)))
+(define e3 (trap (log-flush 'a)))
+(define e4 (trap (log-next lw)))
+(define e5 (trap (log-write lw 1)))
+
+;; Writes to /dev/full fail, the records stay buffered and every flush
+;; reports the error.
+(define lf (log-open "/dev/full" 64))
+(define f1 (log-write lf 1))
+(define f2 (trap (log-flush lf)))
+(define f3 (trap (log-flush lf)))
+(define f4 (trap (log-close lf)))
+
+(define ok (and w1 w2 w3 w4 w5 w6
+                (= v1 1)
+                (eq v2 '(a b "str"))
+                (eq v3 (range 100))
+                (= v4 3.5)
+                (eq v5 'eof)
+                (eq p1 'eof)
+                (eq p2 'eof)
+                (= p3 1)
+                (eq p4 '(a b "str"))
+                (eq e1 '(exit-error type_error))
+                (eq e2 '(exit-error type_error))
+                (eq e3 '(exit-error type_error))
+                (eq e4 '(exit-error type_error))
+                (eq e5 '(exit-error type_error))
+                f1
+                (eq f2 '(exit-error eval_error))
+                (eq f3 '(exit-error eval_error))
+                (eq f4 '(exit-error eval_error))))
+
+(print (if ok "SUCCESS" "FAILURE"))
@@ -0,0 +1,48 @@
+#!/bin/bash
+
+# Tests for the extensions that only exist in the REPL, such as file
+# access and value logs. Each script in repl_tests is run by the REPL
+# and prints SUCCESS or FAILURE when it is done. Scripts create their
+# temporary files under repl_tests/tmp, which is removed afterwards.
+# A fatal_error in the output, from any context, fails the test.
+# A line ";; repl-args: ..." in a script adds arguments to the REPL.
+
+echo "BUILDING"
+
+make -C ../repl all64 > /dev/null || exit 1
+
+repl=../repl/repl
+tmpdir=repl_tests/tmp
+
+success_count=0
+fail_count=0
+failing_tests=()
+
+for exe in repl_tests/*.lisp; do
+    rm -rf $tmpdir
+    mkdir -p $tmpdir
+    args=$(sed -n 's/^;; repl-args: //p' $exe)
+    out=$(timeout 30 $repl -H 100000 -M 12 $args --src=$exe --terminate 2>&1)
+    if echo "$out" | grep -q "SUCCESS$" &&
+       ! echo "$out" | grep -q "fatal_error"; then
+        success_count=$((success_count+1))
+        echo "$exe SUCCESS"
+    else
+        fail_count=$((fail_count+1))
+        failing_tests+=("$exe")
+        echo "$exe FAILED"
+        echo "$out" | tail -n 20
+    fi
+done
+rm -rf $tmpdir
+
+echo "Tests passed: $success_count"
+echo "Tests failed: $fail_count"
+for t in "${failing_tests[@]}"; do
+    echo "    $t"
+done
+
+if [ $fail_count -gt 0 ]; then
+    exit 1
+fi
+exit 0
@@ -0,0 +1,178 @@
+/*
+    Copyright 2025 Joel Svensson        svenssonjoel@yahoo.se
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Runs many isolated lispBM instances concurrently, one per thread.
+// Must be built with -DLBM_INSTANCE_PER_THREAD. Each instance defines
+// a symbol no other instance knows about, gives a global its own value
+// and initializes the extensions while the other threads are running.
+// Build with -fsanitize=thread to check for shared state.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "lispbm.h"
+#include "lbm_image.h"
+#include "extensions/array_extensions.h"
+#include "extensions/string_extensions.h"
+#include "extensions/math_extensions.h"
+#include "extensions/checksum_extensions.h"
+
+#ifndef LBM_INSTANCE_PER_THREAD
+#error "test_instance_per_thread must be built with LBM_INSTANCE_PER_THREAD"
+#endif
+
+#define NUM_INSTANCES    32
+#define HEAP_SIZE        8192
+#define EXTENSION_SLOTS  300
+#define IMAGE_WORDS      (32 * 1024)
+#define RESULT_SIZE      256
+
+static _Thread_local uint32_t *image_storage;
+static _Thread_local lbm_cid program_cid;
+static _Thread_local char result[RESULT_SIZE];
+
+static bool image_write(uint32_t w, int32_t ix, bool const_heap) {
+  (void)const_heap;
+  image_storage[ix] = w;
+  return true;
+}
+
+static void sleep_callback(uint32_t us) {
+  struct timespec s;
+  s.tv_sec = us / 1000000;
+  s.tv_nsec = (long)(us % 1000000) * 1000;
+  nanosleep(&s, NULL);
+}
+
+static uint32_t timestamp_callback(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint32_t)(t.tv_sec * 1000000 + t.tv_nsec / 1000);
+}
+
+static void done_callback(eval_context_t *ctx) {
+  if (ctx->id == program_cid) {
+    lbm_print_value(result, RESULT_SIZE, ctx->r);
+    lbm_kill_eval();
+  }
+}
+
+static void critical_error(void) {
+  printf("CRITICAL ERROR\n");
+}
+
+static void *run_instance(void *arg) {
+  int id = (int)(long)arg;
+  bool ok = false;
+
+  lbm_uint *memory = malloc(sizeof(lbm_uint) * LBM_MEMORY_SIZE_16K);
+  lbm_uint *bitmap = malloc(sizeof(lbm_uint) * LBM_MEMORY_BITMAP_SIZE_16K);
+  lbm_cons_t *heap = malloc(sizeof(lbm_cons_t) * HEAP_SIZE);
+  lbm_extension_t *extensions = malloc(sizeof(lbm_extension_t) * EXTENSION_SLOTS);
+  image_storage = calloc(IMAGE_WORDS, sizeof(uint32_t));
+  if (!memory || !bitmap || !heap || !extensions || !image_storage) {
+    printf("instance %d: out of memory\n", id);
+    goto done;
+  }
+
+  if (!lbm_init(heap, HEAP_SIZE,
+                memory, LBM_MEMORY_SIZE_16K,
+                bitmap, LBM_MEMORY_BITMAP_SIZE_16K,
+                256, 256,
+                extensions, EXTENSION_SLOTS)) {
+    printf("instance %d: init failed\n", id);
+    goto done;
+  }
+  lbm_image_init(image_storage, IMAGE_WORDS, image_write);
+  lbm_image_create("instance");
+  if (!lbm_image_boot()) {
+    printf("instance %d: image boot failed\n", id);
+    goto done;
+  }
+  lbm_add_eval_symbols();
+  lbm_eval_init_events(20);
+
+  lbm_array_extensions_init();
+  lbm_string_extensions_init();
+  lbm_math_extensions_init();
+  lbm_checksum_extensions_init();
+
+  lbm_set_usleep_callback(sleep_callback);
+  lbm_set_timestamp_us_callback(timestamp_callback);
+  lbm_set_printf_callback(printf);
+  lbm_set_critical_error_callback(critical_error);
+  lbm_set_ctx_done_callback(done_callback);
+
+  char code[1024];
+  snprintf(code, sizeof(code),
+           "(define id %d)"
+           "(define only-in-%d 'me)"
+           "(define f (lambda (n) (if (< n 2) n (+ (f (- n 1)) (f (- n 2))))))"
+           "(define sum (lambda (n acc) (if (= n 0) acc (sum (- n 1) (+ acc (* n id))))))"
+           "(list id (f 18) (sum 999 0) (crc32 (array-slice \"123456789\" 0 9))"
+           "      (eval 'only-in-%d) (trap (eval 'only-in-%d)))",
+           id, id, id, (id + 1) % NUM_INSTANCES);
+
+  lbm_string_channel_state_t string_tok_state;
+  lbm_char_channel_t string_tok;
+  lbm_create_string_char_channel(&string_tok_state, &string_tok, code);
+  program_cid = lbm_load_and_eval_program(&string_tok, NULL);
+  lbm_run_eval();
+
+  char expected[RESULT_SIZE];
+  snprintf(expected, RESULT_SIZE,
+           "(%d 2584 %d 3421780262u32 me (exit-error variable_not_bound))",
+           id, 499500 * id);
+  ok = strcmp(result, expected) == 0;
+  if (!ok) printf("instance %d: got %s, expected %s\n", id, result, expected);
+
+ done:
+  free(memory);
+  free(bitmap);
+  free(heap);
+  free(extensions);
+  free(image_storage);
+  return (void*)(long)ok;
+}
+
+int main(void) {
+  pthread_t threads[NUM_INSTANCES];
+  for (long i = 0; i < NUM_INSTANCES; i ++) {
+    if (pthread_create(&threads[i], NULL, run_instance, (void*)i) != 0) {
+      printf("Error creating thread %ld\n", i);
+      return 1;
+    }
+  }
+  int num_ok = 0;
+  for (int i = 0; i < NUM_INSTANCES; i ++) {
+    void *r;
+    pthread_join(threads[i], &r);
+    if (r) num_ok ++;
+  }
+  printf("%d/%d instances OK\n", num_ok, NUM_INSTANCES);
+  if (num_ok == NUM_INSTANCES) {
+    printf("SUCCESS\n");
+    return 0;
+  }
+  printf("FAILURE\n");
+  return 1;
+}
@@ -34,6 +34,10 @@
 #include "extensions/random_extensions.h"
 #include "extensions/set_extensions.h"
 #include "extensions/mutex_extensions.h"
+#include "extensions/ring_extensions.h"
+#include "extensions/persistent_extensions.h"
+#include "extensions/checksum_extensions.h"
+#include "extensions/optimize_extensions.h"
 #include "extensions/lbm_dyn_lib.h"
 #include "lbm_channel.h"
 #include "lbm_flat_value.h"
@@ -166,12 +170,6 @@ bool dyn_load(const char *str, const char **code) {
             "(if (eq xs nil) nil"
             "(drop (- n 1) (cdr xs))))))";
     return true;
-  } else if (len == 3 && strncmp(str, "zip", 3) == 0) {
-    *code = "(define zip (lambda (xs ys)"
-            "(if (eq xs nil) nil"
-            "(if (eq ys nil) nil"
-            "(cons (cons (car xs) (car ys)) (zip (cdr xs) (cdr ys)))))))";
-    return true;
   } else if (len == 6 && strncmp(str, "lookup", 6) == 0) {
     *code = "(define lookup (lambda (x xs)"
             "(if (eq xs nil) nil"
@@ -179,15 +177,6 @@ bool dyn_load(const char *str, const char **code) {
             "(car (cdr (car xs)))"
             "(lookup x (cdr xs))))))";
     return true;
-  } else if (len == 5 && strncmp(str, "foldr", 5) == 0) {
-    *code = "(define foldr (lambda (f i xs)"
-            "(if (eq xs nil) i"
-            "(f (car xs) (foldr f i (cdr xs))))))";
-    return true;
-  } else if (len == 5 && strncmp(str, "foldl", 5) == 0) {
-    *code = "(define foldl (lambda (f i xs)"
-            "(if (eq xs nil) i (foldl f (f i (car xs)) (cdr xs)))))";
-    return true;
   }
 
   return lbm_dyn_lib_find(str,code);
@@ -599,6 +588,10 @@ int main(int argc, char **argv) {
   lbm_random_extensions_init();
   lbm_mutex_extensions_init();
   lbm_set_extensions_init();
+  lbm_ring_extensions_init();
+  lbm_persistent_extensions_init();
+  lbm_checksum_extensions_init();
+  lbm_optimize_extensions_init();
   lbm_dyn_lib_init();
 
   lbm_add_extension("ext-even", ext_even);
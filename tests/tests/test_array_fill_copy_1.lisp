@@ -0,0 +1,20 @@
+(define a (mkarray 5))
+
+(array-fill! a 7)
+(define r1 (eq a [| 7 7 7 7 7 |]))
+(array-fill! a 'x 1 3)
+(define r2 (eq a [| 7 x x 7 7 |]))
+(array-fill! a 0 -2)
+(define r3 (eq a [| 7 x x 0 0 |]))
+
+(define b [| 1 2 3 4 5 |])
+(array-copy! b 0 [| 10 20 |])
+(define r4 (eq b [| 10 20 3 4 5 |]))
+(array-copy! b 3 [| 1 2 3 |] 1)
+(define r5 (eq b [| 10 20 3 2 3 |]))
+(array-copy! b 1 b 0 3)
+(define r6 (eq b [| 10 10 20 3 3 |]))
+(define r7 (eq (trap (array-copy! b 4 [| 1 2 |])) '(exit-error eval_error)))
+(define r8 (eq (trap (array-fill! [1 2] 0)) '(exit-error type_error)))
+
+(check (and r1 r2 r3 r4 r5 r6 r7 r8))
@@ -0,0 +1,11 @@
+(define a [| 1 2 3 4 |])
+
+(define r1 (= (array-fold + 0 a) 10))
+(define r2 (= (array-fold * 1 a) 24))
+(define r3 (eq (array-fold (lambda (acc x) (cons x acc)) nil a) '(4 3 2 1)))
+(define r4 (= (array-fold + 5 [| |]) 5))
+(define r5 (= (array-fold (lambda (acc x) (+ acc (* x x))) 0 a) 30))
+(define r6 (= (array-fold + 0.5 [| 1 2 |]) 3.5))
+(define r7 (eq (trap (array-fold + 0 [| 1 'a |])) '(exit-error type_error)))
+
+(check (and r1 r2 r3 r4 r5 r6 r7))
@@ -0,0 +1,11 @@
+(define a [| 1 2 3 4 |])
+
+(define r1 (eq (array-map (lambda (x) (* x x)) a) [| 1 4 9 16 |]))
+(define r2 (eq (array-map - a) [| -1 -2 -3 -4 |]))
+(define r3 (eq (array-map (lambda (x) x) [| |]) [| |]))
+(define r4 (eq (array-map car (array (cons 1 2) (cons 3 4))) [| 1 3 |]))
+(define r5 (eq a [| 1 2 3 4 |]))
+(define r6 (eq (trap (array-map car '(1 2))) '(exit-error type_error)))
+(define r7 (eq (array-map (lambda (x) (list x)) a) (array (list 1) (list 2) (list 3) (list 4))))
+
+(check (and r1 r2 r3 r4 r5 r6 r7))
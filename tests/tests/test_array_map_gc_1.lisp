@@ -0,0 +1,8 @@
+(define a (list-to-array (range 100)))
+
+(define m (array-map (lambda (x) (list x x x)) a))
+(define f (array-fold (lambda (acc x) (+ acc (car x) (length x))) 0 m))
+(define s (array-fold + 0 (array-map (lambda (x) (* x 1.5)) a)))
+
+(check (and (= f (+ 4950 300))
+            (= s 7425.0)))
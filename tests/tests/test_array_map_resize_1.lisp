@@ -0,0 +1,14 @@
+(define a [| 1 2 3 4 |])
+(define n 0)
+
+(define r (array-map (lambda (x) (progn (if (< n 12) (progn (vec-push a 'z) (setq n (+ n 1))) nil) x)) a))
+
+(define b [| 1 2 3 4 |])
+(define r2 (array-map (lambda (x) (progn (vec-pop b) x)) b))
+
+(check (and (eq r [| 1 2 3 4 |])
+            (eq (ix a 0) 1)
+            (eq (ix a 3) 4)
+            (eq (ix a 4) 'z)
+            (eq (length a) 8)
+            (eq r2 [| 1 2 nil nil |])))
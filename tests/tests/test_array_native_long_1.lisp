@@ -0,0 +1,16 @@
+;; Fundamental loops over arrays run in chunks, check lengths around
+;; the chunk size.
+
+(defun sum-to (n) (/ (* n (- n 1)) 2))
+
+(defun check-len (n)
+  (let ((arr (list-to-array (range n))))
+    (and (= (array-fold + 0 arr) (sum-to n))
+         (= (array-fold - 0 arr) (- (sum-to n)))
+         (eq (array-map abs arr) arr)
+         (= (ix (array-map - arr) (- n 1)) (- 1 n)))))
+
+(check (and (check-len 255)
+            (check-len 256)
+            (check-len 257)
+            (check-len 513)))
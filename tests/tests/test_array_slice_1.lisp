@@ -0,0 +1,16 @@
+(define a [| 1 2 3 4 5 |])
+
+(define r1 (eq (array-slice a 1 3) [| 2 3 |]))
+(define r2 (eq (array-slice a 2) [| 3 4 5 |]))
+(define r3 (eq (array-slice a -2) [| 4 5 |]))
+(define r4 (eq (array-slice a 0 0) [| |]))
+(define r5 (eq (trap (array-slice a 3 2)) '(exit-error eval_error)))
+(define r6 (eq (trap (array-slice a 0 6)) '(exit-error eval_error)))
+
+(define b [1 2 3 4 5])
+(define v (array-slice b 1 3))
+(bufset-u8 b 1 20)
+(define r7 (= (bufget-u8 v 0) 20))
+(define r8 (= (buflen v) 2))
+
+(check (and r1 r2 r3 r4 r5 r6 r7 r8))
@@ -0,0 +1,18 @@
+(define b (bufcreate 16))
+
+(bufset-i8  b 0 -5)
+(bufset-u16 b 1 1000)
+(bufset-u24 b 3 70000)
+(bufset-i32 b 6 -100000)
+(bufset-u32 b 10 3000000000)
+
+(define r1 (eq (bufget-many b 0 '(i8 u16 u24 i32 u32))
+               (list -5 1000 70000 -100000 3000000000u32)))
+(define r2 (eq (bufget-many b 0 '((u16 . 1) (i8 . 0)))
+               (list 1000 -5)))
+(define r3 (eq (bufget-many b 1 [| u16 u24 |])
+               [| 1000 70000 |]))
+(define r4 (eq (trap (bufget-many b 14 '(u32))) '(exit-error eval_error)))
+(define r5 (eq (bufget-many b 0 '()) nil))
+
+(check (and r1 r2 r3 r4 r5))
@@ -0,0 +1,20 @@
+(define b (bufcreate 16))
+
+(bufset-many b 0 '(i8 u16 u24 i32 f32) (list -5 1000 70000 -100000 3.5f32) 'little-endian)
+
+(define r1 (= (bufget-i8 b 0) -5))
+(define r2 (= (bufget-u16 b 1 'little-endian) 1000))
+(define r3 (= (bufget-u24 b 3 'little-endian) 70000))
+(define r4 (= (bufget-i32 b 6 'little-endian) -100000))
+(define r5 (= (bufget-f32 b 10 'little-endian) 3.5f32))
+(define r6 (eq (bufget-many b 0 '(i8 u16 u24 i32 f32) 'little-endian)
+               (list -5 1000 70000 -100000 3.5f32)))
+
+(bufset-many b 0 [| u8 u8 |] [| 1 2 |])
+(define r7 (eq (bufget-many b 0 '(u8 u8)) (list 1 2)))
+
+;; Fields are checked before anything is written.
+(define r8 (eq (trap (bufset-many b 0 '(u8 (u32 . 14)) '(9 9))) '(exit-error eval_error)))
+(define r9 (= (bufget-u8 b 0) 1))
+
+(check (and r1 r2 r3 r4 r5 r6 r7 r8 r9))
@@ -0,0 +1,36 @@
+(define early '(call-cc (lambda (ret) (progn (ret 10) 20))))
+(define r1 (= (eval early) 10))
+(define r2 (eq (car early) 'call-cc-unsafe))
+
+(define stored '(call-cc (lambda (k) (progn (setq saved k) 1))))
+(define saved nil)
+(define r3 (= (eval stored) 1))
+(define r4 (and (eq (car stored) 'call-cc-copy)
+               (= (eval stored) 1)
+               (eq (car stored) 'call-cc-copy)))
+
+(define nested '(call-cc (lambda (k) (lambda (x) (k x)))))
+(eval nested)
+(define r5 (eq (car nested) 'call-cc-copy))
+
+(defun find-first (p ls)
+  (call-cc (lambda (ret)
+             (progn (map (lambda (x) (if (p x) (ret x) nil)) ls) nil))))
+(define r6 (= (find-first (lambda (x) (> x 3)) '(1 2 3 4 5)) 4))
+
+(defun first-neg (ls)
+  (call-cc (lambda (ret)
+             (progn (foldl (fn (acc x) (if (< x 0) (ret x) acc)) 0 ls) 'none))))
+(define r7 (and (= (first-neg '(1 -2 3)) -2) (eq (first-neg '(1 2)) 'none)))
+
+(define loop-res
+  (call-cc (lambda (brk)
+             (loopfor i 0 (< i 10) (+ i 1) (if (= i 5) (brk i) nil)))))
+(define r8 (= loop-res 5))
+
+(defun keep (x) (call-cc (lambda (k) (progn (setq saved k) x))))
+(define r9 (and (= (keep 1) 1)
+                (eq (car (ix keep 2)) 'call-cc-copy)
+                (= (keep 2) 2)))
+
+(check (and r1 r2 r3 r4 r5 r6 r7 r8 r9))
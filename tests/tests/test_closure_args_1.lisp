@@ -0,0 +1,15 @@
+(define y 10)
+(defun f (a b c) (list a b c))
+(defun g (a) (cons a (rest-args)))
+(defun h () (rest-args))
+
+(define r1 (eq (f 1 'x y) '(1 x 10)))
+(define r2 (eq (f (+ 1 1) y (f 1 2 3)) '(2 10 (1 2 3))))
+(define r3 (eq (g 1 2 y) '(1 2 10)))
+(define r4 (eq (h 'a (+ 1 2)) '(a 3)))
+(define r5 (eq (g 1) '(1)))
+(define r6 (eq (trap (f 1 2)) '(exit-error eval_error)))
+(define r7 (eq ((lambda (x y) (- x y)) y 3) 7))
+(define r8 (eq (let ((y 1)) (f y 'y "s")) '(1 y "s")))
+
+(check (and r1 r2 r3 r4 r5 r6 r7 r8))
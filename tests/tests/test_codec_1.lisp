@@ -0,0 +1,27 @@
+(define c (codec-compile '((rpm i32) (current i16 10) (temp u8) (volt u16 100) (pos f32))))
+
+(define b (bufcreate (codec-size c)))
+
+(codec-encode c b 0 '((volt . 48.5) (rpm . -3000) (current . 12.3) (temp . 40) (pos . 0.25f32)))
+
+(define r1 (= (codec-size c) 13))
+(define r2 (= (bufget-i32 b 0) -3000))
+(define r3 (= (bufget-i16 b 4) 123))
+(define r4 (= (bufget-u8 b 6) 40))
+(define r5 (= (bufget-u16 b 7) 4850))
+(define r6 (= (bufget-f32 b 9) 0.25f32))
+
+(define d (codec-decode c b))
+(define r7 (= (assoc d 'rpm) -3000))
+(define r8 (< (abs (- (assoc d 'current) 12.3)) 0.01))
+(define r9 (= (assoc d 'temp) 40))
+(define r10 (< (abs (- (assoc d 'volt) 48.5)) 0.01))
+
+
+;; Negative scaled values, also into an unsigned field where they wrap.
+(codec-encode c b 0 '((volt . -0.5) (rpm . 0) (current . -12.3) (temp . 0) (pos . 0.0f32)))
+(define r11 (= (bufget-i16 b 4) -123))
+(define r12 (= (bufget-u16 b 7) 65486))
+(define r13 (< (abs (- (assoc (codec-decode c b) 'current) -12.3)) 0.01))
+
+(check (and r1 r2 r3 r4 r5 r6 r7 r8 r9 r10 r11 r12 r13))
@@ -0,0 +1,17 @@
+(define c (codec-compile '((a u8) (b i16) (c u32)) 'little-endian))
+
+(define b (bufcreate 10))
+
+(codec-encode c b 2 [| 7 -2 100000 |])
+
+(define r1 (= (bufget-i16 b 3 'little-endian) -2))
+(define r2 (eq (codec-unpack c b 2) [| 7 -2 100000u32 |]))
+(define r3 (eq (codec-decode c b 2) '((a . 7) (b . -2) (c . 100000u32))))
+
+;; Too small buffer and missing field
+(define r4 (eq (trap (codec-decode c b 4)) '(exit-error eval_error)))
+(define r5 (eq (trap (codec-encode c b 0 '((a . 1) (b . 2)))) '(exit-error eval_error)))
+(define r6 (= (bufget-u8 b 0) 0))
+(define r7 (eq (trap (codec-compile '((a x8)))) '(exit-error eval_error)))
+
+(check (and r1 r2 r3 r4 r5 r6 r7))
@@ -0,0 +1,14 @@
+(define s (array-slice "123456789" 0 9))
+
+(define r1 (= (crc32 s) 0xCBF43926u32))
+(define r2 (= (crc32c s) 0xE3069283u32))
+(define r3 (= (crc16 s) 0x31C3))
+(define r4 (= (crc8 s) 0xF4))
+(define r5 (= (crc32 s 0 0x1EDC6F41) 0xE3069283u32))
+(define r6 (= (crc16 s 0xFFFF) 0x29B1))
+(define r7 (= (crc16 s 0 0x8005) 0xFEE8))
+(define r8 (= (crc32 [] ) 0))
+(define r9 (eq (trap (crc32 'a)) '(exit-error type_error)))
+(define r10 (= (crc8 s 0 0x31) 0xA2))
+
+(check (and r1 r2 r3 r4 r5 r6 r7 r8 r9 r10))
@@ -0,0 +1,12 @@
+(define b (bufcreate 1000))
+(loopfor i 0 (< i 1000) (+ i 1)
+         (bufset-u8 b i (mod (+ (* i 7) 3) 256)))
+
+(define r1 (= (crc32 b) 0x17BC2A46u32))
+(define r2 (= (crc32 (array-slice b 500 1000) (crc32 (array-slice b 0 500))) 0x17BC2A46u32))
+(define r3 (= (crc32 (array-slice b 0 500)) 0x5E275FB2u32))
+(define r4 (= (crc32c b) 0xDD2EDFF7u32))
+(define r5 (= (crc32c (array-slice b 3 1000) (crc32c (array-slice b 0 3))) 0xDD2EDFF7u32))
+(define r6 (= (adler32 b) 0x38ADEDFCu32))
+
+(check (and r1 r2 r3 r4 r5 r6))
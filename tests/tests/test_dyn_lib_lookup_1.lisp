@@ -0,0 +1,20 @@
+(defmacro m (x) `(+ ,x 1))
+(defun f (x) (m x))
+(defunret g (x) (return (+ x 1)))
+
+(define r1 (and (= (abs -3) 3) (= (apply + (list 1 2)) 3) (array? (mkarray 1))))
+(define r2 (and (eq (iota 3) '(0 1 2)) (= (second '(1 2 3)) 2) (= (third '(1 2 3)) 3)))
+(define r3 (and (str-cmp-asc "a" "b") (str-cmp-dsc "b" "a") (eq (str-merge "a" "b") "ab")))
+(define r4 (eq (zipwith + '(1 2) '(3 4)) '(4 6)))
+(define r5 (and (= (f 1) 2) (= (g 1) 2)))
+
+(define s 0)
+(loopfor i 0 (< i 3) (+ i 1) (setq s (+ s i)))
+(looprange i 0 3 (setq s (+ s i)))
+(loopforeach e '(1 2) (setq s (+ s e)))
+(loopwhile (< s 20) (setq s (+ s 1)))
+(define r6 (= s 20))
+
+(define r7 (eq (trap (no-such-dyn-fun 1)) '(exit-error variable_not_bound)))
+
+(check (and r1 r2 r3 r4 r5 r6 r7))
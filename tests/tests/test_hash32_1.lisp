@@ -0,0 +1,14 @@
+(define b (bufcreate 1000))
+(loopfor i 0 (< i 1000) (+ i 1)
+         (bufset-u8 b i (mod (+ (* i 7) 3) 256)))
+
+(define r1 (= (hash32 []) 0x02CC5D05u32))
+(define r2 (= (hash32 (array-slice "abc" 0 3)) 0x32D153FFu32))
+(define r3 (= (hash32 (array-slice "123456789" 0 9)) 0x937BAD67u32))
+(define r4 (= (hash32 b) 0xC85A5152u32))
+(define r5 (= (hash32 b 5) 0xC669EDD4u32))
+(define r6 (= (adler32 (array-slice "Wikipedia" 0 9)) 0x11E60398u32))
+(define r7 (= (fletcher16 (array-slice "abcde" 0 5)) 0xC8F0))
+(define r8 (= (fletcher16 (array-slice "abcdef" 0 6)) 0x2057))
+
+(check (and r1 r2 r3 r4 r5 r6 r7 r8))
@@ -0,0 +1,28 @@
+(define ls (range 1 11))
+
+(define r1 (= (foldl + 0 ls) 55))
+(define r2 (= (foldl (lambda (acc x) (+ acc (* x x))) 0 ls) 385))
+(define r3 (eq (foldr cons nil '(1 2 3)) '(1 2 3)))
+(define r4 (eq (foldl (fn (acc x) (cons x acc)) nil '(1 2 3)) '(3 2 1)))
+(define r5 (= (foldr - 0 '(1 2 3)) 2))
+(define r6 (= (foldl - 0 '(1 2 3)) -6))
+(define r7 (and (= (foldl + 7 nil) 7) (= (foldr + 7 nil) 7)))
+
+(define k 3)
+(define r8 (eq (filter (lambda (x) (= (mod x k) 0)) ls) '(3 6 9)))
+(define r9 (eq (filter number? '(1 a 2 "b" 3)) '(1 2 3)))
+(define r10 (eq (filter (lambda (x) nil) ls) nil))
+(define r11 (eq (filter number? nil) nil))
+
+(define r12 (eq (zip '(1 2 3) '(a b)) '((1 . a) (2 . b))))
+(define r13 (eq (zip nil ls) nil))
+
+(define arr (list-to-array '(1 2 3)))
+(define r14 (and (eq (type-of arr) type-lisparray) (= (ix arr 2) 3)))
+(define r15 (eq (array-to-list arr) '(1 2 3)))
+(define r16 (eq (array-to-list [1 2 3]) '(1b 2b 3b)))
+(define r17 (eq (array-to-list (list-to-array nil)) nil))
+
+(define r18 (eq (trap (foldl + 0 10)) '(exit-error type_error)))
+
+(check (and r1 r2 r3 r4 r5 r6 r7 r8 r9 r10 r11 r12 r13 r14 r15 r16 r17 r18))
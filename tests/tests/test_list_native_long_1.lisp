@@ -0,0 +1,14 @@
+;; Fundamental loops run in chunks, check lengths around the chunk size.
+
+(defun sum-to (n) (/ (* n (- n 1)) 2))
+
+(defun check-len (n)
+  (let ((ls (range n)))
+    (and (= (foldl + 0 ls) (sum-to n))
+         (= (foldr + 0 ls) (sum-to n))
+         (eq (foldr cons nil ls) ls)
+         (= (length (filter number? ls)) n))))
+
+(check (and (check-len 255)
+            (check-len 256)
+            (check-len 257)))
@@ -0,0 +1,18 @@
+;; filter, foldl, foldr and zip are globals bound to builtins on first
+;; use, programs can still define their own.
+
+(define r1 (= (foldl + 0 '(1 2 3)) 6))
+(define r2 (eq (zip '(1 2) '(a b)) '((1 . a) (2 . b))))
+
+(defun zip (xs ys) 'my-zip)
+(define foldl 5)
+(defun filter (f ls) (length ls))
+(define list-to-array 'mine)
+
+(check (and r1 r2
+            (eq (zip '(1 2) '(a b)) 'my-zip)
+            (= foldl 5)
+            (= (filter number? '(1 2 a)) 3)
+            (eq list-to-array 'mine)
+            (= (builtin-foldl + 0 '(1 2 3)) 6)
+            (= (foldr + 0 '(1 2 3)) 6)))
@@ -0,0 +1,27 @@
+(define cnt 0)
+
+(defmacro inc1 (x)
+  (progn (setq cnt (+ cnt 1))
+         `(+ ,x 1)))
+
+(defmacro atom-mac () (progn (setq cnt (+ cnt 1)) 42))
+
+(defun f (a) (inc1 a))
+(defun g () (atom-mac))
+
+(define r1 (= (+ (f 1) (f 2) (f 3)) 9))
+(define r2 (= cnt 1))
+(define r3 (= (+ (g) (g)) 84))
+(define r4 (= cnt 2))
+
+(defmacro twice (e) `(inc1 (inc1 ,e)))
+(defun h (a) (twice a))
+(define r5 (= (+ (h 1) (h 1) (h 1)) 9))
+(define r6 (= cnt 5))
+
+(define s 0)
+(loopfor i 0 (< i 10) (+ i 1) (setq s (+ s (f i))))
+(define r7 (= s 55))
+(define r8 (= cnt 5))
+
+(check (and r1 r2 r3 r4 r5 r6 r7 r8))
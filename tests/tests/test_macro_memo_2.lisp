@@ -0,0 +1,35 @@
+;; Macro calls in data passed to eval and eval-program are expanded
+;; each time and the data is left unchanged.
+(define cnt 0)
+
+(defmacro inc1 (x)
+  (progn (setq cnt (+ cnt 1))
+         `(+ ,x 1)))
+
+(define code '(inc1 5))
+(define r1 (and (= (eval code) 6) (= (eval code) 6)))
+(define r2 (eq code '(inc1 5)))
+(define r3 (= cnt 2))
+
+(define prg '((define a (inc1 1)) (inc1 a)))
+(define r4 (= (eval-program prg) 3))
+(define r5 (eq prg '((define a (inc1 1)) (inc1 a))))
+
+;; Nested eval and eval inside a function body.
+(define nested '(eval '(inc1 (inc1 1))))
+(define r6 (= (eval nested) 3))
+(define r7 (eq nested '(eval '(inc1 (inc1 1)))))
+
+(define mode 1)
+(defmacro pick () (if (= mode 1) 10 20))
+(define pc '(pick))
+(define r8 (= (eval pc) 10))
+(setq mode 2)
+(define r9 (= (eval pc) 20))
+
+;; Code from the reader is still memoized after an eval.
+(setq cnt 0)
+(defun f (a) (inc1 a))
+(define r10 (and (= (f 1) 2) (= (f 2) 3) (= cnt 1)))
+
+(check (and r1 r2 r3 r4 r5 r6 r7 r8 r9 r10))
@@ -0,0 +1,24 @@
+(defmacro inc1 (x) `(+ ,x 1))
+(defmacro twice (e) `(inc1 (inc1 ,e)))
+(defmacro const-mac () 42)
+
+(define e1 (macroexpand-all '(twice a)))
+(define r1 (eq e1 '(+ (+ a 1) 1)))
+
+(define e2 (macroexpand-all '(list (inc1 2) '(inc1 2) (const-mac))))
+(define r2 (eq e2 '(list (+ 2 1) '(inc1 2) 42)))
+(define r3 (eq (eval e2) '(3 (inc1 2) 42)))
+
+(define e3 (macroexpand-all '(lambda (inc1) (inc1 inc1))))
+(define r3b (eq e3 '(lambda (inc1) (+ inc1 1))))
+
+(define e4 (macroexpand-all '(defun f (y) (twice y))))
+(define r4 (eq (car e4) 'define))
+(eval e4)
+(define r5 (= (f 1) 3))
+
+(define code '(a b . c))
+(define r6 (eq (macroexpand-all code) code))
+(define r7 (eq (macroexpand-all 10) 10))
+
+(check (and r1 r2 r3 r3b r4 r5 r6 r7))
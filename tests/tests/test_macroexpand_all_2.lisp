@@ -0,0 +1,31 @@
+(defmacro inc1 (x) `(+ ,x 1))
+
+;; Names in binding positions are not expanded.
+(define e1 (macroexpand-all '(let ((inc1 3)) inc1)))
+(define r1 (eq e1 '(let ((inc1 3)) inc1)))
+
+(define e2 (macroexpand-all '(let (((inc1 b) '(1 2))) (inc1 b))))
+(define r2 (eq e2 '(let (((inc1 b) '(1 2))) (+ b 1))))
+
+(define e3 (macroexpand-all '(loop ((inc1 0)) (< inc1 3) (setq inc1 (inc1 inc1)))))
+(define r3 (eq e3 '(loop ((inc1 0)) (< inc1 3) (setq inc1 (+ inc1 1)))))
+
+(define e4 (macroexpand-all '(progn (var inc1 (inc1 1)) inc1)))
+(define r4 (eq e4 '(progn (var inc1 (+ 1 1)) inc1)))
+(define r5 (= (eval e4) 2))
+
+;; Patterns are not expanded, guards and bodies are.
+(define e5 (macroexpand-all '(match x ((inc1 (? v)) (inc1 v)) (_ 0))))
+(define r6 (eq e5 '(match x ((inc1 (? v)) (+ v 1)) (_ 0))))
+
+(define x '(inc1 10))
+(define r7 (= (eval e5) 11))
+
+(define e6 (macroexpand-all '(match x ((inc1 . _) 1))))
+(define r8 (eq e6 '(match x ((inc1 . _) 1))))
+(define r9 (= (eval e6) 1))
+
+(define e7 (macroexpand-all '(recv-to (inc1 1) ((inc1 (? v)) (inc1 v)) (timeout 0))))
+(define r10 (eq e7 '(recv-to (+ 1 1) ((inc1 (? v)) (+ v 1)) (timeout 0))))
+
+(check (and r1 r2 r3 r4 r5 r6 r7 r8 r9 r10))
@@ -0,0 +1,27 @@
+(define x 'outer)
+
+(defun dispatch (m)
+  (match m
+         ((ping) 'pong)
+         ((get (? k)) (list 'got k))
+         ((set (? k) (? v)) (list 'set k v))
+         ((add (? a) (? b)) (> a 100) 'big)
+         ((add (? a) (? b)) (+ a b))
+         ((b (? x)) x)
+         ((_ 1 . _) x)
+         (_ 'other)))
+
+(define r1 (eq (dispatch '(ping)) 'pong))
+(define r2 (eq (dispatch '(get 3)) '(got 3)))
+(define r3 (eq (dispatch '(set a 2)) '(set a 2)))
+(define r4 (eq (dispatch '(add 1000 1)) 'big))
+(define r5 (eq (dispatch '(add 1 2)) 3))
+(define r6 (eq (dispatch '(a 1 2)) 'outer))
+(define r7 (eq (dispatch 17) 'other))
+(define r8 (eq (match 1 (2 'a)) 'no_match))
+
+;; Bindings of a pattern that fails are not visible in a later clause.
+(send (self) '(1 c))
+(define r9 (eq (recv (((? x) b) 'no) ((_ c) x)) 'outer))
+
+(check (and r1 r2 r3 r4 r5 r6 r7 r8 r9))
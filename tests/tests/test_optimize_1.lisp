@@ -0,0 +1,24 @@
+(define gain 3)
+(define name 'motor)
+(defmacro twice (e) `(* 2 ,e))
+
+(define r1 (= (optimize '(+ 1 (* 2 3))) 7))
+(define r2 (eq (optimize '(* gain x) '(gain)) '(* 3 x)))
+(define r3 (eq (optimize '(* gain x)) '(* gain x)))
+(define r4 (eq (optimize '(let ((gain 2)) (* gain x)) '(gain))
+               '(let ((gain 2)) (* gain x))))
+(define r5 (eq (optimize '(if (> gain 2) 'big 'small) '(gain)) ''big))
+(define r6 (eq (optimize '(if (< 1 0) 'a)) nil))
+(define r7 (eq (optimize ''(+ 1 2)) ''(+ 1 2)))
+(define r8 (eq (optimize '(/ 1 0)) '(/ 1 0)))
+(define r9 (eq (optimize '(twice (+ 1 2))) '(twice (+ 1 2))))
+(define r10 (eq (optimize '(lambda (y) (+ y (- 5 3)))) '(lambda (y) (+ y 2))))
+(define r11 (eq (optimize '(match x (1 (+ 1 1)) (_ (* 2 2))))
+                '(match x (1 2) (_ 4))))
+(define r12 (eq (optimize '(list name gain) '(name gain)) '(list name 3)))
+
+(define f (optimize (lambda (x) (+ x (* gain 10))) '(gain)))
+(define r13 (eq (car (cdr (cdr f))) '(+ x 30)))
+(define r14 (= (f 1) 31))
+
+(check (and r1 r2 r3 r4 r5 r6 r7 r8 r9 r10 r11 r12 r13 r14))
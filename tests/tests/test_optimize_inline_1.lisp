@@ -0,0 +1,36 @@
+(defun second (xs) (car (cdr xs)))
+(defun scale (x) (* x (+ 2 3)))
+(defun fact (n) (if (= n 0) 1 (* n (fact (- n 1)))))
+
+(define e1 (optimize '(second ls) nil t))
+(define r1 (eq (car e1) 'if))
+(define r2 (eq (car (car (cdr (cdr e1)))) 'let))
+
+(define ls '(1 2 3))
+(define r3 (= (eval e1) 2))
+
+(define e2 (optimize '(scale 3) nil '(scale)))
+(define r4 (eq (car (cdr (cdr (car (cdr (cdr e2)))))) '(* x 5)))
+(define r5 (= (eval e2) 15))
+
+;; Recursive functions, unlisted functions and shadowed names are
+;; not inlined.
+(define r6 (eq (optimize '(fact 3) nil t) '(fact 3)))
+(define r7 (eq (optimize '(scale 3) nil '(second)) '(scale 3)))
+(define r8 (eq (optimize '(let ((second car)) (second ls)) nil t)
+               '(let ((second car)) (second ls))))
+(define r9 (eq (optimize '(second xs) nil t) '(second xs)))
+
+;; Functions that look at their own environment are not inlined.
+(defun cnt (x) (length (rest-args)))
+(define k (lambda (a) (cnt a)))
+(define r12 (= ((optimize k nil t) 1 2 3) (k 1 2 3)))
+(define r13 (eq (optimize '(cnt 1) nil t) '(cnt 1)))
+
+;; Redefining the function falls back to calling the new definition.
+(define f (optimize (lambda (ys) (second ys)) nil t))
+(define r10 (= (f '(5 6 7)) 6))
+(defun second (xs) (car (cdr (cdr xs))))
+(define r11 (= (f '(5 6 7)) 7))
+
+(check (and r1 r2 r3 r4 r5 r6 r7 r8 r9 r10 r11 r12 r13))
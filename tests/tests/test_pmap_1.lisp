@@ -0,0 +1,38 @@
+(define m0 (pmap))
+(define m1 (pmap 'a 1 'b 2 "str" 3 '(1 2) 4))
+
+(defun add-n (m n)
+  (if (= n 0) m
+    (add-n (pmap-set m n (* n n)) (- n 1))))
+
+(define mbig (add-n m0 120))
+
+(defun all-ok (m n)
+  (if (= n 0) t
+    (if (= (pmap-get m n) (* n n)) (all-ok m (- n 1)) nil)))
+
+(defun del-n (m n)
+  (if (= n 0) m
+    (del-n (pmap-del m n) (- n 1))))
+
+(define mdel (del-n mbig 60))
+
+(check (and (= (pmap-count m0) 0)
+            (= (pmap-count m1) 4)
+            (= (pmap-get m1 'a) 1)
+            (= (pmap-get m1 "str") 3)
+            (= (pmap-get m1 '(1 2)) 4)
+            (eq (pmap-get m1 'c) nil)
+            (eq (pmap-get m1 'c 'none) 'none)
+            (pmap-has m1 'b)
+            (= (pmap-count (pmap-set m1 'a 10)) 4)
+            (= (pmap-get (pmap-set m1 'a 10) 'a) 10)
+            (= (pmap-get m1 'a) 1)
+            (= (pmap-count mbig) 120)
+            (all-ok mbig 120)
+            (= (pmap-count mdel) 60)
+            (eq (pmap-get mdel 50) nil)
+            (= (pmap-get mdel 100) 10000)
+            (= (pmap-count (pmap-del m1 'zz)) 4)
+            (= (length (pmap-to-alist mbig)) 120)
+            (= (pmap-count (del-n mbig 120)) 0)))
@@ -0,0 +1,10 @@
+(define m (pmap 'a 1 'b "hello" 'c (pvec 1 2 3)))
+
+(define m2 (unflatten (flatten m)))
+
+(gc)
+
+(check (and (= (pmap-get m2 'a) 1)
+            (eq (pmap-get m2 'b) "hello")
+            (eq (pvec-to-list (pmap-get m2 'c)) '(1 2 3))
+            (= (pmap-count m2) 3)))
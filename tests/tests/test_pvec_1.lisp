@@ -0,0 +1,28 @@
+(define v0 (pvec))
+(define v1 (pvec 1 2 3))
+
+(define vbig (list-to-pvec (range 100)))
+
+(defun push-n (v n)
+  (if (= n 0) v
+    (push-n (pvec-push v (- (pvec-len v) 0)) (- n 1))))
+
+(define vp (push-n v0 70))
+
+(define v2 (pvec-set vbig 50 'x))
+
+(check (and (= (pvec-len v0) 0)
+            (= (pvec-len v1) 3)
+            (= (pvec-ref v1 2) 3)
+            (= (pvec-ref v1 -1) 3)
+            (= (pvec-len vbig) 100)
+            (= (pvec-ref vbig 99) 99)
+            (eq (pvec-to-list vbig) (range 100))
+            (eq (pvec-to-list vp) (range 70))
+            (= (pvec-ref vp 65) 65)
+            (eq (pvec-ref v2 50) 'x)
+            (= (pvec-ref vbig 50) 50)
+            (= (pvec-ref v2 51) 51)
+            (eq (trap (pvec-ref v1 3)) '(exit-error eval_error))
+            (eq (pvec-to-list (pvec-set v1 0 10)) '(10 2 3))
+            (eq (pvec-to-list v1) '(1 2 3))))
@@ -0,0 +1,20 @@
+(define a (pvec 1 2 3))
+
+;; Writing into the header or a node must not be possible.
+(define r1 (trap (setix a 3 5)))
+(define r2 (trap (setix (ix a 3) 0 'oops)))
+
+(define b (pvec-set a 0 10))
+
+;; An array that looks like a pvec but is not built by the extension.
+(define forged [| nil 3u 0u 5 |])
+(setix forged 0 (ix a 0))
+(define r3 (trap (pvec-ref forged 0)))
+
+(check (and (not (eq r1 '(exit-ok 5)))
+            (not (eq r2 '(exit-ok oops)))
+            (= (pvec-ref a 0) 1)
+            (= (pvec-ref a 2) 3)
+            (= (pvec-ref b 0) 10)
+            (eq (pvec-to-list a) '(1 2 3))
+            (eq r3 '(exit-error type_error))))
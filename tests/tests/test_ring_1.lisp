@@ -0,0 +1,18 @@
+(define r (ring-create 'i16 4))
+
+(define r1 (eq (ring-pop r) nil))
+(ring-push r 1 2 3)
+(define r2 (= (ring-len r) 3))
+(define r3 (= (ring-peek r) 1))
+(define r4 (= (ring-ref r -1) 3))
+(ring-push r 4 5)
+(define r5 (= (ring-len r) 4))
+(define r6 (= (ring-pop r) 2))
+(define r7 (= (ring-ref r 0) 3))
+(define r8 (eq (trap (ring-ref r 3)) '(exit-error eval_error)))
+(ring-push r -40000)
+(define r9 (= (ring-ref r -1) 25536))
+(ring-clear r)
+(define r10 (= (ring-len r) 0))
+
+(check (and r1 r2 r3 r4 r5 r6 r7 r8 r9 r10))
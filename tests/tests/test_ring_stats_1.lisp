@@ -0,0 +1,48 @@
+(define r (ring-create 'f32 3))
+
+(define r1 (eq (ring-mean r) nil))
+(ring-push r 1.0 5.0 3.0)
+(define r2 (= (ring-mean r) 3.0))
+(define r3 (= (ring-min r) 1.0))
+(define r4 (= (ring-max r) 5.0))
+(ring-push r 2.0)
+(define r5 (= (ring-min r) 2.0))
+(define r6 (= (ring-max r) 5.0))
+(ring-push r 0.5 0.25)
+(define r7 (= (ring-max r) 2.0))
+(define r8 (= (ring-min r) 0.25))
+(ring-pop r)
+(define r9 (= (ring-max r) 0.5))
+
+;; Compare against a list based window
+(defun lmax (l) (foldl (fn (a b) (if (> a b) a b)) (car l) l))
+(defun lmin (l) (foldl (fn (a b) (if (< a b) a b)) (car l) l))
+
+(define q (ring-create 'i32 5))
+(define win '())
+(define ok t)
+(define i 0)
+(loopwhile (< i 50)
+  (progn
+    (define x (mod (* i 37) 23))
+    (ring-push q x)
+    (setq win (take (cons x win) 5))
+    (if (not (and (= (ring-max q) (lmax win))
+                  (= (ring-min q) (lmin win))))
+        (setq ok nil))
+    (setq i (+ i 1))))
+
+;; Integer rings keep an exact sum.
+(define ri (ring-create 'i16 4))
+(ring-push ri -3 7 -1 5)
+(define r10 (= (ring-mean ri) 2.0))
+(ring-push ri 9)
+(define r11 (= (ring-mean ri) 5.0))
+(define ru (ring-create 'u32 2))
+(ring-push ru 4000000000u32 4000000002u32)
+(define r12 (= (ring-mean ru) 4000000001.0))
+
+;; A capacity too large to allocate is an error, not a crash.
+(define r13 (eq (car (trap (ring-create 'u32 4294967295))) 'exit-error))
+
+(check (and r1 r2 r3 r4 r5 r6 r7 r8 r9 r10 r11 r12 r13 ok))
@@ -0,0 +1,16 @@
+(define sb (sb-create))
+
+(sb-append sb "Hello")
+(sb-append sb " " "World" "!")
+
+(define r1 (= (sb-len sb) 12))
+(define r2 (eq (sb-finish sb) "Hello World!"))
+(define r3 (= (sb-len sb) 0))
+(define r4 (eq (sb-finish sb) ""))
+(define r5 (eq (sb-finish (sb-append (sb-create 4) 1 " " 'apa " " (list 1 2))) "1 apa (1 2)"))
+
+;; Capacities that cannot be allocated are errors.
+(define r6 (eq (trap (sb-create -2)) '(exit-error eval_error)))
+(define r7 (eq (car (trap (sb-create 4294967294u32))) 'exit-error))
+
+(check (and r1 r2 r3 r4 r5 r6 r7))
@@ -0,0 +1,16 @@
+(define sb (sb-create))
+
+(define n 0)
+(loopwhile (< n 200)
+  (progn
+    (sb-append sb n ",")
+    (setq n (+ n 1))))
+
+(define s (sb-finish sb))
+
+(define r1 (= (str-len s) 690))
+(define r2 (eq (str-part s 0 6) "0,1,2,"))
+(define r3 (eq (str-part s 686) "199,"))
+(define r4 (= (length (str-split s ",")) 200))
+
+(check (and r1 r2 r3 r4))
@@ -0,0 +1,12 @@
+(define s "the quick brown fox jumps over the lazy dog")
+
+(define r1 (eq (str-find-any s '("fox" "dog" "quick")) '(4 . 2)))
+(define r2 (eq (str-find-any s '("dog" "lazy")) '(35 . 1)))
+(define r3 (eq (str-find-any s '("cat" "bird")) nil))
+(define r4 (eq (str-find-any s '("the") 1) '(31 . 0)))
+(define r5 (eq (str-find-any "abcd" '("bc" "abcd")) '(0 . 1)))
+(define r6 (eq (str-find-any "ushers" '("he" "she" "his" "hers")) '(1 . 1)))
+(define r7 (eq (str-find-any "THE Fox" '("fox") 'nocase) '(4 . 0)))
+(define r8 (eq (str-find-any "aaab" '("ab" "aab" "b")) '(1 . 1)))
+
+(check (and r1 r2 r3 r4 r5 r6 r7 r8))
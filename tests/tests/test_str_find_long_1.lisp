@@ -0,0 +1,10 @@
+(define s (str-merge (str-replicate 100 97b) "needle-in-haystack" (str-replicate 50 97b) "needle-in-haystack"))
+
+(define r1 (= (str-find s "needle-in-haystack") 100))
+(define r2 (= (str-find s "needle-in-haystack" 0 1) 168))
+(define r3 (= (str-find s "needle-in-haystack" 101) 168))
+(define r4 (= (str-find s "needle-in-haystacks") -1))
+(define r5 (= (str-find s "aaaaaaaan") 92))
+(define r6 (= (str-find s "ack") 115))
+
+(check (and r1 r2 r3 r4 r5 r6))
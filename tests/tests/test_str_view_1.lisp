@@ -0,0 +1,21 @@
+(define s "Hello World!")
+
+(define r1 (eq (str-view s 6) "World!"))
+(define r2 (eq (str-view s 6 2) "Wo"))
+(define r3 (eq (str-view s 0 5) "Hello"))
+(define r4 (= (str-len (str-view s 6 5)) 5))
+(define r5 (eq (str-to-upper (str-view s 0 5)) "HELLO"))
+(define r6 (eq (str-view (str-view s 6) 1 3) "orl"))
+(define r7 (= (str-to-i (str-view "12345" 1 2)) 23))
+(define r8 (eq (to-str (str-view s 0 5)) "Hello"))
+
+
+;; A view without a terminating zero that is too long to convert is an
+;; error rather than being truncated.
+(define long (str-join (map (fn (x) "1111111111") (range 10))))
+(define r9 (eq (trap (str-to-i (str-view long 0 70))) '(exit-error eval_error)))
+(define r10 (eq (trap (str-to-f (str-view long 0 70))) '(exit-error eval_error)))
+(define r11 (eq (trap (str-from-n 1 (str-view long 0 40))) '(exit-error eval_error)))
+(define r12 (= (str-to-i (str-view long 0 9)) 111111111))
+
+(check (and r1 r2 r3 r4 r5 r6 r7 r8 r9 r10 r11 r12))
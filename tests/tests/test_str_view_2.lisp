@@ -0,0 +1,13 @@
+(define toks (str-split-view "apa,bepa;cepa,,depa" ",;"))
+
+(gc)
+
+(define r1 (eq toks (list "apa" "bepa" "cepa" "depa")))
+(define r2 (eq (str-join toks "-") "apa-bepa-cepa-depa"))
+(define r3 (= (str-find (str-join toks) "cepa") 7))
+(define r4 (eq (str-replace (car toks) "p" "pp") "appa"))
+(define r5 (= (str-cmp (car toks) "apa") 0))
+(define r6 (< (str-cmp (car toks) "apan") 0))
+(define r7 (eq (trap (bufset-u8 (car toks) 0 65)) '(exit-error type_error)))
+
+(check (and r1 r2 r3 r4 r5 r6 r7))
@@ -0,0 +1,10 @@
+(define v (str-view (str-replicate 100 65) 10 3))
+
+(gc)
+
+(define junk (range 100))
+(define junk2 (str-replicate 100 66))
+
+(gc)
+
+(check (eq v "AAA"))
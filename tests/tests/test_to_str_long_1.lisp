@@ -0,0 +1,8 @@
+(define l (range 200))
+
+(define s (to-str l))
+
+(define r1 (> (str-len s) 300))
+(define r2 (eq (str-part s (- (str-len s) 4)) "199)"))
+
+(check (and r1 r2))
@@ -0,0 +1,27 @@
+(define r1 (eq (trap (trap (car 1))) '(exit-ok (exit-error type_error))))
+(define r2 (eq (trap (+ 1 (trap (car 1)))) '(exit-error type_error)))
+
+;; Leave two trap frames with an escape continuation, then raise an
+;; error that must reach the outer trap.
+(define r3 (eq (trap (progn
+                       (call-cc-unsafe (lambda (k) (trap (trap (k 1)))))
+                       (car 1)))
+               '(exit-error type_error)))
+
+(define r4 (eq (trap (progn
+                       (call-cc (lambda (k) (trap (trap (k 1)))))
+                       (car 1)))
+               '(exit-error type_error)))
+
+;; Re-enter a full continuation captured inside a trap.
+(define r5 (= 3 (let ((n 0) (kk nil))
+                  (progn
+                    (trap (progn
+                            (call-cc (lambda (k) (setq kk k)))
+                            (setq n (+ n 1))
+                            (car 1)))
+                    (if (< n 3) (kk nil) n)))))
+
+(define r6 (eq (trap 'ok) '(exit-ok ok)))
+
+(check (and r1 r2 r3 r4 r5 r6))
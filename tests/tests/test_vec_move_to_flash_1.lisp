@@ -0,0 +1,8 @@
+(define v (mkarray 0))
+(vec-push v 1)
+(vec-push v 'apa)
+(vec-push v (list 1 2))
+
+(move-to-flash v)
+
+(check (eq v [| 1 apa (1 2) |]))
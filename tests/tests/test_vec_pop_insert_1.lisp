@@ -0,0 +1,34 @@
+(define v (array 1 2 3))
+
+(vec-insert v 0 'a)
+(vec-insert v 2 'b)
+(vec-insert v -1 'c)
+
+(define r1 (eq v [| a 1 b 2 3 c |]))
+(define r2 (eq (vec-pop v) 'c))
+(define r3 (eq v [| a 1 b 2 3 |]))
+(define r4 (eq (trap (vec-insert v 7 'x)) '(exit-error eval_error)))
+
+(define w (mkarray 0))
+(define i 0)
+(loopwhile (< i 64) (progn (vec-push w (list i)) (setq i (+ i 1))))
+(loopwhile (> i 3) (progn (vec-pop w) (setq i (- i 1))))
+(gc)
+(define r5 (eq w [| (0) (1) (2) |]))
+(define r6 (= (vec-capacity w) 8))
+(define r7 (eq (vec-pop (mkarray 0)) nil))
+
+;; Popping gives memory back, capacity 64 shrinks to 8.
+(define u (mkarray 0))
+(define m0 0)
+(define m1 0)
+(setq i 0)
+(loopwhile (< i 64) (progn (vec-push u i) (setq i (+ i 1))))
+(setq m0 (mem-num-free))
+(loopwhile (> i 3) (progn (vec-pop u) (setq i (- i 1))))
+(setq m1 (mem-num-free))
+(define r8 (and (= (vec-capacity u) 8)
+                (>= (- m1 m0) 56)
+                (eq u [| 0 1 2 |])))
+
+(check (and r1 r2 r3 r4 r5 r6 r7 r8))
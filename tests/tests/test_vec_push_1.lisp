@@ -0,0 +1,19 @@
+(define v (mkarray 0))
+
+(define i 0)
+(loopwhile (< i 100)
+  (progn
+    (vec-push v i)
+    (setq i (+ i 1))))
+
+(define r1 (= (length v) 100))
+(define r2 (= (ix v 0) 0))
+(define r3 (= (ix v 99) 99))
+(define r4 (= (vec-capacity v) 128))
+(define r5 (eq (vec-push [| 1 2 |] 3) [| 1 2 3 |]))
+(define r6 (eq (type-of v) 'type-lisparray))
+
+(gc)
+(define r7 (= (ix v 50) 50))
+
+(check (and r1 r2 r3 r4 r5 r6 r7))